@@ -0,0 +1,66 @@
+#ifndef ANALOGSAMPLER_H
+#define ANALOGSAMPLER_H
+
+#include <Arduino.h>
+#include <TaskSchedulerDeclarations.h>
+#include <soc/soc_caps.h>
+#include "InputPin.h"
+
+// Samples every IT_ANALOG input in the background with the ADC1 continuous
+// (DMA) controller. The hardware scans the registered channels at SAMPLE_HZ
+// into a driver ring; a scheduler task drains it every DRAIN_MS without
+// blocking. Per channel, each run of getOversample() raw conversions is
+// averaged into one decimated value, which then passes through an EMA of
+// weight 1/2^filterShift (0 = no filter). The result is pushed into the pin,
+// so InputPin::getPinState()/mapValue() return it without an analogRead().
+//
+// Only ADC1 GPIOs can be sampled: ADC2 is shared with the WiFi radio.
+// Device only; the sim has no analog inputs.
+class AnalogSampler {
+public:
+    static const uint8_t MAX_INPUTS = 8;
+    static const uint32_t SAMPLE_HZ = 5000;         // Conversions/s shared by all channels
+    static const uint32_t DRAIN_MS = 20;
+    static const uint32_t FRAME_BYTES = 256;        // Bytes per DMA frame (4 per conversion on the S3, 2 on the ESP32)
+    static const uint32_t STORE_BYTES = 2048;       // Driver ring, ~100 ms at SAMPLE_HZ (~200 ms on the ESP32)
+    static const uint16_t DEFAULT_OVERSAMPLE = 16;
+    static const uint8_t DEFAULT_FILTER_SHIFT = 3;  // EMA weight 1/8
+    static const uint8_t MAX_FILTER_SHIFT = 8;
+
+    explicit AnalogSampler(Scheduler* ts);
+
+    // Call after the pin's initPin() and before begin()
+    bool addInput(InputPin* pin, uint8_t filterShift = DEFAULT_FILTER_SHIFT);
+    void setOversample(uint16_t samples);
+    uint16_t getOversample() const { return _oversample; }
+    bool setFilterShift(InputPin* pin, uint8_t filterShift);
+    bool begin();                   // False when there is nothing to sample or the driver failed
+    bool isRunning() const { return _running; }
+    uint8_t getInputCount() const { return _count; }
+    uint32_t getOverrunCount() const { return _overruns; }
+
+private:
+    struct Channel {
+        InputPin* pin;
+        uint8_t adcChannel;
+        uint8_t filterShift;
+        bool primed;                // Filter seeded with its first decimated value
+        uint32_t sum;
+        uint16_t samples;
+        uint32_t filtered;          // Fixed point, value << filterShift
+    };
+
+    void drain();
+    void accumulate(Channel& ch, uint16_t raw);
+
+    Task* _tsk;
+    Channel _channels[MAX_INPUTS];
+    int8_t _slotForChannel[SOC_ADC_MAX_CHANNEL_NUM];    // ADC1 channel -> _channels index, -1 = unused
+    uint8_t _count;
+    uint16_t _oversample;
+    bool _running;
+    uint32_t _overruns;
+    uint8_t _frame[FRAME_BYTES];
+};
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef BOARDCONFIG_H
+#define BOARDCONFIG_H
+
+#include <Arduino.h>
+#include <new>
+#include "GoodmanHP.h"
+#include "InputDebouncer.h"
+#include "InputPin.h"
+#include "OutPin.h"
+
+// Board GPIO layouts as constexpr tables. Each input/output entry is indexed by
+// its GoodmanHP::InputId/OutputId slot, and BoardPins<> static_asserts that the
+// table is complete, in slot order, free of duplicate or reserved GPIOs and
+// never drives an input-only pin. Adding a board means adding one BoardDef and
+// one #elif at the bottom of this file.
+
+static const uint8_t BOARD_INPUT_COUNT = (uint8_t)GoodmanHP::InputId::COUNT;
+static const uint8_t BOARD_OUTPUT_COUNT = (uint8_t)GoodmanHP::OutputId::COUNT;
+
+struct BoardInputDef {
+    GoodmanHP::InputId id;
+    uint8_t gpio;
+    const char* boardPin;           // Silkscreen / terminal label
+    InputResistorType resistor;
+    uint32_t debounceMs;            // InputDebouncer window; Y and O match so a COOL switch lands together
+};
+
+struct BoardOutputDef {
+    GoodmanHP::OutputId id;
+    uint8_t gpio;
+    const char* boardPin;
+    uint32_t delayMs;               // OutPin on-delay task interval
+};
+
+struct BoardDef {
+    const char* name;
+    BoardInputDef inputs[BOARD_INPUT_COUNT];
+    BoardOutputDef outputs[BOARD_OUTPUT_COUNT];
+    uint8_t oneWire;
+    uint8_t sda;
+    uint8_t scl;
+    uint8_t mcpAlert;               // MCP9600 ALERT1/ALERT2, open-drain active low, wired together
+    uint8_t gpioCount;              // Valid GPIOs are 0 .. gpioCount-1
+    uint64_t reservedMask;          // Flash/PSRAM/USB pins that must not be used
+    uint64_t inputOnlyMask;         // Pins without an output driver
+};
+
+// --- Boards ---
+
+// Freenove ESP32-S3-WROOM (N8R8, octal PSRAM)
+constexpr BoardDef S3_WROOM_BOARD = {
+    "ESP32-S3-WROOM",
+    {
+        { GoodmanHP::InputId::LPS, 15, "LPS",   InputResistorType::IT_PULLDOWN, 50 },
+        { GoodmanHP::InputId::DFT, 16, "DFT",   InputResistorType::IT_PULLDOWN, 1000 },
+        { GoodmanHP::InputId::Y,   17, "OT-NO", InputResistorType::IT_PULLDOWN, 100 },
+        { GoodmanHP::InputId::O,   18, "OT-NC", InputResistorType::IT_PULLDOWN, 100 },
+    },
+    {
+        { GoodmanHP::OutputId::FAN, 4, "FAN", 0 },
+        { GoodmanHP::OutputId::CNT, 5, "CNT", 3000 },
+        { GoodmanHP::OutputId::W,   6, "W",   0 },
+        { GoodmanHP::OutputId::RV,  7, "RV",  0 },
+    },
+    21,     // OneWire
+    8, 9,   // I2C SDA, SCL
+    10,     // MCP9600 alert
+    49,
+    (0x7FULL << 26) | (0x1FULL << 33) | (1ULL << 19) | (1ULL << 20),  // SPI flash, octal PSRAM, USB D-/D+
+    0
+};
+
+// ESP32 DevKit / WROVER. GPIO 6-11 are the SPI flash and 16/17 the PSRAM.
+constexpr BoardDef ROVER_BOARD = {
+    "ESP32-ROVER",
+    {
+        { GoodmanHP::InputId::LPS, 13, "LPS",   InputResistorType::IT_PULLDOWN, 50 },
+        { GoodmanHP::InputId::DFT, 14, "DFT",   InputResistorType::IT_PULLDOWN, 1000 },
+        { GoodmanHP::InputId::Y,   27, "OT-NO", InputResistorType::IT_PULLDOWN, 100 },
+        { GoodmanHP::InputId::O,   26, "OT-NC", InputResistorType::IT_PULLDOWN, 100 },
+    },
+    {
+        { GoodmanHP::OutputId::FAN, 25, "FAN", 0 },
+        { GoodmanHP::OutputId::CNT, 33, "CNT", 3000 },
+        { GoodmanHP::OutputId::W,   32, "W",   0 },
+        { GoodmanHP::OutputId::RV,   4, "RV",  0 },
+    },
+    23,         // OneWire
+    21, 22,     // I2C SDA, SCL
+    34,         // MCP9600 alert (input-only; external pull-up)
+    40,
+    (0x3FULL << 6) | (1ULL << 16) | (1ULL << 17),
+    0x3FULL << 34
+};
+
+// --- Compile-time checks (C++11 constexpr: single-expression recursion) ---
+
+namespace board_check {
+
+constexpr bool inputsInOrder(const BoardDef& b, uint8_t i = 0) {
+    return i >= BOARD_INPUT_COUNT ||
+           (b.inputs[i].id == (GoodmanHP::InputId)i && b.inputs[i].boardPin != nullptr && inputsInOrder(b, i + 1));
+}
+
+constexpr bool outputsInOrder(const BoardDef& b, uint8_t i = 0) {
+    return i >= BOARD_OUTPUT_COUNT ||
+           (b.outputs[i].id == (GoodmanHP::OutputId)i && b.outputs[i].boardPin != nullptr && outputsInOrder(b, i + 1));
+}
+
+// Every GPIO the board claims: inputs, outputs, then OneWire, SDA, SCL, MCP9600 alert
+static const uint8_t PIN_COUNT = BOARD_INPUT_COUNT + BOARD_OUTPUT_COUNT + 4;
+static const uint8_t DRIVEN_PIN_END = PIN_COUNT - 1;   // The alert line is an input
+
+constexpr uint8_t pinAt(const BoardDef& b, uint8_t k) {
+    return k < BOARD_INPUT_COUNT ? b.inputs[k].gpio
+         : k < BOARD_INPUT_COUNT + BOARD_OUTPUT_COUNT ? b.outputs[k - BOARD_INPUT_COUNT].gpio
+         : k == PIN_COUNT - 4 ? b.oneWire
+         : k == PIN_COUNT - 3 ? b.sda
+         : k == PIN_COUNT - 2 ? b.scl
+         : b.mcpAlert;
+}
+
+constexpr bool pinsUniqueFrom(const BoardDef& b, uint8_t i, uint8_t j) {
+    return i >= PIN_COUNT ? true
+         : j >= PIN_COUNT ? pinsUniqueFrom(b, i + 1, i + 2)
+         : pinAt(b, i) != pinAt(b, j) && pinsUniqueFrom(b, i, j + 1);
+}
+
+constexpr bool pinsUnique(const BoardDef& b) { return pinsUniqueFrom(b, 0, 1); }
+
+constexpr bool pinsUsable(const BoardDef& b, uint8_t k = 0) {
+    return k >= PIN_COUNT ||
+           (pinAt(b, k) < b.gpioCount && !(b.reservedMask & (1ULL << pinAt(b, k))) && pinsUsable(b, k + 1));
+}
+
+// Outputs, OneWire and I2C all drive their pin
+constexpr bool drivenPinsCanDrive(const BoardDef& b, uint8_t k = BOARD_INPUT_COUNT) {
+    return k >= DRIVEN_PIN_END || (!(b.inputOnlyMask & (1ULL << pinAt(b, k))) && drivenPinsCanDrive(b, k + 1));
+}
+
+// Every input window fits the debouncer's counter width
+constexpr bool debounceFits(const BoardDef& b, uint8_t i = 0) {
+    return i >= BOARD_INPUT_COUNT || (b.inputs[i].debounceMs <= InputDebouncer::MAX_WINDOW_MS && debounceFits(b, i + 1));
+}
+
+} // namespace board_check
+
+// Pin objects for one board, constructed in place in static storage by
+// begin() and registered with the controller by slot. The inputs are handed
+// to one InputDebouncer whose accepted edges wake the controller.
+template <const BoardDef& Board>
+class BoardPins {
+    static_assert(board_check::inputsInOrder(Board), "Board inputs must list every InputId once, in InputId order");
+    static_assert(board_check::outputsInOrder(Board), "Board outputs must list every OutputId once, in OutputId order");
+    static_assert(board_check::pinsUnique(Board), "Board assigns the same GPIO twice");
+    static_assert(board_check::pinsUsable(Board), "Board uses a GPIO that does not exist or is reserved for flash/PSRAM/USB");
+    static_assert(board_check::drivenPinsCanDrive(Board), "Board drives an input-only GPIO");
+    static_assert(board_check::debounceFits(Board), "Board input debounce window exceeds InputDebouncer::MAX_WINDOW_MS");
+
+  public:
+    static constexpr const BoardDef& def() { return Board; }
+
+    InputDebouncer& debouncer() { return *_debouncer; }
+
+    void begin(Scheduler* ts, GoodmanHP& hp, InputPinCallback inputClbk, OutputPinCallback outputClbk) {
+        _debouncer = new (_debouncerStore) InputDebouncer(ts);
+        for (uint8_t i = 0; i < BOARD_INPUT_COUNT; i++) {
+            const BoardInputDef& d = Board.inputs[i];
+            InputPin* pin = new (_inputStore[i]) InputPin(d.debounceMs, d.resistor, InputPinType::IT_DIGITAL, d.gpio,
+                                                          GoodmanHP::getInputName(d.id), d.boardPin, inputClbk);
+            hp.addInput(d.id, pin);
+            _debouncer->addInput(pin);
+        }
+        _debouncer->setEdgeCallback([&hp](InputPin*, uint32_t) { hp.requestUpdate(); });
+        _debouncer->begin();
+        for (uint8_t i = 0; i < BOARD_OUTPUT_COUNT; i++) {
+            const BoardOutputDef& d = Board.outputs[i];
+            OutPin* pin = new (_outputStore[i]) OutPin(ts, d.delayMs, d.gpio, GoodmanHP::getOutputName(d.id), d.boardPin, outputClbk);
+            hp.addOutput(d.id, pin);
+        }
+    }
+
+  private:
+    InputDebouncer* _debouncer = nullptr;
+    alignas(InputDebouncer) uint8_t _debouncerStore[sizeof(InputDebouncer)];
+    alignas(InputPin) uint8_t _inputStore[BOARD_INPUT_COUNT][sizeof(InputPin)];
+    alignas(OutPin) uint8_t _outputStore[BOARD_OUTPUT_COUNT][sizeof(OutPin)];
+};
+
+// --- Board selection ---
+#if defined(BOARD_ESP32_S3_WROOM) || defined(NATIVE_SIM)
+typedef BoardPins<S3_WROOM_BOARD> SelectedBoardPins;
+#elif defined(BOARD_ESP32_ROVER)
+typedef BoardPins<ROVER_BOARD> SelectedBoardPins;
+#else
+#error "BUILD_ENV_NAME NOT RECOGNIZED"
+#endif
+
+#endif
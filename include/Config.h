@@ -6,6 +6,7 @@
 #include <SD.h>
 #include "ArduinoJson.h"
 #include "TempSensor.h"
+#include "OutPin.h"
 #include "mbedtls/base64.h"
 #include "mbedtls/gcm.h"
 
@@ -33,6 +34,8 @@ struct ProjectInfo {
     uint32_t apFallbackSeconds;  // WiFi disconnect time before AP fallback (default 600 = 10 min)
     uint32_t tempHistoryIntervalSec; // Temp history capture interval in seconds (30-300, default 120)
     String theme;                // UI theme: "light" or "dark" (default "light")
+    std::map<String, OutPinStats> outputStats;  // Per-output accounting by name (persisted in "runtime.outputs")
+    std::map<String, TempFilter::Config> sensorFilters;  // Per-sensor reading filters by name (persisted in "sensors.filter")
 };
 
 class Config {
@@ -44,8 +47,9 @@ class Config {
     bool openConfigFile(const char* filename, TempSensorMap& config, ProjectInfo& proj);
     bool loadTempConfig(const char* filename, TempSensorMap& config, ProjectInfo& proj);
     bool saveConfiguration(const char* filename, TempSensorMap& config, ProjectInfo& proj);
-    bool updateRuntime(const char* filename, uint32_t heatRuntimeMs, bool softwareDefrost);
-    bool updateConfig(const char* filename, TempSensorMap& config, ProjectInfo& proj);
+    bool updateRuntime(const char* filename, uint32_t heatRuntimeMs, bool softwareDefrost,
+                       const std::map<String, OutPinStats>& outputStats);
+    bool updateConfig(const char* filename, const TempSensorMap& config, ProjectInfo& proj);
     void clearConfig(TempSensorMap& config);
 
     // Getters for loaded config values
@@ -115,6 +119,14 @@ class Config {
     // ProjectInfo pointer for WebHandler access
     ProjectInfo* _proj;
 
+    // "runtime.outputs" section
+    static void outputStatsToJson(JsonObject outputs, const std::map<String, OutPinStats>& stats);
+    static void outputStatsFromJson(JsonObject outputs, std::map<String, OutPinStats>& stats);
+
+    // "sensors.filter" section
+    static void sensorFiltersToJson(JsonObject filters, const std::map<String, TempFilter::Config>& configs);
+    static void sensorFiltersFromJson(JsonObject filters, std::map<String, TempFilter::Config>& configs);
+
     // AES-256-GCM encryption key (derived from eFuse HMAC)
     static uint8_t _aesKey[32];
     static bool _encryptionReady;
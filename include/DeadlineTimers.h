@@ -0,0 +1,131 @@
+#ifndef DEADLINETIMERS_H
+#define DEADLINETIMERS_H
+
+#include <Arduino.h>
+
+// Fixed set of one-shot millis() deadlines kept in a binary min-heap. Each
+// timer id (0..N-1) is armed at most once; re-arming moves it. expire() pops
+// every deadline that has been reached, so a caller only pays for timers that
+// are due, and isArmed() afterwards means "still waiting". All comparisons go
+// through reached(), which is wraparound safe for deadlines < 2^31 ms away.
+template <uint8_t N>
+class DeadlineTimers {
+    static_assert(N > 0 && N <= 32, "DeadlineTimers ids must fit the expire() mask");
+
+  public:
+    static const uint8_t NOT_ARMED = 0xFF;
+
+    DeadlineTimers() : _size(0) {
+        for (uint8_t i = 0; i < N; i++) _pos[i] = NOT_ARMED;
+    }
+
+    static bool reached(uint32_t now, uint32_t deadline) {
+        return (int32_t)(now - deadline) >= 0;
+    }
+
+    void arm(uint8_t id, uint32_t now, uint32_t durationMs) {
+        armAt(id, now + durationMs);
+    }
+
+    void armAt(uint8_t id, uint32_t deadline) {
+        uint8_t i = _pos[id];
+        if (i == NOT_ARMED) {
+            i = _size++;
+            _heap[i].id = id;
+            _pos[id] = i;
+        }
+        _heap[i].deadline = deadline;
+        siftDown(siftUp(i));
+    }
+
+    void cancel(uint8_t id) {
+        uint8_t i = _pos[id];
+        if (i == NOT_ARMED) return;
+        removeAt(i);
+    }
+
+    bool isArmed(uint8_t id) const { return _pos[id] != NOT_ARMED; }
+
+    uint32_t deadline(uint8_t id) const { return _heap[_pos[id]].deadline; }
+
+    // 0 when not armed or already due
+    uint32_t remainingMs(uint8_t id, uint32_t now) const {
+        if (!isArmed(id)) return 0;
+        uint32_t d = deadline(id);
+        return reached(now, d) ? 0 : d - now;
+    }
+
+    // Time to the earliest deadline, capped; 0 if one is already due
+    uint32_t nextMs(uint32_t now, uint32_t capMs) const {
+        if (_size == 0) return capMs;
+        uint32_t d = _heap[0].deadline;
+        if (reached(now, d)) return 0;
+        return d - now < capMs ? d - now : capMs;
+    }
+
+    // Pops every reached deadline; returns a bit per expired id
+    uint32_t expire(uint32_t now) {
+        uint32_t mask = 0;
+        while (_size > 0 && reached(now, _heap[0].deadline)) {
+            mask |= 1UL << _heap[0].id;
+            removeAt(0);
+        }
+        return mask;
+    }
+
+  private:
+    struct Entry {
+        uint32_t deadline;
+        uint8_t id;
+    };
+
+    Entry _heap[N];
+    uint8_t _pos[N];    // Heap index per id, NOT_ARMED if idle
+    uint8_t _size;
+
+    bool before(uint8_t a, uint8_t b) const {
+        return (int32_t)(_heap[a].deadline - _heap[b].deadline) < 0;
+    }
+
+    void swapAt(uint8_t a, uint8_t b) {
+        Entry t = _heap[a];
+        _heap[a] = _heap[b];
+        _heap[b] = t;
+        _pos[_heap[a].id] = a;
+        _pos[_heap[b].id] = b;
+    }
+
+    uint8_t siftUp(uint8_t i) {
+        while (i > 0) {
+            uint8_t parent = (i - 1) / 2;
+            if (!before(i, parent)) break;
+            swapAt(i, parent);
+            i = parent;
+        }
+        return i;
+    }
+
+    void siftDown(uint8_t i) {
+        for (;;) {
+            uint8_t least = i;
+            uint8_t l = 2 * i + 1, r = 2 * i + 2;
+            if (l < _size && before(l, least)) least = l;
+            if (r < _size && before(r, least)) least = r;
+            if (least == i) return;
+            swapAt(i, least);
+            i = least;
+        }
+    }
+
+    void removeAt(uint8_t i) {
+        uint8_t id = _heap[i].id;
+        uint8_t last = --_size;
+        if (i != last) {
+            swapAt(i, last);
+            siftDown(siftUp(i));
+        }
+        _pos[id] = NOT_ARMED;
+    }
+};
+
+#endif
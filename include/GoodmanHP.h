@@ -6,8 +6,12 @@
 #include <functional>
 #include <DallasTemperature.h>
 #include <TaskSchedulerDeclarations.h>
+#include "DeadlineTimers.h"
 #include "InputPin.h"
 #include "OutPin.h"
+#include "OutputTimerWheel.h"
+#include "SensorAcquisition.h"
+#include "TraceRecorder.h"
 #include "TempSensor.h"
 
 class GoodmanHP {
@@ -15,6 +19,40 @@ class GoodmanHP {
     enum class State { OFF, COOL, HEAT, DEFROST, ERROR, LOW_TEMP };
     typedef std::function<void(State newState, State oldState)> StateChangeCallback;
     typedef std::function<void(bool active)> LPSFaultCallback;
+    // One call per committed output transaction; masks are bit per OutputId
+    typedef std::function<void(uint8_t onMask, uint8_t changedMask)> OutputChangeCallback;
+
+    // Fixed slots for the pins and sensors used on the update() hot path.
+    // Set by id (BoardPins) or resolved by name in addInput/addOutput/addTempSensor;
+    // the String-keyed maps stay the source of truth for the web and config layers.
+    enum class InputId : uint8_t { LPS, DFT, Y, O, COUNT };
+    enum class OutputId : uint8_t { FAN, CNT, W, RV, COUNT };
+    enum class SensorId : uint8_t { AMBIENT, COMPRESSOR, SUCTION, CONDENSER, LIQUID, COUNT };
+
+    // Software defrost sequence (see DEFROST_NODES/DEFROST_TRANSITIONS in
+    // GoodmanHP.cpp). Leaf phases are the only values _defrostPhase takes; the
+    // ANY_* superstates group phases that share transitions.
+    enum class DefrostPhase : uint8_t {
+        NONE,               // No defrost
+        PENDING,            // Requested (runtime, restore, Y dropped before ACTIVE); restarts on Y in HEAT
+        ENTRY_EQUALIZE,     // Entry Phase 1: all off, RV short cycle
+        ENTRY_CNT_WAIT,     // Entry Phase 2: RV+W on, CNT short cycle
+        ACTIVE,             // Phase 3: CNT on, until condenser clear or timeout
+        SUSPENDED,          // Y dropped while ACTIVE: outputs off, defrost clock keeps running
+        EXIT_EQUALIZE,      // Exit Phase 1: CNT+FAN off, RV+W on, RV short cycle
+        EXIT_CNT_WAIT,      // Exit Phase 2: RV+W off, CNT short cycle
+        COUNT,
+        ANY_REQUESTED = COUNT,  // PENDING, ENTRY_*, ACTIVE, SUSPENDED
+        ANY_ENTRY,              // ENTRY_EQUALIZE, ENTRY_CNT_WAIT
+        ANY_RUNNING,            // ACTIVE, SUSPENDED
+        ANY_EXIT,               // EXIT_EQUALIZE, EXIT_CNT_WAIT
+        NODE_COUNT
+    };
+
+    // Protection rules, in evaluation order (see PROTECTION_RULES in GoodmanHP.cpp)
+    enum class ProtectionId : uint8_t {
+        COMPRESSOR_OVERTEMP, SUCTION_LOW_TEMP, HIGH_SUCTION_TEMP, LPS_FAULT, LOW_AMBIENT, COUNT
+    };
 
     // Defrost constants
     static const uint32_t HEAT_RUNTIME_THRESHOLD_MS = 90UL * 60 * 1000;  // 90 min
@@ -23,6 +61,7 @@ class GoodmanHP {
     static constexpr float DEFROST_EXIT_F = 60.0f;
     static const uint32_t DEFROST_COND_CHECK_MS = 60UL * 1000;            // 1 min condenser recheck
     static constexpr float DEFAULT_LOW_TEMP_F = 20.0f;
+    static constexpr float LOW_TEMP_CLEAR_BAND_F = 2.0f;        // Low ambient clears this far above the threshold
 
     // High suction temp / RV fail detection during defrost
     static constexpr float DEFAULT_HIGH_SUCTION_TEMP_F = 140.0f;
@@ -32,6 +71,10 @@ class GoodmanHP {
     // Startup lockout — keep all outputs OFF until sensors stabilize
     static const uint32_t STARTUP_LOCKOUT_MS = 3UL * 60 * 1000;  // 3 min
 
+    // update() runs right away on input edges, sensor changes and controller
+    // deadlines; the periodic tick is only a slow safety backstop
+    static const uint32_t UPDATE_BACKSTOP_MS = 5UL * 1000;  // 5s
+
     // Manual override timeout
     static const uint32_t MANUAL_OVERRIDE_TIMEOUT_MS = 30UL * 60 * 1000;  // 30 min
 
@@ -46,33 +89,143 @@ class GoodmanHP {
     static constexpr float SUCTION_RESUME_F = 40.0f;      // Resume above this
     static const uint32_t SUCTION_CHECK_MS = 60UL * 1000; // 1 min recheck
 
+    // Rules evaluated on every update() trip or clear only once their
+    // condition has held this long: three readings at the 1 s CRITICAL
+    // sampling interval, so one noisy reading cannot stop the compressor
+    static const uint32_t PROTECTION_CONFIRM_MS = 3UL * 1000;
+
+    // Consistent view of the controller, published by update() into one of two
+    // buffers and copied lock-free by readers on other tasks (AsyncTCP, HTTPS,
+    // MQTT) instead of walking the pin/sensor maps and re-reading GPIO.
+    static const uint8_t SNAPSHOT_MAX_TEMPS = 8;
+    static const uint8_t SNAPSHOT_NAME_LEN = 24;
+    struct Snapshot {
+        uint32_t generation;          // 0 = nothing published yet
+        uint32_t publishedMs;         // millis() at publish
+        State state;
+        uint8_t inputPresent;         // Bit per InputId
+        uint8_t inputActive;          // Input latch the update() ran on
+        uint32_t inputGeneration;     // Its generation (bumps on every level change)
+        uint8_t outputPresent;        // Bit per OutputId
+        uint8_t outputOn;             // Hardware state (isPinOn)
+        uint8_t inputPin[(uint8_t)InputId::COUNT];
+        int8_t outputPin[(uint8_t)OutputId::COUNT];
+        uint8_t faultMask;            // Bit per tripped ProtectionId
+        bool softwareDefrost;
+        DefrostPhase defrostPhase;
+        bool rvFail;
+        bool startupLockout;
+        bool shortCycleProtection;
+        bool defrostTransition;
+        bool defrostCntPending;
+        bool defrostExiting;
+        bool manualOverride;
+        uint32_t heatRuntimeMs;
+        // Countdowns as of publishedMs; use remainingMs() for the current value
+        uint32_t startupLockoutRemainMs;
+        uint32_t defrostTransitionRemainMs;
+        uint32_t defrostCntPendingRemainMs;
+        uint32_t manualOverrideRemainMs;
+        uint32_t cntShortCycleRemainMs;
+        // Valid sensors only, in map order
+        uint8_t tempCount;
+        struct {
+            char name[SNAPSHOT_NAME_LEN];
+            DeciF deciF;
+        } temps[SNAPSHOT_MAX_TEMPS];
+        // Output accounting as of each pin's last transition (outputChangeMs);
+        // use getOutputStats() for totals that include the running period
+        uint8_t outputAccountOn;      // Bit per OutputId, level the accounting last saw
+        uint16_t cyclesLastHour[(uint8_t)OutputId::COUNT];
+        uint32_t outputChangeMs[(uint8_t)OutputId::COUNT];
+        OutPinStats outputStats[(uint8_t)OutputId::COUNT];
+        // Input contact health as of each pin's last debounced change
+        // (inputChangeMs); use getInputStats() for level times up to now
+        uint8_t inputAccountOn;       // Bit per InputId, level the accounting last saw
+        uint32_t inputChangeMs[(uint8_t)InputId::COUNT];
+        InputPinStats inputStats[(uint8_t)InputId::COUNT];
+
+        bool isInputActive(InputId id) const { return inputActive & (1 << (uint8_t)id); }
+        bool isOutputOn(OutputId id) const { return outputOn & (1 << (uint8_t)id); }
+        bool isProtectionActive(ProtectionId id) const { return faultMask & (1 << (uint8_t)id); }
+        uint32_t remainingMs(uint32_t remainAtPublish) const {
+            uint32_t age = millis() - publishedMs;
+            return remainAtPublish > age ? remainAtPublish - age : 0;
+        }
+        void getOutputStats(OutputId id, OutPinStats& out) const {
+            uint8_t i = (uint8_t)id;
+            out = outputStats[i];
+            uint32_t running = millis() - outputChangeMs[i];
+            out.trackedMs += running;
+            if (outputAccountOn & (1 << i)) out.onMs += running;
+        }
+        void getInputStats(InputId id, InputPinStats& out) const {
+            uint8_t i = (uint8_t)id;
+            out = inputStats[i];
+            uint32_t running = millis() - inputChangeMs[i];
+            if (inputAccountOn & (1 << i)) out.activeMs += running; else out.inactiveMs += running;
+        }
+    };
+
     GoodmanHP(Scheduler *ts);
 
     void setDallasTemperature(DallasTemperature *sensors);
+    // Before begin(): the MCP9600 behind sensor signals its alerts on gpio
+    void setTempSensorAlertPin(TempSensor *sensor, uint8_t gpio);
+    // Trace replay calls update() at the recorded times instead of the task
+    void setUpdateTaskEnabled(bool enabled);
     void begin();
     void update();
 
+    // Event-driven wakeups: run update() on the next scheduler pass
+    void requestUpdate();
+    void requestUpdateFromISR();    // ISR/any-task safe, only sets a flag
+    void serviceUpdateRequests();   // Call from loop() before ts.execute()
+    bool isUpdateRequestPending() const { return _isrUpdateRequest || _acquisition.hasPendingChanges(); }
+    uint32_t getUpdateCount() const;
+
+    // Copy of the latest published snapshot; safe from any task
+    void readSnapshot(Snapshot& out) const;
+    static const char* getInputName(InputId id);
+    static const char* getOutputName(OutputId id);
+
     // Pin map management
     void addInput(const String& name, InputPin* pin);
     void addOutput(const String& name, OutPin* pin);
+    // Slot-known pins (BoardPins); mapped under getInputName/getOutputName
+    void addInput(InputId id, InputPin* pin);
+    void addOutput(OutputId id, OutPin* pin);
     InputPin* getInput(const String& name);
     OutPin* getOutput(const String& name);
+    InputPin* getInput(InputId id) const { return _inputs[(uint8_t)id]; }
+    OutPin* getOutput(OutputId id) const { return _outputs[(uint8_t)id]; }
     std::map<String, InputPin*>& getInputMap();
     std::map<String, OutPin*>& getOutputMap();
 
     // Temperature sensor management
     void addTempSensor(const String& name, TempSensor* sensor);
     TempSensor* getTempSensor(const String& name);
-    TempSensorMap& getTempSensorMap();
+    TempSensor* getTempSensor(SensorId id);
+    // Read-only view for MQTT, the web handlers and config saves
+    const TempSensorMap& getTempSensorMap() const { return _tempSensorMap; }
+    // For the config loader and discovery in setup(), which add and remove
+    // sensors through the map; the sensor slots are re-resolved on the next
+    // indexed lookup. Loop task only.
+    TempSensorMap& editTempSensorMap();
     void clearTempSensors();
+    const SensorAcquisition& getSensorAcquisition() const { return _acquisition; }
 
     State getState();
     const char* getStateString();
+    static const char* getStateName(State state);
 
+    // Read the input latch, never the pins: every check within one update()
+    // sees the same levels
     bool isYActive();
     bool isOActive();
     bool isLPSActive();
     bool isDFTActive();
+    uint32_t getInputGeneration() const { return _inputGeneration; }
 
     uint32_t getYActiveTime();
 
@@ -85,6 +238,7 @@ class GoodmanHP {
     bool isLowTempActive() const;
     bool isCompressorOverTempActive() const;
     bool isSuctionLowTempActive() const;
+    bool isProtectionActive(ProtectionId id) const;
     void setLowTempThreshold(float threshold);
     float getLowTempThreshold() const;
 
@@ -98,8 +252,10 @@ class GoodmanHP {
     bool isDefrostTransitionActive() const;
     bool isDefrostCntPendingActive() const;
     bool isDefrostExitingActive() const;
+    DefrostPhase getDefrostPhase() const { return _defrostPhase; }
+    static const char* getDefrostPhaseName(DefrostPhase phase);
     uint32_t getDefrostCntPendingRemainingMs() const;
-    void clearRvFail();
+    String clearRvFail();
     void setRvFail();
     void setHighSuctionTempThreshold(float f);
     float getHighSuctionTempThreshold() const;
@@ -117,27 +273,37 @@ class GoodmanHP {
     void setHeatRuntimeThresholdMs(uint32_t ms);
     uint32_t getHeatRuntimeThresholdMs() const;
 
-    // Manual override for pin control page
+    // Manual override for pin control page. These (and clearRvFail()) are
+    // called from the web tasks: they check the command against the latest
+    // snapshot and queue it, and serviceUpdateRequests() applies it on the
+    // loop task. An empty return means queued, not yet applied.
     bool isManualOverrideActive() const;
     uint32_t getManualOverrideRemainingMs() const;
-    void setManualOverride(bool on);
+    String setManualOverride(bool on);
     String setManualOutput(const String& name, bool on);
     String forceDefrost();
+    // Loop task (and trace replay): check and apply one command now
+    String runCommand(TraceCommand id, bool on, uint8_t slot = 0);
 
     void restoreSoftwareDefrost();
 
     void setStateChangeCallback(StateChangeCallback cb);
     void setLPSFaultCallback(LPSFaultCallback cb);
+    void setOutputChangeCallback(OutputChangeCallback cb);
 
   private:
     Scheduler *_ts;
     Task *_tskUpdate;
-    Task *_tskCheckTemps;
-    DallasTemperature *_sensors;
 
     std::map<String, InputPin*> _inputMap;
     std::map<String, OutPin*> _outputMap;
     TempSensorMap _tempSensorMap;
+    InputPin* _inputs[(uint8_t)InputId::COUNT];
+    OutPin* _outputs[(uint8_t)OutputId::COUNT];
+    TempSensor* _tempSensors[(uint8_t)SensorId::COUNT];
+    bool _tempSensorsDirty;
+    uint8_t _inputLatch;        // Bit per active InputId, sampled by latchInputs()
+    uint32_t _inputGeneration;  // Bumped whenever _inputLatch changes
 
     State _state;
     uint32_t _yActiveStartTick;
@@ -145,57 +311,310 @@ class GoodmanHP {
     bool _cntActivated;
 
     uint32_t _cntShortCycleMs;  // Configurable CNT short cycle delay (default 30s)
+    volatile bool _cntMinOffStale;  // CNT pin not yet retimed to _cntShortCycleMs
     uint32_t _defrostMinRuntimeMs;  // Configurable defrost min runtime (default 3 min)
-    float _defrostExitTempF;        // Configurable condenser temp cutoff (default 60°F)
+    DeciF _defrostExit;             // Configurable condenser temp cutoff (default 60°F)
     uint32_t _heatRuntimeThresholdMs; // Configurable heat runtime threshold for defrost (default 90 min)
 
     // Heat runtime accumulation & automatic defrost
     uint32_t _heatRuntimeMs;
     uint32_t _heatRuntimeLastTick;
     uint32_t _heatRuntimeLastLogMs;
-    bool _softwareDefrost;
-    uint32_t _defrostStartTick;
-    uint32_t _defrostLastCondCheckTick;
-    bool _lpsFault;
-    bool _lowTemp;
-    float _lowTempThreshold;
-    bool _compressorOverTemp;
-    uint32_t _compressorOverTempStartTick;
-    uint32_t _compressorOverTempLastCheckTick;
-    bool _suctionLowTemp;
-    uint32_t _suctionLowTempStartTick;
-    uint32_t _suctionLowTempLastCheckTick;
+    DefrostPhase _defrostPhase;
+    uint32_t _defrostStartTick;       // millis() when ACTIVE was entered (kept through SUSPENDED)
+    bool _defrostDone;                // Timeout or condenser clear seen while running
+    DeciF _lowTemp;                   // Configurable ambient threshold (default 20°F)
     bool _rvFail;                     // Latched RV fail flag
-    bool _highSuctionTemp;            // Current high suction temp condition
-    float _highSuctionTempThreshold;  // Configurable threshold (default 140°F)
+    DeciF _highSuctionTemp;           // Configurable threshold (default 140°F)
     uint32_t _rvShortCycleMs;         // RV short cycle duration (configurable)
-    bool _defrostTransition;          // True during Phase 1 (RV pressure equalization)
-    uint32_t _defrostTransitionStart; // millis() when Phase 1 started
-    bool _defrostCntPending;          // True during Phase 2 (RV+W on, waiting for CNT SC)
-    uint32_t _defrostCntPendingStart; // millis() when Phase 2 started
-    bool _defrostExiting;             // True during defrost exit transition (reverse 3-phase)
     bool _manualOverride;
-    uint32_t _manualOverrideStart;
     bool _startupLockout;
-    uint32_t _startupTick;
+    volatile bool _isrUpdateRequest;
+    uint32_t _updateCount;
+
+    // Controller timeouts. runControlLoop() expires due deadlines first, so
+    // the checks below it test isTimerArmed() instead of subtracting ticks.
+    // Protection rechecks and confirmations use one id per ProtectionId from
+    // PROTECTION_RECHECK and PROTECTION_CONFIRM.
+    // Config setters on the web tasks retime timers too, so heap updates go
+    // through _timerMux.
+    enum class TimerId : uint8_t {
+        STARTUP_LOCKOUT,
+        MANUAL_OVERRIDE,
+        Y_SHORT_CYCLE,          // Y active this long before a short-cycled CNT restarts
+        DEFROST_SETTLE,         // Current defrost phase's DefrostNode::settleMs
+        DEFROST_MIN_RUNTIME,
+        DEFROST_TIMEOUT,
+        DEFROST_COND_CHECK,
+        PROTECTION_RECHECK,
+        PROTECTION_CONFIRM = PROTECTION_RECHECK + (uint8_t)ProtectionId::COUNT,
+        COUNT = PROTECTION_CONFIRM + (uint8_t)ProtectionId::COUNT
+    };
+    DeadlineTimers<(uint8_t)TimerId::COUNT> _timers;
+    mutable portMUX_TYPE _timerMux;
+    OutputTimerWheel _outputTimers;   // Every output's on-delay, runtime and minimum off timers
+    SensorAcquisition _acquisition;   // Owns the sensor buses; readings arrive in each TempSensor
+    // Thresholds last handed to _acquisition, per SensorId (count 0xFF = never)
+    DeciF _sensorThresholds[(uint8_t)SensorId::COUNT][SensorAcquisition::MAX_THRESHOLDS];
+    uint8_t _sensorThresholdCount[(uint8_t)SensorId::COUNT];
+    void pushSensorThresholds();
+    void armTimer(TimerId id, uint32_t now, uint32_t ms);
+    void cancelTimer(TimerId id);
+    bool isTimerArmed(TimerId id) const { return _timers.isArmed((uint8_t)id); }
+    uint32_t timerRemainingMs(TimerId id) const;
+    void retimeTimer(TimerId id, uint32_t oldMs, uint32_t newMs);  // Config change while armed
+    void expireTimers();
+    static TimerId recheckTimer(ProtectionId id) {
+        return (TimerId)((uint8_t)TimerId::PROTECTION_RECHECK + (uint8_t)id);
+    }
+    static TimerId confirmTimer(ProtectionId id) {
+        return (TimerId)((uint8_t)TimerId::PROTECTION_CONFIRM + (uint8_t)id);
+    }
     StateChangeCallback _stateChangeCb;
     LPSFaultCallback _lpsFaultCb;
+    OutputChangeCallback _outputChangeCb;
+
+    // Output transaction. Changes requested during update() (or one mutator
+    // call) are staged here and committed together: the CNT short-cycle guard
+    // runs once, all GPIOs flip in one set/clear register write, and one log
+    // line and callback describe the whole transition.
+    struct OutputTransaction {
+        uint8_t depth;
+        uint8_t stagedMask;       // Outputs with a pending level
+        uint8_t onMask;           // Pending level, valid where stagedMask is set
+        const char* reason[(uint8_t)OutputId::COUNT];
+    };
+    OutputTransaction _outTxn;
+
+    // Commands queued by the web tasks, applied by serviceCommands() on the
+    // loop task so controller state and _outTxn have a single writer.
+    struct Command {
+        TraceCommand id;
+        bool on;
+        uint8_t slot;             // MANUAL_OUTPUT: OutputId
+    };
+    static const uint8_t COMMAND_QUEUE_LEN = 8;
+    Command _commands[COMMAND_QUEUE_LEN];
+    uint8_t _commandHead;
+    uint8_t _commandCount;
+    portMUX_TYPE _commandMux;
+
+    // What a command is checked against: the live controller on the loop
+    // task, the published snapshot when queueing
+    struct CommandView {
+        State state;
+        uint8_t faultMask;
+        DefrostPhase defrostPhase;
+        bool manualOverride;
+        bool rvFail;
+        uint8_t outputPresent;
+        uint32_t cntShortCycleRemainMs;
+    };
+    static String commandError(const CommandView& view, const Command& cmd);
+    String queueCommand(const Command& cmd);
+    void serviceCommands();
+    void applyManualOverride(bool on);
+    void applyManualOutput(OutputId id, bool on);
+    String applyForceDefrost();
+    void applyClearRvFail();
+
+    // Snapshot double buffer. _snapshotGen selects the buffer (gen & 1); each
+    // buffer carries its own sequence (odd while being written) so a reader
+    // that races a second publish into its buffer retries.
+    struct SnapshotBuffer {
+        volatile uint32_t seq;
+        uint32_t statsVersion;      // Sum of OutPin stats versions copied into data
+        uint32_t inputStatsVersion; // Same for InputPin
+        Snapshot data;
+    };
+    SnapshotBuffer _snapshots[2];
+    volatile uint32_t _snapshotGen;
+
+    // --- Protection rule engine ---
+    // Each rule is one table entry: source, trip/clear hysteresis, recheck
+    // period, scope filter, inhibits and action masks. evaluateProtections()
+    // walks the table once per update() over a snapshot of the sources.
+    enum class ProtectionSource : uint8_t { COMPRESSOR_TEMP, SUCTION_TEMP, AMBIENT_TEMP, LPS_INPUT, COUNT };
+    enum class TripDirection : uint8_t { ABOVE, BELOW };
+
+    // Scope bits: one per State, plus controller phases that are not a State
+    static const uint16_t SCOPE_ANY = 0xFFFF;
+    static const uint16_t SCOPE_DEFROST_ACTIVE = 1 << 8;  // Defrost ACTIVE or SUSPENDED (past Phase 1/2)
 
-    void checkLPSFault();
-    void checkAmbientTemp();
-    void checkCompressorTemp();
-    void checkSuctionTemp();
-    void checkHighSuctionTemp();
+    enum ProtectionAction : uint16_t {
+        ACT_CNT_OFF       = 1 << 0,   // Shut down CNT; CNT stays held off while tripped
+        ACT_FAN_ON        = 1 << 1,
+        ACT_FAN_OFF       = 1 << 2,
+        ACT_RV_OFF        = 1 << 3,
+        ACT_W_ON_HEAT     = 1 << 4,   // W on if HEAT requested (Y active, O inactive)
+        ACT_W_ON_NOT_COOL = 1 << 5,   // W on unless O active
+        ACT_W_OFF_IF_COOL = 1 << 6,   // W off if O active
+        ACT_W_OFF         = 1 << 7,
+        ACT_LATCH_RV_FAIL = 1 << 8,
+        ACT_STOP_DEFROST  = 1 << 9,   // Abort software defrost, clear heat runtime
+        ACT_RESET_Y_TIMER = 1 << 10   // Restart the CNT short cycle timer from now
+    };
+
+    enum ProtectionFlag : uint8_t {
+        FLAG_ENTER_STATE   = 1 << 0,  // Trip sets _state to tripState
+        FLAG_NOTIFY_CLEAR  = 1 << 1,  // Fire state change callback on clear
+        FLAG_LPS_CALLBACK  = 1 << 2,  // Fire LPS fault callback on trip/clear
+        FLAG_NO_AUTO_CLEAR = 1 << 3,  // Latched until cleared explicitly
+        FLAG_TRIP_WARN     = 1 << 4,  // Log trip as warning instead of error
+        FLAG_CLEAR_INFO    = 1 << 5   // Log clear as info instead of warning
+    };
+
+    struct ProtectionRule {
+        ProtectionId id;
+        const char* name;
+        ProtectionSource source;
+        TripDirection direction;
+        DeciF trip;                   // Fixed thresholds, used when the ref is null
+        DeciF clear;
+        DeciF GoodmanHP::* tripRef;   // Configurable threshold member, or nullptr
+        DeciF GoodmanHP::* clearRef;
+        DeciF warn;                   // Warn band (DECIF_NONE = none)
+        DeciF clearBand;              // Added past the clear threshold on the recovery side
+        uint32_t recheckMs;           // 0 = evaluate every update()
+        uint32_t confirmMs;           // Trip/clear condition must hold this long (0 = at once)
+        uint16_t scope;               // Evaluated for a new trip only in these scopes
+        uint16_t holdScope;           // A tripped rule auto-clears outside these scopes
+        uint8_t inhibitMask;          // Skipped while any of these rules are tripped
+        State tripState;              // With FLAG_ENTER_STATE
+        uint16_t tripActions;
+        uint16_t holdActions;         // Applied on each evaluation while tripped
+        uint16_t clearActions;
+        uint8_t flags;
+    };
+
+    struct ProtectionStatus {
+        uint32_t startTick;
+        bool confirming;              // Condition seen, confirm timer armed or just expired
+    };
+
+    struct ProtectionSnapshot {
+        DeciF value[(uint8_t)ProtectionSource::COUNT];   // LPS_INPUT: 1.0 (10) active, 0 not
+        uint8_t validMask;
+    };
+
+    static const ProtectionRule PROTECTION_RULES[];
+    ProtectionStatus _protection[(uint8_t)ProtectionId::COUNT];
+    uint8_t _faultMask;       // Bit per tripped ProtectionId
+    uint8_t _cntHoldMask;     // Rules whose trip holds CNT off
+
+    static uint8_t protectionBit(ProtectionId id) { return 1 << (uint8_t)id; }
+    bool isTripped(ProtectionId id) const { return (_faultMask & protectionBit(id)) != 0; }
+    bool isCntHeldOff() const { return (_faultMask & _cntHoldMask) != 0; }
+    uint16_t currentScope() const;
+    void readProtectionSnapshot(ProtectionSnapshot& snap);
+    void evaluateProtections();
+    void evaluateRule(const ProtectionRule& rule, const ProtectionSnapshot& snap, uint32_t now);
+    bool confirmCondition(const ProtectionRule& rule, bool holds, uint32_t now);
+    DeciF clearThreshold(const ProtectionRule& rule) const;
+    void tripProtection(const ProtectionRule& rule, DeciF value, DeciF threshold, uint32_t now);
+    void clearProtection(const ProtectionRule& rule, const char* reason, uint32_t now);
+    void applyProtectionActions(uint16_t actions, const ProtectionRule& rule);
+
+    static uint8_t outputBit(OutputId id) { return 1 << (uint8_t)id; }
+    void beginOutputs();
+    void commitOutputs();
+    void setOutput(OutputId id, bool on, const char* reason);
+    bool isOutputOn(OutputId id);
+    uint32_t cntShortCycleRemainingMs() const;
+
+    void resolveTempSensors();
+    void latchInputs();
+    bool isInputActive(InputId id) const { return _inputLatch & (1 << (uint8_t)id); }
+    void runControlLoop();
+    void traceTempSample(TempSensor* sensor);
+    void publishSnapshot();
+    uint32_t nextDeadlineMs();
+    void scheduleNextUpdate();
     void checkYAndActivateCNT();
     void updateState();
     void accumulateHeatRuntime();
-    void checkDefrostNeeded();
-    void startSoftwareDefrost();
-    void stopSoftwareDefrost();
 
-    // Runtime callback for OutPins
-    static GoodmanHP* _instance;
-    static bool outPinRuntimeCallback(OutPin* pin, uint32_t onDuration);
+    // --- Defrost state machine ---
+    // DEFROST_TRANSITIONS rows are grouped by source node; DEFROST_ROW_START
+    // indexes each node's slice. dispatchDefrost() walks the current phase
+    // and its superstates, evaluating only their rows for the trigger, and
+    // fires the first one whose guard bits all hold.
+    enum class DefrostTrigger : uint8_t {
+        TICK,           // Every update() (updateDefrost)
+        START,          // forceDefrost()
+        RESTORE,        // Persisted defrost restored from config
+        RESUME,         // Y returned in HEAT: state entered DEFROST
+        Y_DROP,         // Y falling edge
+        COOL_REQUEST,   // Thermostat switched to COOL
+        STOP,           // Protection ACT_STOP_DEFROST
+        ABORT           // Manual override enabled
+    };
+
+    enum DefrostCond : uint8_t {
+        COND_Y_ACTIVE       = 1 << 0,
+        COND_Y_INACTIVE     = 1 << 1,
+        COND_SETTLED        = 1 << 2,   // Phase's settle time (DefrostNode::settleMs) elapsed
+        COND_CNT_FREE       = 1 << 3,   // No tripped protection holds CNT off
+        COND_HEAT_DUE       = 1 << 4,   // Heat runtime reached the defrost threshold
+        COND_DONE           = 1 << 5,   // Running defrost timed out or condenser is clear
+        COND_HAS_OUTPUTS    = 1 << 6,   // CNT and RV outputs present
+        COND_ALL            = (1 << 7) - 1
+    };
+
+    typedef void (GoodmanHP::*DefrostAction)(uint32_t now);
+
+    struct DefrostNode {
+        const char* name;
+        DefrostPhase parent;                // NODE_COUNT = root
+        uint32_t GoodmanHP::* settleMs;     // Wait behind COND_SETTLED, or nullptr
+        DefrostAction during;               // Run on each TICK before the node's rows, or nullptr
+    };
+
+    struct DefrostTransition {
+        DefrostPhase from;                  // Leaf phase or ANY_* superstate
+        DefrostTrigger trigger;
+        uint8_t guards;                     // DefrostCond bits that must all hold
+        DefrostPhase to;                    // Always a leaf phase
+        DefrostAction action;               // Applied before the phase changes, or nullptr
+    };
+
+    static const DefrostNode DEFROST_NODES[];
+    static const DefrostTransition DEFROST_TRANSITIONS[];
+    static const uint8_t DEFROST_ROW_COUNT;
+    static const uint8_t DEFROST_ROW_START[];
+    static const uint16_t DEFROST_ANCESTRY[];
+
+    static constexpr uint8_t defrostRowsBefore(uint8_t node, uint8_t row = 0);
+    static constexpr uint16_t defrostAncestry(uint8_t node);
+    static constexpr bool defrostRowsValid(uint8_t row = 0);
+    static constexpr bool defrostNodesValid(uint8_t node = 0);
+    static bool phaseIn(DefrostPhase phase, DefrostPhase node) {
+        return (DEFROST_ANCESTRY[(uint8_t)phase] >> (uint8_t)node) & 1;
+    }
+    bool inDefrost(DefrostPhase node) const { return phaseIn(_defrostPhase, node); }
+    bool defrostGuardsHold(uint8_t guards, uint32_t now);
+    bool dispatchDefrost(DefrostTrigger trigger, uint32_t now);
+    void updateDefrost();
+
+    // Transition actions and the running-phase activity
+    void startDefrost(uint32_t now);
+    void startDefrostOnRuntime(uint32_t now);
+    void engageDefrostValves(uint32_t now);
+    void engageDefrostCompressor(uint32_t now);
+    void monitorDefrost(uint32_t now);
+    void beginDefrostExit(uint32_t now);
+    void endDefrost(uint32_t now);
+    void releaseDefrostValves(uint32_t now);
+    void finishDefrostExit(uint32_t now);
+    void restartDefrostEntry(uint32_t now);
+    void shutdownForYDrop(uint32_t now);
+    void cancelDefrostExit(uint32_t now);
+    void shutdownForYLost(uint32_t now);
+    void cancelDefrostForCool(uint32_t now);
+    void dropDefrostRequest(uint32_t now);
+    void abortDefrost(uint32_t now);
+
+    // Runtime checkpoints for OutPins
     bool handleOutPinRuntime(OutPin* pin, uint32_t onDuration);
 };
 
@@ -0,0 +1,51 @@
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+#include <Arduino.h>
+#ifndef NATIVE_SIM
+#include <freertos/semphr.h>
+#endif
+
+// Arbitrates Wire between the sensor acquisition task and the web handlers.
+// Every transaction outside setup() holds the bus through a Lock; a holder
+// keeps it for one transaction (the /i2c/scan handler locks per probed
+// address), so the acquisition task waits at most one probe. The FreeRTOS
+// mutex lends a waiting task's priority to the holder.
+class I2CBus {
+public:
+    static const uint32_t SENSOR_WAIT_MS = 5;         // Acquisition task: skip the read rather than wait longer
+    static const uint32_t SCAN_WAIT_MS = 50;
+    static const uint16_t TRANSACTION_TIMEOUT_MS = 10; // Wire timeout, bounds a held bus
+
+    // Scoped ownership; check locked() before touching Wire
+    class Lock {
+    public:
+        Lock(I2CBus& bus, uint32_t waitMs) : _bus(bus), _locked(bus.take(waitMs)) {}
+        ~Lock() { if (_locked) _bus.give(); }
+        bool locked() const { return _locked; }
+    private:
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+        I2CBus& _bus;
+        bool _locked;
+    };
+
+    I2CBus();
+    bool begin();
+    uint32_t getContentionCount() const { return _contentions; }   // take() calls that timed out
+
+private:
+    bool take(uint32_t waitMs);
+    void give();
+
+    volatile uint32_t _contentions;
+#ifdef NATIVE_SIM
+    bool _held;                     // One thread: a second taker never waits
+#else
+    SemaphoreHandle_t _mutex;
+#endif
+};
+
+extern I2CBus I2cBus;
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef INPUTDEBOUNCER_H
+#define INPUTDEBOUNCER_H
+
+#include <Arduino.h>
+#include <functional>
+#include <TaskSchedulerDeclarations.h>
+#include "InputPin.h"
+
+// Debounces every digital input from one scheduler task. Each sample is a
+// single read of the GPIO input register(s); the inputs are then integrated
+// together as a vertical counter: bit g of plane p is bit p of GPIO g's
+// "samples since it disagreed with its stable level" count, so one pass of
+// word-wide AND/XOR updates all counters at once. An input flips its stable
+// level after its own window (InputPin::getDebounceMs(), in SAMPLE_MS steps)
+// of consecutive disagreeing samples; any agreeing sample restarts it.
+//
+// The task samples every SAMPLE_MS only while some counter is running. Once
+// all inputs are settled it drops to IDLE_SAMPLE_MS, and a GPIO edge brings
+// it back through requestSampleFromISR().
+class InputDebouncer {
+public:
+    static const uint32_t SAMPLE_MS = 10;
+    static const uint32_t IDLE_SAMPLE_MS = TASK_SECOND;     // Backstop for a missed edge
+    static const uint8_t MAX_INPUTS = 8;
+    static const uint8_t PLANES = 8;                        // Windows up to 255 samples
+    static const uint32_t MAX_WINDOW_MS = ((1UL << PLANES) - 1) * SAMPLE_MS;
+
+    // Called after the pin has taken its new level; firstTick is the sample
+    // at which the run of disagreeing samples began
+    typedef std::function<void(InputPin* pin, uint32_t firstTick)> EdgeCallback;
+
+    explicit InputDebouncer(Scheduler* ts);
+
+    // Takes over isActive() for the pin; call after the pin's initPin()
+    bool addInput(InputPin* pin);
+    void setEdgeCallback(EdgeCallback clbk) { _edgeClbk = clbk; }
+    void begin();
+    void setSamplingEnabled(bool enabled);  // Replay applies the traced INPUT_DEBOUNCED levels instead
+    void seed();                    // Take the current levels as settled, no window (sim boot, replay)
+
+    void requestSampleFromISR();    // ISR safe, only sets a flag
+    void serviceSampleRequests();   // Call from loop() before ts.execute()
+
+private:
+    void sample();
+    uint64_t readInputs() const;
+
+    Task* _tsk;
+    InputPin* _pins[MAX_INPUTS];
+    uint32_t _firstTick[MAX_INPUTS];
+    uint8_t _count;
+    uint64_t _mask;                 // GPIOs owned by the debouncer
+    uint64_t _stable;               // Debounced level per GPIO
+    uint64_t _counter[PLANES];      // Vertical counter planes
+    uint64_t _window[PLANES];       // Per-GPIO window, same layout
+    volatile bool _isrSampleRequest;
+    EdgeCallback _edgeClbk;
+};
+
+#endif
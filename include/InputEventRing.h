@@ -0,0 +1,44 @@
+#ifndef INPUTEVENTRING_H
+#define INPUTEVENTRING_H
+
+#include <Arduino.h>
+
+// One GPIO edge as captured by inputISRChange
+struct InputEdgeEvent {
+    uint32_t cycles;    // CPU cycle counter at the edge (same core as the consumer)
+    uint8_t index;      // Slot in main.cpp's ISR input table
+    uint8_t level;      // digitalRead() inside the ISR
+};
+
+// Fixed-size single-producer/single-consumer ring between the GPIO ISR and
+// loop(). All GPIO interrupts are dispatched from one handler on the
+// core that attached them, so there is exactly one producer. No locks and no
+// allocation: the producer only advances _head, the consumer only _tail.
+// A full ring drops the new edge and counts it; the consumer still re-reads
+// the pin level, so a dropped edge delays but never loses a level change.
+class InputEventRing {
+public:
+    static const uint16_t CAPACITY = 64;    // Power of two
+
+    InputEventRing();
+
+    bool push(uint8_t index, uint8_t level);    // ISR only
+    bool pop(InputEdgeEvent& out);              // Consumer task only
+
+    uint32_t getOverflowCount() const { return _overflows; }
+    uint16_t getHighWater() const { return _highWater; }   // Most events queued at once
+
+    // Microseconds since an event's cycle stamp; valid for ~17 s at 240 MHz
+    static uint32_t ageUs(const InputEdgeEvent& ev);
+
+private:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "InputEventRing capacity must be a power of two");
+
+    InputEdgeEvent _events[CAPACITY];
+    uint16_t _head;             // Next slot to write, producer owned
+    uint16_t _tail;             // Next slot to read, consumer owned
+    volatile uint32_t _overflows;
+    volatile uint16_t _highWater;
+};
+
+#endif
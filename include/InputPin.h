@@ -2,7 +2,6 @@
 #define INPUTPIN_H
 
 #include <Arduino.h>
-#include <TaskSchedulerDeclarations.h>
 
 enum class InputResistorType{
   NONE,
@@ -18,10 +17,29 @@ enum class InputPinType{
 class InputPin;
 typedef void (*InputPinCallback)(InputPin *pin);
 
+// Per-input contact health, updated in O(1) per raw edge (drained from the
+// ISR ring) and per debounced change. Level times are as of the last
+// debounced change; the running period is added by the reader (getStats).
+struct InputPinStats {
+  static const uint8_t BUCKETS = 6;
+  static const uint8_t BUCKET_LIMIT[BUCKETS - 1];   // Raw edges per change, inclusive upper bounds
+  static const char* const BUCKET_LABELS[BUCKETS];
+  static uint8_t bucketFor(uint32_t rawEdges);
+
+  uint32_t edges;             // Debounced level changes
+  uint32_t rawEdges;          // Every edge the ISR saw, bounces included
+  uint32_t minPulseUs;        // Shortest raw level period, 0 = none yet
+  uint32_t bounceHist[BUCKETS];   // Raw edges behind each debounced change
+  uint64_t activeMs;          // Time at each debounced level
+  uint64_t inactiveMs;
+};
+
 class InputPin{
   private:
     InputPinType _it;
-    Task *_tsk;
+    uint32_t _debounceMs;
+    bool _debounced;
+    bool _sampled;                      // Analog value pushed by an AnalogSampler
     int8_t _pin;
     String _name;
     String _boardPin;
@@ -33,15 +51,23 @@ class InputPin{
     u_int32_t _lastActiveTick;
     u_int32_t _lastInactiveTick;
     InputPinCallback _clbk;
+    // Contact health accounting
+    InputPinStats _stats = {};
+    uint32_t _statsChangeTick = 0;      // Last debounced change (or initPin)
+    uint32_t _statsVersion = 0;
+    uint32_t _lastRawUs = 0;
+    uint32_t _lastRawMs = 0;
+    bool _rawSeen = false;
+    uint16_t _rawSinceChange = 0;
   protected:
     float mapFloat(float x, float in_min, float in_max, float out_min, float out_max);
-    void Callback();
   public:
-    InputPin(Scheduler *ts, uint32_t delay, InputResistorType pullup, InputPinType it, int8_t pin, String name, String boardPin, InputPinCallback clbk);
+    InputPin(uint32_t debounceMs, InputResistorType pullup, InputPinType it, int8_t pin, String name, String boardPin, InputPinCallback clbk);
     void initPin();
     uint8_t getPin();
     String getName();
-    Task * getTask();
+    uint32_t getDebounceMs();
+    InputPinType getType();
     float getPinState(float in_min, float in_max, float out_min, float out_max);
     uint16_t getPinState();
     uint16_t setPrevValue();
@@ -54,12 +80,21 @@ class InputPin{
     uint32_t verifiedAt();
     uint32_t lastActiveAt();
     uint32_t lastInactiveAt();
-    bool isActive();
+    bool isActive();                // Debounced level once an InputDebouncer owns the pin
+    void setDebounced(bool debounced);
+    void setSampledValue(uint16_t value);  // Latest filtered ADC value; getPinState() stops calling analogRead()
     void changedNow();
+    void recordEdge(uint16_t level, uint32_t tick, uint32_t tickUs);  // Edge drained from the ISR ring
+    void debouncedEdge(uint16_t level, uint32_t firstTick);  // Accepted by the InputDebouncer
     void verifiedNow();
     void activeNow();
     void inactiveNow();
     void fireCallback();
+    // Accounting: raw totals plus the tick of the last debounced change, or folded to now
+    const InputPinStats& getRawStats() const { return _stats; }
+    uint32_t getStatsChangeTick() const { return _statsChangeTick; }
+    uint32_t getStatsVersion() const { return _statsVersion; }
+    void getStats(InputPinStats& out) const;
 };
 
 #endif
@@ -18,6 +18,9 @@ class MQTTHandler {
     void setController(GoodmanHP* controller);
     void publishTemps();
     void publishState();
+    void publishRuntime();
+    void publishInputStats();
+    void publishSensorHealth();
     void publishFault(const char* fault, const char* message, bool active);
     void startReconnect();
     void stopReconnect();
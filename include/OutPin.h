@@ -2,18 +2,53 @@
 #define OUTPIN_H
 
 #include <Arduino.h>
+#include <functional>
 #include <TaskSchedulerDeclarations.h>
+#include "OutputTimerWheel.h"
 
 class OutPin;
 typedef bool (*OutputPinCallback)(OutPin *pin, bool on, bool inCallback, float &newPercent, float lastPercent);
-typedef bool (*RuntimeCallback)(OutPin *pin, uint32_t onDuration);
+// Return false to stop the runtime checkpoints until the next turn-on
+typedef std::function<bool(OutPin *pin, uint32_t onDuration)> RuntimeCallback;
+typedef std::function<void(OutPin *pin)> MinOffCallback;
+
+// Per-output runtime accounting, updated in O(1) on each off/on transition.
+// Totals are as of the last transition; the running period is added by the
+// reader (see OutPin::getStats). Persisted in the config "runtime" section.
+struct OutPinStats {
+  static const uint8_t BUCKETS = 8;
+  static const uint32_t BUCKET_LIMIT_MS[BUCKETS - 1];  // Upper bounds; last bucket is open
+  static const char* const BUCKET_LABELS[BUCKETS];
+  static uint8_t bucketFor(uint32_t ms);
+
+  uint64_t onMs;            // Cumulative on-time
+  uint64_t trackedMs;       // Time accounted while the controller ran
+  uint32_t cycles;          // Off -> on transitions
+  uint32_t shortestOffMs;   // Shortest off gap before a restart, 0 = none yet
+  uint32_t onHist[BUCKETS];   // Completed on-periods by duration
+  uint32_t offHist[BUCKETS];  // Off gaps that ended in a restart, by duration
+};
 
 class OutPin
 {
+  public:
+    // PWM outputs get their own LEDC channel, allocated upward from 0 (the
+    // core's analogWrite() allocates downward from the top)
+    static const uint8_t PWM_CHANNELS = 8;
+    static const uint8_t PWM_RESOLUTION_BITS = 8;
+    static const uint32_t PWM_VERIFY_MS = 10000;      // Default pad readback cadence, 0 = off
+    static const uint8_t PWM_VERIFY_SAMPLES = 64;     // Pad reads spread over one PWM period
+    static const uint8_t PWM_VERIFY_TOLERANCE = 64;   // Allowed |sampled - commanded| duty, of 255
   private:
+    static uint8_t _nextLedcChannel;
     Scheduler *_ts;
-    Task *_tsk;
-    Task *_tskRuntime;
+    Task *_tskVerify = nullptr;
+    // On-delay, runtime checkpoint and minimum-off timers live in a shared wheel
+    OutputTimerWheel *_timers = nullptr;
+    int8_t _timerOwner = -1;
+    uint32_t _onDelayMs;
+    uint32_t _minOffMs = 0;
+    MinOffCallback _minOffClbk = nullptr;
     int8_t _pin;
     String _name;
     String _boardPin;
@@ -30,10 +65,33 @@ class OutPin
     RuntimeCallback _runtimeClbk = nullptr;
     uint32_t _runtimeInterval = 1000;
     bool _transitioning = false;
-    bool _lastPwmHigh = false;
+    int8_t _ledcChannel = -1;
+    uint8_t _pwmDuty = 0;              // Last duty written to the LEDC channel
+    uint32_t _pwmVerifyMs = PWM_VERIFY_MS;
+    uint32_t _pwmVerifyMismatches = 0;
+    // Runtime accounting
+    OutPinStats _stats = {};
+    bool _statsOn = false;
+    bool _statsOffValid = false;       // First off period after boot is not a gap
+    uint32_t _statsChangeTick = 0;
+    uint32_t _statsVersion = 0;
+    uint32_t _cycleWindowStart = 0;
+    uint16_t _cyclesThisHour = 0;
+    uint16_t _cyclesLastHour = 0;
+    void accountLevel(bool on);
+    void rollCycleWindow(uint32_t now);
+    void armTimer(OutputTimerWheel::Kind kind, uint32_t delayMs);
+    void cancelTimer(OutputTimerWheel::Kind kind);
+    void startOnTimers();
+    void armRuntimeCheckpoint();
   protected:
     uint8_t percent_to_byte_float(float percent);
     void turnOnPercent(float percent);
+    void writePin(uint8_t level);
+    void writeDuty(uint8_t duty);
+    bool readOutputLatch();
+    void traceLevel(uint8_t level);
+    void verifyPwm();
   public:
     OutPin(Scheduler *ts, uint32_t delay, int8_t pin, String name, String boardPin, OutputPinCallback clbk);
     OutPin(Scheduler *ts, uint32_t delay, int8_t pin, String name, String boardPin, float percentOn, OutputPinCallback clbk);
@@ -52,15 +110,41 @@ class OutPin
     uint32_t getOnCount();
     void resetOnCount();
     float getOnPercent();
-    Task * getTask();
+    // Share the controller's timer wheel; call before initPin()
+    void attachTimers(OutputTimerWheel *timers);
+    void onTimer(OutputTimerWheel::Kind kind);
+    // Minimum off time: turn-on is refused until it has passed since the last turn-off
+    void setMinOffMs(uint32_t ms);
+    uint32_t getMinOffMs() const { return _minOffMs; }
+    uint32_t minOffRemainingMs() const;
+    void setMinOffCallback(MinOffCallback clbk) { _minOffClbk = clbk; }   // Minimum off time elapsed
     bool isOn();
-    bool isPinOn();
+    bool isPinOn();                   // Register read: GPIO output latch, or LEDC duty for PWM
     void initPin();
     void turnOff();
     void turnOn();
     void turnOn(float percent);
+    // Group writes (GoodmanHP::commitOutputs): everything turnOn()/turnOff() do
+    // except the GPIO write, which the caller batches with other pins.
+    // prepareLevel() returns false if the callback vetoed the change.
+    bool prepareLevel(bool on);
+    uint8_t levelFor(bool on) const { return (on != _inverse) ? HIGH : LOW; }
+    void finishLevel();
+    void writeLevel(bool on);         // GPIO level, or full/zero duty for PWM
+    // Sampled pad readback for PWM outputs on a slow background task
+    void setPwmVerifyInterval(uint32_t intervalMs);
+    uint32_t getPwmVerifyMismatches() const { return _pwmVerifyMismatches; }
+    uint8_t getPwmDuty() const { return _pwmDuty; }
     void setRuntimeCallback(RuntimeCallback clbk, uint32_t intervalMs = 1000);
     void runtimeCallback();
+    // Accounting: raw totals plus the tick of the last transition, or folded to now
+    const OutPinStats& getRawStats() const { return _stats; }
+    uint32_t getStatsChangeTick() const { return _statsChangeTick; }
+    uint32_t getStatsVersion() const { return _statsVersion; }
+    bool isStatsOn() const { return _statsOn; }
+    void getStats(OutPinStats& out) const;
+    uint16_t getCyclesLastHour();     // Starts during the last completed hour window
+    void restoreStats(const OutPinStats& stats);
 };
 
 #endif
@@ -0,0 +1,75 @@
+#ifndef OUTPUTTIMERWHEEL_H
+#define OUTPUTTIMERWHEEL_H
+
+#include <Arduino.h>
+#include <TaskSchedulerDeclarations.h>
+
+class OutPin;
+
+// One hashed timer wheel for every OutPin's on-delay, runtime checkpoint and
+// minimum-off timers, driven by a single scheduler task. A timer lives in the
+// slot of its deadline tick (TICK_MS per tick, SLOTS slots per revolution);
+// deadlines more than a revolution out share the slot with nearer ones and
+// are skipped until reached. Each timer keeps its exact millis() deadline,
+// so remainingMs() is exact and expiry is at most one tick late.
+//
+// The task never ticks through empty slots: after each pass it sleeps until
+// the end of the next occupied slot (one bit per slot in _occupied), and it
+// is disabled while no timer is armed. Scheduler load therefore depends on
+// the armed deadlines, not on the number of outputs.
+//
+// Not thread-safe: every call, like the scheduler task itself, must come from
+// the loop task. Outputs only switch there (GoodmanHP queues web commands and
+// defers config changes that retime a pin), so the wheel takes no lock.
+class OutputTimerWheel {
+public:
+    enum class Kind : uint8_t { ON_DELAY, RUNTIME, MIN_OFF, COUNT };
+
+    static const uint8_t MAX_OUTPUTS = 8;
+    static const uint8_t SLOTS = 64;
+    static const uint8_t TICK_SHIFT = 4;                // 16 ms ticks, 1024 ms per revolution; 2^32 ms is a whole number of revolutions
+    static const uint32_t TICK_MS = 1UL << TICK_SHIFT;
+
+    explicit OutputTimerWheel(Scheduler* ts);
+
+    int8_t attach(OutPin* pin);     // Owner index for arm/cancel, -1 when full
+    void arm(uint8_t owner, Kind kind, uint32_t now, uint32_t delayMs);
+    void cancel(uint8_t owner, Kind kind);
+    bool isArmed(uint8_t owner, Kind kind) const;
+    uint32_t remainingMs(uint8_t owner, Kind kind, uint32_t now) const;  // 0 when not armed or due
+    uint8_t getArmedCount() const { return _armed; }
+
+private:
+    static const uint8_t KINDS = (uint8_t)Kind::COUNT;
+    static const uint8_t TIMERS = MAX_OUTPUTS * KINDS;
+    static const uint8_t NONE = 0xFF;
+
+    struct Timer {
+        uint32_t deadline;
+        uint8_t slot;               // NONE while idle
+        uint8_t prev;
+        uint8_t next;
+    };
+
+    static bool reached(uint32_t now, uint32_t deadline) {
+        return (int32_t)(now - deadline) >= 0;
+    }
+    static uint8_t timerId(uint8_t owner, Kind kind) { return owner * KINDS + (uint8_t)kind; }
+
+    void link(uint8_t id, uint8_t slot);
+    void unlink(uint8_t id);
+    void advance();
+    void reschedule(uint32_t now);
+    void fire(uint8_t id);
+
+    Task* _tsk;
+    OutPin* _owners[MAX_OUTPUTS];
+    uint8_t _ownerCount;
+    Timer _timers[TIMERS];
+    uint8_t _head[SLOTS];
+    uint64_t _occupied;             // Bit per non-empty slot
+    uint32_t _sweptMs;              // Start of the newest tick whose slot has been swept
+    uint8_t _armed;
+};
+
+#endif
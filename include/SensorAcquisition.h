@@ -0,0 +1,241 @@
+#ifndef SENSORACQUISITION_H
+#define SENSORACQUISITION_H
+
+#include <Arduino.h>
+#include <DallasTemperature.h>
+#include <TaskSchedulerDeclarations.h>
+#include "TempSensor.h"
+
+// Reads every temperature sensor, on the 1-Wire (DS18B20) and I2C (MCP9600)
+// buses, from a dedicated FreeRTOS task pinned to TASK_CORE, off the loop
+// task that runs the scheduler, WiFi callbacks and web handlers.
+//
+// Each sensor has its own interval and DS18B20 resolution, picked from
+// TIERS by how close its last reading is to the nearest threshold the
+// controller is currently comparing it against (setThresholds()) and by how
+// fast it is moving towards it: a sensor a few degrees or seconds from a trip
+// point is read every 1-2 s at 12 bits, one with no threshold in reach backs
+// off to 30 s at 10 bits. A sweep starts when any sensor is due: Convert T is
+// sent to each due DS18B20 by address without waiting, the task sleeps for
+// the longest of their conversion times, polls the bus until they report
+// done, then reads them.
+//
+// A reading is published into the sensor's own slot (TempSensor::getReading()),
+// so getDeciF() from any task is lock-free and the controller never touches a
+// bus. Sensors that changed during a sweep are flagged once at its end;
+// serviceChanges() fires their change callbacks on the loop task and tells
+// the caller to re-run update().
+//
+// A DS18B20 read that fails its CRC or loses the presence pulse is retried
+// up to MAX_READ_ATTEMPTS times while the sweep's retries stay inside
+// RETRY_BUDGET_US; a sensor whose reads keep failing is published invalid
+// after FAILURES_TO_INVALIDATE sweeps. Readings that cannot be real are
+// dropped before they are published: the 85 °C power-on-reset value
+// (unless the sensor was already there), anything outside the DS18B20's
+// range, and a step faster than MAX_SLEW_PER_SEC (tenths of a °F per
+// second, plus STEP_ALLOWANCE) from the last accepted reading, unless the
+// next read confirms it. A dropped or failed read is
+// retried on the CRITICAL interval. Each outcome is counted per sensor.
+//
+// MCP9600 reads share Wire with the web handlers through I2cBus: when the
+// bus is held the read is skipped and the cached reading stands. With an
+// alert pin (setAlertPin()), the MCP9600's ALERT1/ALERT2 comparators are set
+// after each read to the nearest threshold above and below the reading, or
+// ALERT_BAND_F away when none is closer, so a crossing between reads
+// interrupts and makes the sensor due at once.
+//
+// The task times every sensor read and the total bus time of each sweep
+// (resolution writes, Convert T, completion polls and reads) per bus, and
+// sums it into a per-bus occupancy over OCCUPANCY_WINDOW_MS. The host build
+// has one thread, so there the same sweep steps run as a scheduler task.
+class SensorAcquisition {
+public:
+    static const uint8_t MAX_SENSORS = 8;
+    static const uint8_t MAX_THRESHOLDS = 4;
+    static const uint8_t NO_TRACE_ID = 0xFF;
+    static const uint32_t CONVERSION_POLL_MS = 20;            // Once the nominal conversion time has passed
+    static const uint32_t CONVERSION_TIMEOUT_MS = 1000;       // Read anyway; a stuck bus yields bad readings
+    // Each resolution change is a DS18B20 EEPROM write (~50k cycle endurance):
+    // a sensor keeps a new resolution at least this long before dropping it
+    static const uint32_t RESOLUTION_HOLD_MS = 2UL * 60 * 60 * 1000;
+    static const uint32_t OCCUPANCY_WINDOW_MS = 60UL * 1000;
+    static const uint8_t MAX_READ_ATTEMPTS = 3;               // Per sensor per sweep
+    static const uint32_t RETRY_BUDGET_US = 30000;            // Retry bus time per sweep, ~3 scratchpad reads
+    static const uint8_t FAILURES_TO_INVALIDATE = 3;          // Consecutive failed or dropped reads
+    // Temperatures below are in tenths of a °F (DeciF)
+    static const int32_t MAX_SLEW_PER_SEC = 10;               // 1°F/s
+    static const DeciF STEP_ALLOWANCE = 20;                   // Any step this small is plausible
+    static const DeciF ALERT_BAND = 100;                      // Alert limits without a nearer threshold
+    static const DeciF ALERT_MIN = 10;                        // Closest an alert limit sits to the reading
+    static const DeciF ALERT_STEP = 5;                        // Smaller limit moves are not written
+    static const uint32_t TASK_STACK_BYTES = 4096;
+    static const uint8_t TASK_PRIORITY = 6;                   // Above AsyncTCP and the HTTPS server, below WiFi/lwIP
+    static const uint8_t TASK_CORE = 0;                       // Keeps bus waits off the loop task's core
+
+    enum class Bus : uint8_t { ONE_WIRE, I2C, COUNT };
+    enum class Tier : uint8_t { CRITICAL, NEAR, NORMAL, FAR, COUNT };
+
+    // A sensor is in the first tier whose margin or horizon it is inside
+    struct TierPolicy {
+        Tier tier;
+        float marginF;              // Distance to the nearest threshold
+        uint32_t horizonSec;        // Time to reach it at the current rate
+        uint32_t intervalMs;
+        uint8_t resolution;         // DS18B20 bits
+    };
+    static const TierPolicy TIERS[(uint8_t)Tier::COUNT];
+
+    // Time spent on the bus, in microseconds: per read for a sensor, per
+    // sweep for a bus. Written by the acquisition task only; readers on
+    // other tasks may see a torn total, which is fine for diagnostics.
+    struct Timing {
+        uint32_t lastUs;
+        uint32_t maxUs;
+        uint32_t count;
+        uint64_t totalUs;
+        uint32_t avgUs() const { return count > 0 ? (uint32_t)(totalUs / count) : 0; }
+    };
+
+    // Read outcomes of one sensor since boot, counted by the acquisition
+    // task; readers on other tasks may see a torn set, as with Timing
+    struct Health {
+        uint32_t crcErrors;         // Scratchpad CRC mismatches, each attempt
+        uint32_t disconnects;       // No presence pulse, each attempt
+        uint32_t timeouts;          // Conversions not done within CONVERSION_TIMEOUT_MS
+        uint32_t retries;
+        uint32_t powerOnResets;     // 85 °C reset values dropped
+        uint32_t implausible;       // Out-of-range readings and steps dropped
+        uint32_t failedReads;       // Sweeps that ended without a usable reading
+        uint32_t busBusy;           // I2C reads skipped while another task held the bus
+        uint32_t alerts;            // MCP9600 alert interrupts
+        uint8_t consecutiveFailures;
+    };
+
+    // Current schedule of one sensor, for /temps
+    struct Schedule {
+        Tier tier;
+        uint32_t intervalMs;
+        uint8_t resolution;         // 0 for I2C sensors
+        float marginF;              // INFINITY without a threshold, NAN before a
+                                    // valid reading
+        float rateFps;              // Smoothed |dF/dt|
+    };
+
+    // Bus load over the last full OCCUPANCY_WINDOW_MS
+    struct Occupancy {
+        uint16_t permille;          // Bus busy time per 1000 of wall time
+        uint16_t readsPerMin;
+    };
+
+    explicit SensorAcquisition(Scheduler* ts);
+
+    void setDallasTemperature(DallasTemperature* sensors);
+    // Call before begin(). traceId is the sensor's TEMP_SAMPLE record id.
+    bool addSensor(TempSensor* sensor, uint8_t traceId = NO_TRACE_ID);
+    // Call before begin(): the MCP9600 behind sensor has its alert outputs
+    // wired to gpio (open drain, active low)
+    void setAlertPin(const TempSensor* sensor, uint8_t gpio);
+    bool begin();
+    bool isRunning() const { return _running; }
+
+    // Any task: the thresholds the controller compares this sensor against
+    // right now (trip points in scope, clear points of tripped protections).
+    // A sensor whose thresholds change is re-planned before the next sweep.
+    void setThresholds(const TempSensor* sensor, const DeciF* thresholds, uint8_t count);
+
+    // Loop task: fires the change callbacks of sensors whose reading changed
+    // in a finished sweep; true when there were any
+    bool serviceChanges();
+    bool hasPendingChanges() const { return _pendingChanges != 0; }
+
+    uint8_t getSensorCount() const { return _count; }
+    bool getSensorTiming(const TempSensor* sensor, Timing& out) const;
+    bool getSensorSchedule(const TempSensor* sensor, Schedule& out) const;
+    bool getSensorHealth(const TempSensor* sensor, Health& out) const;
+    const Timing& getBusTiming(Bus bus) const { return _busTiming[(uint8_t)bus]; }
+    Occupancy getBusOccupancy(Bus bus) const { return _occupancy[(uint8_t)bus]; }
+    uint32_t getConversionMs() const { return _conversionMs; }     // Convert T to done, last sweep
+    uint32_t getSweepCount() const { return _sweeps; }
+    uint32_t getResolutionWrites() const { return _resolutionWrites; }
+    static const char* getTierName(Tier tier);
+
+private:
+    enum class Phase : uint8_t { IDLE, CONVERTING, READING };
+
+    struct Entry {
+        TempSensor* sensor;
+        uint8_t traceId;
+        Bus bus;
+        Timing timing;
+        Schedule schedule;
+        uint32_t dueMs;
+        uint32_t lastReadMs;        // Last accepted reading
+        DeciF lastValue;            // For the rate and the step check
+        bool primed;                // lastValue holds an accepted reading
+        uint8_t resolution;         // Set on the device
+        uint32_t resolutionSetMs;
+        DeciF thresholds[MAX_THRESHOLDS];
+        uint8_t thresholdCount;
+        Health health;
+        bool suspect;               // suspectValue was dropped as a step; a read near it confirms it
+        DeciF suspectValue;
+        uint32_t suspectMs;
+        bool alertArmed;            // MCP9600 alert outputs configured
+        DeciF alertLow;
+        DeciF alertHigh;
+    };
+
+    uint32_t step();                // One sweep step; returns ms until the next
+    uint32_t startSweep(uint32_t now);
+    void readSensor(Entry& entry, uint32_t now);
+    bool readOneWire(Entry& entry, DeciF& value);
+    bool plausible(Entry& entry, DeciF value, uint32_t now);
+    void armAlerts(Entry& entry, DeciF value);
+    void requestReadFromISR();
+    static void onAlertISR(void* arg);
+    void plan(Entry& entry, uint32_t now);
+    void endSweep(uint32_t now);
+    uint32_t msUntilDue(uint32_t now) const;
+    static void addTiming(Timing& timing, uint32_t us);
+    static bool reached(uint32_t now, uint32_t due) { return (int32_t)(now - due) >= 0; }
+#ifndef NATIVE_SIM
+    static void taskMain(void* arg);
+#endif
+
+    DallasTemperature* _bus;
+    Entry _entries[MAX_SENSORS];
+    uint8_t _count;
+    uint8_t _oneWireCount;
+    bool _running;
+    Phase _phase;
+    uint32_t _sweepMask;            // Bit per entry due in this sweep
+    uint8_t _sweepBuses;            // Bit per Bus with a due entry
+    uint8_t _readIndex;             // Next _entries index to consider
+    uint32_t _sweepStartMs;
+    uint32_t _sweepChanges;         // Bit per entry changed in this sweep
+    volatile uint32_t _pendingChanges;   // Finished sweeps, not yet serviced
+    volatile uint32_t _replanMask;  // Entries whose thresholds changed
+    bool _sweepTimedOut;            // Conversion never reported done
+    uint32_t _sweepRetryUs;
+    uint32_t _sweepBusUs[(uint8_t)Bus::COUNT];
+    Timing _busTiming[(uint8_t)Bus::COUNT];
+    uint32_t _windowStartMs;
+    uint64_t _windowBusUs[(uint8_t)Bus::COUNT];
+    uint32_t _windowReads[(uint8_t)Bus::COUNT];
+    Occupancy _occupancy[(uint8_t)Bus::COUNT];
+    uint32_t _conversionMs;
+    uint32_t _sweeps;
+    uint32_t _resolutionWrites;
+    const TempSensor* _alertSensor;
+    uint8_t _alertPin;
+    int8_t _alertIndex;             // Entry behind the alert pin, -1 without one
+    volatile bool _alertPending;
+    mutable portMUX_TYPE _mux;      // Guards Entry::thresholds
+#ifdef NATIVE_SIM
+    Task* _tsk;
+#else
+    TaskHandle_t _task;
+#endif
+};
+
+#endif
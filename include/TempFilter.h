@@ -0,0 +1,62 @@
+#ifndef TEMPFILTER_H
+#define TEMPFILTER_H
+
+#include <Arduino.h>
+#include "TempFixed.h"
+
+// Per-sensor reading pipeline, run on each accepted reading before it is
+// published: median of the last N readings, then an EMA, then a slew-rate
+// limit, then a deadband against the last published value. Each stage is
+// off at its neutral setting; DEFAULTS is the old fixed 0.33°F deadband
+// alone. Readings go in and out as DeciF; the EMA and slew stages keep
+// fractional tenths between readings. All state is inline (the median
+// window is a fixed array), so a sensor's filter never allocates.
+//
+// One writer: the acquisition task feeds readings; configure() is for
+// setup(), before the task starts.
+class TempFilter {
+public:
+    static const uint8_t MAX_MEDIAN = 7;
+
+    struct Config {
+        uint8_t median;             // Window length, 1 = off; odd, at most MAX_MEDIAN
+        float emaTauSec;            // EMA time constant in seconds, 0 = off
+        float slewFPerSec;          // Largest output change per second, 0 = off
+        float deadbandF;            // Publish only moves larger than this
+    };                              // In °F, as configured; applied in tenths
+    static const Config DEFAULTS;
+
+    TempFilter();
+
+    void configure(const Config& config);  // Clamps out-of-range values and resets
+    const Config& getConfig() const { return _config; }
+    void reset();                           // Next reading primes every stage
+
+    // Feeds one reading taken at nowMs. True when the filtered value moved
+    // past the deadband from the last published one; out is then the value
+    // to publish. The first reading after reset() always publishes.
+    bool apply(DeciF raw, uint32_t nowMs, DeciF& out);
+
+    // Readings that would have published unfiltered (moved past the deadband
+    // from the published value) but did not after filtering
+    uint32_t getSuppressedCount() const { return _suppressed; }
+
+private:
+    DeciF median(DeciF raw);
+
+    Config _config;
+    float _tauMs;                   // Stage settings in tenths and ms
+    float _slewPerMs;
+    DeciF _deadband;
+    DeciF _window[MAX_MEDIAN];
+    uint8_t _windowCount;
+    uint8_t _windowHead;
+    bool _primed;
+    float _ema;                     // Tenths, unrounded
+    float _out;                     // Filter output before the deadband, tenths, unrounded
+    DeciF _published;
+    uint32_t _lastMs;
+    uint32_t _suppressed;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef TEMPFIXED_H
+#define TEMPFIXED_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Temperatures are carried as int16 tenths of a °F from the sensor read
+// through TempSensor, the protection comparisons, TempHistory and the CSV
+// files; float °F exists only at the edges (JSON, log text, the MCP9600
+// driver). ±3276.7°F covers every sensor, and DEVICE_DISCONNECTED_F
+// (-196.6°F) is exact.
+typedef int16_t DeciF;
+
+static const DeciF DECIF_DISCONNECTED = -1966;     // DEVICE_DISCONNECTED_F
+static const DeciF DECIF_NONE = INT16_MIN;         // No threshold
+
+// Rounds to the nearest tenth; for constants, config values and drivers
+// that report float
+constexpr DeciF toDeciF(float f) {
+    return (DeciF)(f >= 0.0f ? f * 10.0f + 0.5f : f * 10.0f - 0.5f);
+}
+
+constexpr float fromDeciF(DeciF d) { return d / 10.0f; }
+
+// DS18B20 raw counts (1/128 °C) to tenths of a °F, rounded, without float:
+// F * 10 = raw * 9 / 64 + 320
+inline DeciF rawToDeciF(int32_t raw) {
+    int32_t n = raw * 9;
+    return (DeciF)(320 + (n >= 0 ? (n + 32) / 64 : -((-n + 32) / 64)));
+}
+
+// Writes d as "-12.3" (no float formatting); returns the length written,
+// like snprintf
+int formatDeciF(char* buf, size_t len, DeciF d);
+
+// Parses "[-]digits[.digit...]" at p, rounding to tenths, and advances p
+// past it. False when p holds no number or it does not fit a DeciF.
+bool parseDeciF(const char*& p, DeciF& out);
+
+#endif
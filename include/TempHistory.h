@@ -3,19 +3,23 @@
 
 #include <cstdint>
 #include <cstddef>
+#include "TempFixed.h"
 
 struct TempSample {
     uint32_t epoch;
-    float temp;
+    DeciF temp;
 };
 
+// Ring buffer per sensor in PSRAM. Epochs and temperatures are kept in
+// separate arrays so a sample costs 6 bytes rather than a padded 8;
+// getSamples() hands them back as TempSample.
 class TempHistory {
 public:
     static const int MAX_SENSORS = 5;
     static const int MAX_SAMPLES = 5040;  // 7 days * 24h * 60min / 2min
 
     void begin();
-    void addSample(int sensorIdx, uint32_t epoch, float temp);
+    void addSample(int sensorIdx, uint32_t epoch, DeciF temp);
     int getSamples(int sensorIdx, uint32_t sinceEpoch, TempSample* out, int maxOut);
     void backfillFromSD();
 
@@ -23,7 +27,8 @@ public:
     static const char* sensorKeys[MAX_SENSORS];
 
 private:
-    TempSample* _buffers[MAX_SENSORS] = {};
+    uint32_t* _epochs[MAX_SENSORS] = {};
+    DeciF* _temps[MAX_SENSORS] = {};
     int _head[MAX_SENSORS] = {};
     int _count[MAX_SENSORS] = {};
 };
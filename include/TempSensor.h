@@ -5,6 +5,7 @@
 #include <map>
 #include <DallasTemperature.h>
 #include <Adafruit_MCP9600.h>
+#include "TempFilter.h"
 
 class TempSensor;
 typedef void (*TempSensorCallback)(TempSensor* sensor);
@@ -16,31 +17,54 @@ class TempSensor {
     TempSensor(const String& description);
     ~TempSensor();
 
+    // Latest published reading, in tenths of a °F. One writer (the
+    // acquisition task, or setup and replay before it starts); any task
+    // reads it lock-free. Each field is naturally aligned, so the
+    // single-field getters are plain atomic loads; getReading() is a seqlock
+    // read for a consistent value/previous/valid.
+    struct Reading {
+      DeciF deciF;
+      DeciF previousDeciF;
+      bool valid;
+    };
+
     // Getters
     String getDescription() const { return _description; }
     uint8_t* getDeviceAddress() { return _deviceAddress; }
-    float getValue() const { return _value; }
-    float getPrevious() const { return _previous; }
-    bool isValid() const { return _valid; }
+    Reading getReading() const;
+    DeciF getDeciF() const { return __atomic_load_n(&_reading.deciF, __ATOMIC_RELAXED); }
+    DeciF getPreviousDeciF() const { return __atomic_load_n(&_reading.previousDeciF, __ATOMIC_RELAXED); }
+    float getTempF() const { return fromDeciF(getDeciF()); }   // For display only
+    bool isValid() const { return __atomic_load_n(&_reading.valid, __ATOMIC_RELAXED); }
+    Adafruit_MCP9600* getMCP9600() const { return _mcp9600; }
+    const TempFilter& getFilter() const { return _filter; }
 
     // Setters
     void setDescription(const String& description) { _description = description; }
     void setDeviceAddress(uint8_t* address);
-    void setValue(float value);
-    void setPrevious(float previous) { _previous = previous; }
-    void setValid(bool valid) { _valid = valid; }
+    void setDeciF(DeciF value);     // DECIF_DISCONNECTED publishes the sensor invalid
+    void setPreviousDeciF(DeciF previous);
+    void setValid(bool valid);
     void setMCP9600(Adafruit_MCP9600* mcp) { _mcp9600 = mcp; }
+    void setFilter(const TempFilter::Config& config) { _filter.configure(config); }  // Before acquisition starts
 
     // Callbacks
-    void setUpdateCallback(TempSensorCallback callback) { _onUpdate = callback; }
     void setChangeCallback(TempSensorCallback callback) { _onChange = callback; }
-    TempSensorCallback getUpdateCallback() const { return _onUpdate; }
     TempSensorCallback getChangeCallback() const { return _onChange; }
 
-    // Operations
-    void update(DallasTemperature* sensors, float threshold = 0.33f);
-    void updateValue(float tempF, float threshold = 0.33f);
-    void fireUpdateCallback();
+    // Result of one DS18B20 scratchpad read
+    enum class ReadStatus : uint8_t { OK, DISCONNECTED, CRC_ERROR };
+
+    // Operations, for SensorAcquisition, the only reader of the buses.
+    // readRaw() reads the DS18B20 scratchpad once and, when its CRC checks
+    // out, returns the temperature in 1/128 °C raw units without publishing.
+    // updateValue() publishes a reading taken at nowMs through the sensor's
+    // TempFilter, so a change inside its deadband is not published; true when
+    // the published reading changed. It does not fire the change callback:
+    // the bus is read off the loop task, so the caller fires it from the loop
+    // (see SensorAcquisition::serviceChanges()).
+    ReadStatus readRaw(DallasTemperature* sensors, int32_t& raw);
+    bool updateValue(DeciF value, uint32_t nowMs);
     void fireChangeCallback();
 
     // Static helper for device address string conversion
@@ -50,19 +74,19 @@ class TempSensor {
 
     // Static sensor discovery
     static void discoverSensors(DallasTemperature* sensors, TempSensorMap& tempMap,
-                                TempSensorCallback updateCallback = nullptr,
                                 TempSensorCallback changeCallback = nullptr);
     static String getDefaultDescription(uint8_t index);
 
   private:
+    void publish(const Reading& reading);
+
     String _description;
     uint8_t* _deviceAddress;
-    float _value;
-    float _previous;
-    bool _valid;
-    TempSensorCallback _onUpdate;
+    Reading _reading;
+    volatile uint32_t _seq;     // Odd while publish() is writing _reading
     TempSensorCallback _onChange;
     Adafruit_MCP9600* _mcp9600;
+    TempFilter _filter;
 };
 
 #endif
@@ -0,0 +1,116 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <Arduino.h>
+#include "TempFixed.h"
+
+// Binary event trace: a fixed ring of 16-byte records in PSRAM capturing every
+// controller stimulus (input edges, temperature samples, config, web commands,
+// update() passes) and every observable result (outputs, state, protections).
+// Downloaded from /trace and replayed through the host build with
+// `--replay FILE`, which re-runs update() at the recorded times and diffs the
+// results against the recording.
+
+enum class TraceEvent : uint8_t {
+    NONE = 0,       // Overwritten before export; skipped by replay
+    BEGIN,          // GoodmanHP::begin()
+    PIN_MAP,        // id = GPIO, value = TracePinKind, aux = InputId/OutputId slot
+    CONFIG,         // id = TraceConfig, value = uint32 or float bits
+    COMMAND,        // id = TraceCommand, value/aux = arguments
+    INPUT_EDGE,     // id = GPIO, value = raw level after the edge
+    TEMP_SAMPLE,    // id = SensorId, value = DeciF (sign-extended), aux = valid
+    UPDATE,         // value = update count
+    OUTPUT_LEVEL,   // id = GPIO, value = level written
+    STATE,          // value = new State, aux = old State
+    PROTECTION,     // id = ProtectionId, value = DeciF of the tripping reading (0 on clear), aux = 1 trip / 0 clear
+    INPUT_DEBOUNCED // id = GPIO, value = level accepted by InputDebouncer, aux = ms of the first disagreeing sample
+};
+
+enum class TracePinKind : uint8_t { IN, OUT };
+
+enum class TraceConfig : uint8_t {
+    LOW_TEMP_F, HIGH_SUCTION_TEMP_F, RV_SHORT_CYCLE_MS, CNT_SHORT_CYCLE_MS,
+    DEFROST_MIN_RUNTIME_MS, DEFROST_EXIT_F, HEAT_RUNTIME_THRESHOLD_MS, HEAT_RUNTIME_MS,
+    RV_FAIL, SOFTWARE_DEFROST
+};
+
+enum class TraceCommand : uint8_t {
+    MANUAL_OVERRIDE,    // value = on
+    MANUAL_OUTPUT,      // value = on, aux = OutputId slot
+    FORCE_DEFROST,
+    CLEAR_RV_FAIL
+};
+
+struct TraceRecord {
+    uint32_t ms;        // millis() at the event
+    uint16_t us;        // Sub-millisecond part, 0-999
+    uint8_t type;       // TraceEvent
+    uint8_t id;
+    uint32_t value;
+    uint32_t aux;
+};
+static_assert(sizeof(TraceRecord) == 16, "TraceRecord must stay 16 bytes");
+
+// Export stream: header followed by count records, oldest first
+struct TraceFileHeader {
+    char magic[4];          // "GHPT"
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t count;
+    uint32_t dropped;       // Records overwritten before the export started
+};
+static_assert(sizeof(TraceFileHeader) == 16, "TraceFileHeader must stay 16 bytes");
+
+class TraceRecorder {
+public:
+    static const uint16_t VERSION = 3;     // 3: temperatures as DeciF
+    static const uint32_t DEFAULT_CAPACITY = 131072; // Records (2 MB)
+
+    // Bounds of one export, fixed when the download starts
+    struct Export {
+        uint32_t startSeq;
+        uint32_t count;
+        uint32_t dropped;
+    };
+
+    TraceRecorder();
+
+    bool begin(uint32_t capacity = DEFAULT_CAPACITY);  // Rounded down to a power of two
+    bool isEnabled() const { return _ring != nullptr; }
+    void clear();
+
+    // Multi-core safe; a no-op until begin(). The ring is in PSRAM, so never
+    // from an ISR: GPIO edges are recorded when the input event ring is drained,
+    // stamped with the edge's own time through recordAt().
+    void record(TraceEvent type, uint8_t id, uint32_t value, uint32_t aux = 0);
+    void recordAt(uint64_t timeUs, TraceEvent type, uint8_t id, uint32_t value, uint32_t aux = 0);
+    void recordFloat(TraceEvent type, uint8_t id, float value, uint32_t aux = 0);
+    void recordDeciF(TraceEvent type, uint8_t id, DeciF value, uint32_t aux = 0);
+
+    uint32_t getCapacity() const { return _capacity; }
+    uint32_t getTotal() const { return _head; }
+    uint32_t getCount() const;
+
+    Export beginExport() const;
+    size_t exportSize(const Export& exp) const;
+    // Copies bytes [offset, offset + maxLen) of the export stream. Records
+    // overwritten since beginExport() come out as TraceEvent::NONE.
+    size_t readExport(const Export& exp, size_t offset, uint8_t* buf, size_t maxLen) const;
+
+    static float toFloat(uint32_t bits);
+    static uint32_t fromFloat(float value);
+    static DeciF toDeciF(uint32_t bits) { return (DeciF)(int32_t)bits; }
+
+private:
+    TraceRecord* _ring;
+    uint32_t _capacity;
+    uint32_t _mask;
+    volatile uint32_t _head;    // Sequence of the next record
+    mutable portMUX_TYPE _mux;
+
+    bool readRecord(uint32_t seq, TraceRecord& out) const;
+};
+
+extern TraceRecorder Trace;
+
+#endif
@@ -0,0 +1,20 @@
+// Host (native) stand-in for the Adafruit MCP9600 thermocouple driver.
+// readThermocouple() returns the simulated LIQUID_TEMP in °C. The two alert
+// comparators drive SimHardware's thermocouple alert pin, active low.
+#ifndef SIM_ADAFRUIT_MCP9600_H
+#define SIM_ADAFRUIT_MCP9600_H
+
+#include <Arduino.h>
+
+class Adafruit_MCP9600 {
+  public:
+    bool begin(uint8_t = 0x67) { return true; }
+    void enable(bool) {}
+    float readThermocouple();
+    void setAlertTemperature(uint8_t alert, float temp);
+    float getAlertTemperature(uint8_t alert);
+    void configureAlert(uint8_t alert, bool enabled, bool rising, bool alertColdJunction = false,
+                        bool activeHigh = false, bool interruptMode = false);
+};
+
+#endif
@@ -0,0 +1,195 @@
+// Host (native) stand-in for the Arduino core used by the simulation build.
+// Only the subset of the Arduino/ESP32 API touched by GoodmanHP, InputPin,
+// OutPin and TempSensor is provided. Time and GPIO are virtual and driven
+// by SimHardware (see SimHardware.h).
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <sys/types.h>
+
+using std::abs;
+
+// newlib provides strlcpy on the ESP32; older glibc does not
+inline size_t simStrlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#define strlcpy simStrlcpy
+
+// Single-threaded host: critical sections are no-ops
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL_SAFE(mux) ((void)(mux))
+#define portEXIT_CRITICAL_SAFE(mux) ((void)(mux))
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT             0x01
+#define OUTPUT            0x03
+#define PULLUP            0x04
+#define INPUT_PULLUP      0x05
+#define PULLDOWN          0x08
+#define INPUT_PULLDOWN    0x09
+#define OPEN_DRAIN        0x10
+#define OUTPUT_OPEN_DRAIN 0x13
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define DEC 10
+#define HEX 16
+
+typedef uint8_t byte;
+
+class String {
+  public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(int v, unsigned char base = 10) { fromLong(v, base); }
+    String(unsigned int v, unsigned char base = 10) { fromULong(v, base); }
+    String(long v, unsigned char base = 10) { fromLong(v, base); }
+    String(unsigned long v, unsigned char base = 10) { fromULong(v, base); }
+    String(float v, unsigned int decimals = 2) { fromDouble(v, decimals); }
+    String(double v, unsigned int decimals = 2) { fromDouble(v, decimals); }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return (unsigned int)_s.length(); }
+    char operator[](unsigned int i) const { return i < _s.length() ? _s[i] : 0; }
+    char charAt(unsigned int i) const { return (*this)[i]; }
+
+    String& operator+=(const String& rhs) { _s += rhs._s; return *this; }
+    String& operator+=(const char* rhs) { _s += rhs ? rhs : ""; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+
+    bool operator==(const String& rhs) const { return _s == rhs._s; }
+    bool operator==(const char* rhs) const { return _s == (rhs ? rhs : ""); }
+    bool operator!=(const String& rhs) const { return _s != rhs._s; }
+    bool operator!=(const char* rhs) const { return !(*this == rhs); }
+    bool operator<(const String& rhs) const { return _s < rhs._s; }
+    bool operator>(const String& rhs) const { return _s > rhs._s; }
+
+    bool startsWith(const String& p) const { return _s.compare(0, p._s.size(), p._s) == 0; }
+    bool endsWith(const String& p) const {
+        return _s.size() >= p._s.size() && _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+    }
+    int indexOf(char c) const { size_t p = _s.find(c); return p == std::string::npos ? -1 : (int)p; }
+    int indexOf(const String& s) const { size_t p = _s.find(s._s); return p == std::string::npos ? -1 : (int)p; }
+    int lastIndexOf(char c) const { size_t p = _s.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+    String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= _s.size()) return String();
+        return String(_s.substr(from, to - from));
+    }
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return (float)atof(_s.c_str()); }
+
+    friend String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+    friend String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+
+  private:
+    std::string _s;
+
+    void fromLong(long v, unsigned char base) {
+        if (base == 10) { _s = std::to_string(v); return; }
+        fromULong((unsigned long)v, base);
+    }
+    void fromULong(unsigned long v, unsigned char base) {
+        char buf[65];
+        int i = 64;
+        buf[i] = '\0';
+        if (v == 0) buf[--i] = '0';
+        while (v > 0 && i > 0) {
+            unsigned d = (unsigned)(v % base);
+            buf[--i] = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+            v /= base;
+        }
+        _s = &buf[i];
+    }
+    void fromDouble(double v, unsigned int decimals) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        _s = buf;
+    }
+};
+
+class HardwareSerial {
+  public:
+    void begin(unsigned long) {}
+    size_t print(const String& s) { return out(s.c_str()); }
+    size_t print(const char* s) { return out(s); }
+    size_t print(char c) { char b[2] = {c, 0}; return out(b); }
+    size_t print(int v, int base = DEC) { return out(String(v, (unsigned char)base).c_str()); }
+    size_t print(unsigned int v, int base = DEC) { return out(String(v, (unsigned char)base).c_str()); }
+    size_t print(long v, int base = DEC) { return out(String(v, (unsigned char)base).c_str()); }
+    size_t print(unsigned long v, int base = DEC) { return out(String(v, (unsigned char)base).c_str()); }
+    size_t print(double v, int digits = 2) { return out(String(v, (unsigned int)digits).c_str()); }
+    size_t println() { return out("\n"); }
+    template <typename T> size_t println(const T& v) { size_t n = print(v); return n + out("\n"); }
+    template <typename T> size_t println(const T& v, int fmt) { size_t n = print(v, fmt); return n + out("\n"); }
+    size_t printf(const char* fmt, ...) {
+        char buf[256];
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(buf, sizeof(buf), fmt, args);
+        va_end(args);
+        return out(buf);
+    }
+    // Serial output is discarded unless the simulation runs with --verbose
+    static bool enabled;
+  private:
+    size_t out(const char* s) {
+        if (enabled) fputs(s, stdout);
+        return strlen(s);
+    }
+};
+
+extern HardwareSerial Serial;
+
+// Virtual clock (SimHardware)
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+inline void delayMicroseconds(uint32_t) {}
+void yield();
+
+// Virtual GPIO (SimHardware)
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+uint16_t analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void analogWriteFrequency(uint32_t freq);
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolutionBits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);     // Drives the pin HIGH for any non-zero duty
+uint32_t ledcRead(uint8_t channel);
+// Handlers run synchronously when SimHardware::setLevel() changes an input
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+inline void* ps_malloc(size_t size) { return malloc(size); }
+
+#endif
@@ -0,0 +1,12 @@
+// Host (native) stand-in so Logger.h compiles; MQTT is not simulated.
+#ifndef SIM_ASYNCMQTTCLIENT_H
+#define SIM_ASYNCMQTTCLIENT_H
+
+#include <Arduino.h>
+
+class AsyncMqttClient {
+  public:
+    bool connected() const { return false; }
+};
+
+#endif
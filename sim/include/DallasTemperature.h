@@ -0,0 +1,57 @@
+// Host (native) stand-in for milesburton/DallasTemperature.
+// Each device address maps to a simulated temperature set by the plant model
+// through SimHardware; getTemp() returns raw 1/128 °C counts like the real
+// library, decoded from a scratchpad that SimHardware can corrupt on demand.
+#ifndef SIM_DALLASTEMPERATURE_H
+#define SIM_DALLASTEMPERATURE_H
+
+#include <Arduino.h>
+#include <OneWire.h>
+
+typedef uint8_t DeviceAddress[8];
+typedef uint8_t ScratchPad[9];
+
+#define DEVICE_DISCONNECTED_C   -127
+#define DEVICE_DISCONNECTED_F   -196.6
+#define DEVICE_DISCONNECTED_RAW -7040
+
+class DallasTemperature {
+  public:
+    DallasTemperature() {}
+    explicit DallasTemperature(OneWire*) {}
+
+    void begin() {}
+    uint8_t getDeviceCount();
+    bool getAddress(uint8_t* deviceAddress, uint8_t index);
+
+    void setWaitForConversion(bool wait) { _waitForConversion = wait; }
+    bool getWaitForConversion() const { return _waitForConversion; }
+    void requestTemperatures();
+    void requestTemperaturesByAddress(const uint8_t* deviceAddress);
+    // Conversion time runs on the virtual clock from the last request, scaled
+    // by the resolution of the devices converting
+    bool isConversionComplete();
+    uint8_t getResolution() const { return 12; }
+    uint8_t getResolution(const uint8_t* deviceAddress);
+    bool setResolution(const uint8_t* deviceAddress, uint8_t newResolution, bool skipGlobalBitResolutionCalculation = false);
+    uint16_t millisToWaitForConversion(uint8_t bitResolution);
+    // False when no device answers the reset with a presence pulse
+    bool readScratchPad(const uint8_t* deviceAddress, uint8_t* scratchPad);
+    int32_t getTemp(const uint8_t* deviceAddress);
+    float getTempC(const uint8_t* deviceAddress) { return rawToCelsius(getTemp(deviceAddress)); }
+    float getTempF(const uint8_t* deviceAddress) { return rawToFahrenheit(getTemp(deviceAddress)); }
+
+    static float rawToCelsius(int32_t raw) {
+        if (raw <= DEVICE_DISCONNECTED_RAW) return DEVICE_DISCONNECTED_C;
+        return (float)raw * 0.0078125f;
+    }
+    static float rawToFahrenheit(int32_t raw) {
+        if (raw <= DEVICE_DISCONNECTED_RAW) return DEVICE_DISCONNECTED_F;
+        return ((float)raw * 0.0140625f) + 32.0f;
+    }
+
+  private:
+    bool _waitForConversion = true;
+};
+
+#endif
@@ -0,0 +1,5 @@
+// Host (native) stand-in so Logger.h compiles; log rotation is not simulated.
+#ifndef SIM_ESP32_TARGZ_H
+#define SIM_ESP32_TARGZ_H
+
+#endif
@@ -0,0 +1,17 @@
+// Host (native) stand-in for PaulStoffregen/OneWire: only the CRC helper the
+// sources use; bus traffic is modelled by the DallasTemperature stand-in.
+#ifndef SIM_ONEWIRE_H
+#define SIM_ONEWIRE_H
+
+#include <Arduino.h>
+
+class OneWire {
+  public:
+    OneWire() {}
+    explicit OneWire(uint8_t) {}
+
+    // Dallas/Maxim CRC-8 (x^8 + x^5 + x^4 + 1), as used by ROM codes and scratchpads
+    static uint8_t crc8(const uint8_t* addr, uint8_t len);
+};
+
+#endif
@@ -0,0 +1,7 @@
+// Host (native) stand-in so Logger.h compiles; the SD card is not simulated.
+#ifndef SIM_SD_H
+#define SIM_SD_H
+
+#include <Arduino.h>
+
+#endif
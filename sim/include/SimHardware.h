@@ -0,0 +1,47 @@
+// Virtual hardware for the host simulation build: a settable millis() clock,
+// a GPIO level table, and per-device temperature sources for the DallasTemperature
+// and MCP9600 stand-ins.
+#ifndef SIM_SIMHARDWARE_H
+#define SIM_SIMHARDWARE_H
+
+#include <Arduino.h>
+
+namespace SimHardware {
+    static const uint8_t MAX_PINS = 64;
+    static const uint8_t MAX_DEVICES = 8;
+
+    // Virtual clock — only moves when the simulation advances it
+    void setMillis(uint32_t ms);
+    void advanceMillis(uint32_t ms);
+    uint64_t elapsedMillis();   // Monotonic, does not wrap with millis()
+
+    // GPIO: inputs are driven by the scenario, outputs by digitalWrite()
+    void setLevel(uint8_t pin, int level);
+    int getLevel(uint8_t pin);
+    uint32_t getWriteCount(uint8_t pin);
+
+    // OneWire bus: device i is addressed 28:i:00:00:00:00:00:00
+    void setDeviceCount(uint8_t count);
+    void makeAddress(uint8_t index, uint8_t* address);
+    void setDeviceTempF(uint8_t index, float tempF);
+    float getDeviceTempF(uint8_t index);
+    void setConversionMs(uint32_t ms);   // Bus time charged by a blocking requestTemperatures()
+    uint32_t getConversionCount();
+    uint32_t getReadCount(uint8_t index);        // getTemp() calls for device index
+    uint8_t getResolution(uint8_t index);
+    uint32_t getResolutionWriteCount();
+
+    // Bus faults, applied to device index's next scratchpad reads or conversion:
+    // CRC flips a data bit, DISCONNECT drops the presence pulse, POWER_ON_RESET
+    // leaves the 85 °C reset value until the next Convert T, SPIKE reports a
+    // reading 100°F off with a good CRC, STUCK_CONVERSION never reports done
+    enum class DeviceFault : uint8_t { NONE, CRC, DISCONNECT, POWER_ON_RESET, SPIKE, STUCK_CONVERSION, COUNT };
+    void injectDeviceFault(uint8_t index, DeviceFault fault, uint8_t reads = 1);
+
+    // MCP9600 thermocouple (LIQUID_TEMP); its alert outputs pull pin low
+    void setThermocoupleTempF(float tempF);
+    void setThermocoupleAlertPin(uint8_t pin);
+    uint32_t getThermocoupleReadCount();
+}
+
+#endif
@@ -0,0 +1,92 @@
+// Host (native) stand-in for arkhipenko/TaskScheduler.
+// Mirrors the cooperative scheduling semantics the firmware relies on
+// (interval, iterations, enable/restartDelayed/forceNextIteration) against
+// the virtual millis() clock, so simulated time can jump straight to the next
+// due task instead of spinning.
+#ifndef SIM_TASKSCHEDULERDECLARATIONS_H
+#define SIM_TASKSCHEDULERDECLARATIONS_H
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+#define TASK_IMMEDIATE    0
+#define TASK_FOREVER      (-1)
+#define TASK_ONCE         1
+#define TASK_MILLISECOND  1UL
+#define TASK_SECOND       1000UL
+#define TASK_MINUTE       60000UL
+#define TASK_HOUR         3600000UL
+
+typedef std::function<void()> TaskCallback;
+typedef std::function<bool()> TaskOnEnable;
+typedef std::function<void()> TaskOnDisable;
+
+class Scheduler;
+
+class Task {
+  public:
+    Task(unsigned long aInterval = 0, long aIterations = 0, TaskCallback aCallback = nullptr,
+         Scheduler* aScheduler = nullptr, bool aEnable = false,
+         TaskOnEnable aOnEnable = nullptr, TaskOnDisable aOnDisable = nullptr);
+    ~Task();
+
+    bool enable();
+    bool enableIfNot();
+    bool enableDelayed(unsigned long aDelay = 0);
+    bool restart();
+    bool restartDelayed(unsigned long aDelay = 0);
+    void delay(unsigned long aDelay = 0);
+    void forceNextIteration();
+    bool disable();
+    bool isEnabled() const { return _enabled; }
+
+    void setInterval(unsigned long aInterval) { _interval = aInterval; }
+    unsigned long getInterval() const { return _interval; }
+    void setIterations(long aIterations) { _setIterations = _iterations = aIterations; }
+    long getIterations() const { return _iterations; }
+    unsigned long getRunCounter() const { return _runCounter; }
+    void setCallback(TaskCallback aCallback) { _callback = aCallback; }
+
+  private:
+    friend class Scheduler;
+
+    unsigned long _interval;
+    long _iterations;
+    long _setIterations;
+    unsigned long _runCounter = 0;
+    bool _enabled = false;
+    uint32_t _nextRun = 0;
+    TaskCallback _callback;
+    TaskOnEnable _onEnable;
+    TaskOnDisable _onDisable;
+    Scheduler* _scheduler;
+};
+
+class Scheduler {
+  public:
+    Scheduler() {}
+    void addTask(Task& aTask);
+    void deleteTask(Task& aTask);
+    // Run every due task once; returns true when nothing was due (idle pass)
+    bool execute();
+    // Host-only: milliseconds until the earliest enabled task is due,
+    // or UINT32_MAX when no task is enabled.
+    uint32_t msUntilNextRun() const;
+    // Host-only: how late task runs started against their due time, which
+    // is how long whatever ran before them held the scheduler thread
+    uint64_t getRunCount() const { return _runs; }
+    uint64_t getLateRunCount() const { return _lateRuns; }    // Later than LATE_MS
+    uint32_t getMaxLatenessMs() const { return _lateMaxMs; }
+    double getAvgLatenessMs() const { return _runs > 0 ? (double)_lateSumMs / (double)_runs : 0.0; }
+    static const uint32_t LATE_MS = 10;
+
+  private:
+    std::vector<Task*> _tasks;
+    uint64_t _runs = 0;
+    uint64_t _lateRuns = 0;
+    uint64_t _lateSumMs = 0;
+    uint32_t _lateMaxMs = 0;
+};
+
+#endif
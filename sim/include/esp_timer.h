@@ -0,0 +1,9 @@
+// Host stand-in for the ESP-IDF high resolution timer, on the virtual clock
+#ifndef SIM_ESP_TIMER_H
+#define SIM_ESP_TIMER_H
+
+#include <cstdint>
+
+int64_t esp_timer_get_time();
+
+#endif
@@ -0,0 +1,12 @@
+// Host stand-in for ESP-IDF soc/soc.h: register reads and writes go to the simulated GPIO table
+#ifndef SIM_SOC_SOC_H
+#define SIM_SOC_SOC_H
+
+#include <cstdint>
+
+void simRegWrite(uint32_t reg, uint32_t value);
+#define REG_WRITE(reg, value) simRegWrite((reg), (value))
+uint32_t simRegRead(uint32_t reg);
+#define REG_READ(reg) simRegRead((reg))
+
+#endif
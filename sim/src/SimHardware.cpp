@@ -0,0 +1,375 @@
+#include "SimHardware.h"
+#include <DallasTemperature.h>
+#include <Adafruit_MCP9600.h>
+#include <esp_timer.h>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+
+HardwareSerial Serial;
+bool HardwareSerial::enabled = false;
+
+static uint64_t _elapsedMs = 0;
+static uint32_t _millis = 0;
+static uint32_t _micros = 0;
+
+static int _levels[SimHardware::MAX_PINS] = {};
+static uint64_t _levelBits = 0;         // Same levels, one bit per pin, for register reads
+static uint8_t _modes[SimHardware::MAX_PINS] = {};
+static uint32_t _writes[SimHardware::MAX_PINS] = {};
+
+struct SimInterrupt {
+    void (*isr)(void*);
+    void* arg;
+    int mode;
+};
+static SimInterrupt _interrupts[SimHardware::MAX_PINS] = {};
+
+static uint8_t _deviceCount = 0;
+static float _deviceTempF[SimHardware::MAX_DEVICES] = {};
+static uint32_t _conversionMs = 750;
+static uint32_t _conversions = 0;
+static uint64_t _conversionDoneMs = 0;
+static uint8_t _resolution[SimHardware::MAX_DEVICES] = { 12, 12, 12, 12, 12, 12, 12, 12 };
+static uint32_t _resolutionWrites = 0;
+static uint32_t _reads[SimHardware::MAX_DEVICES] = {};
+static SimHardware::DeviceFault _fault[SimHardware::MAX_DEVICES] = {};
+static uint8_t _faultReads[SimHardware::MAX_DEVICES] = {};
+static bool _powerOnReset[SimHardware::MAX_DEVICES] = {};
+static bool _stuckPending[SimHardware::MAX_DEVICES] = {};
+static int _stuckDevice = -1;            // Converting device that never reports done
+static float _thermocoupleF = 70.0f;
+static uint32_t _thermocoupleReads = 0;
+static int _alertPin = -1;
+
+struct SimAlert {
+    bool enabled;
+    bool rising;
+    float limitC;
+};
+static SimAlert _alerts[2] = {};
+
+uint32_t millis() { return _millis; }
+int64_t esp_timer_get_time() { return (int64_t)_elapsedMs * 1000; }
+uint32_t micros() { return _micros; }
+void delay(uint32_t ms) { SimHardware::advanceMillis(ms); }
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < SimHardware::MAX_PINS) _modes[pin] = mode;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < SimHardware::MAX_PINS ? _levels[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (pin >= SimHardware::MAX_PINS) return;
+    _levels[pin] = val ? HIGH : LOW;
+    if (val) _levelBits |= 1ULL << pin; else _levelBits &= ~(1ULL << pin);
+    _writes[pin]++;
+}
+
+// GPIO output set/clear registers: each set bit is one pin write
+void simRegWrite(uint32_t reg, uint32_t value) {
+    uint8_t base;
+    int level;
+    switch (reg) {
+        case GPIO_OUT_W1TS_REG: base = 0; level = HIGH; break;
+        case GPIO_OUT_W1TC_REG: base = 0; level = LOW; break;
+        case GPIO_OUT1_W1TS_REG: base = 32; level = HIGH; break;
+        case GPIO_OUT1_W1TC_REG: base = 32; level = LOW; break;
+        default: return;
+    }
+    for (uint8_t bit = 0; bit < 32; bit++) {
+        if (value & (1UL << bit)) digitalWrite(base + bit, level);
+    }
+}
+
+// GPIO output latch and input level registers: one bit per pin level (the
+// sim has one level per pin, so the latch and the pad always agree)
+uint32_t simRegRead(uint32_t reg) {
+    switch (reg) {
+        case GPIO_OUT_REG:
+        case GPIO_IN_REG: return (uint32_t)_levelBits;
+        case GPIO_OUT1_REG:
+        case GPIO_IN1_REG: return (uint32_t)(_levelBits >> 32);
+        default: return 0;
+    }
+}
+
+uint16_t analogRead(uint8_t pin) {
+    return digitalRead(pin) ? 4095 : 0;
+}
+
+void analogWrite(uint8_t pin, int value) {
+    digitalWrite(pin, value > 0 ? HIGH : LOW);
+}
+
+void analogWriteFrequency(uint32_t) {}
+
+static const uint8_t SIM_LEDC_CHANNELS = 8;
+static int16_t _ledcPin[SIM_LEDC_CHANNELS] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+static uint32_t _ledcDuty[SIM_LEDC_CHANNELS];
+
+uint32_t ledcSetup(uint8_t, uint32_t freq, uint8_t) { return freq; }
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+    if (channel < SIM_LEDC_CHANNELS) _ledcPin[channel] = pin;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    if (channel >= SIM_LEDC_CHANNELS) return;
+    _ledcDuty[channel] = duty;
+    if (_ledcPin[channel] >= 0) digitalWrite(_ledcPin[channel], duty > 0 ? HIGH : LOW);
+}
+
+uint32_t ledcRead(uint8_t channel) {
+    return channel < SIM_LEDC_CHANNELS ? _ledcDuty[channel] : 0;
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode) {
+    if (pin < SimHardware::MAX_PINS) _interrupts[pin] = {isr, arg, mode};
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin < SimHardware::MAX_PINS) _interrupts[pin] = {nullptr, nullptr, 0};
+}
+
+namespace SimHardware {
+
+void setMillis(uint32_t ms) {
+    advanceMillis(ms - _millis);
+}
+
+void advanceMillis(uint32_t ms) {
+    _elapsedMs += ms;
+    _millis += ms;
+    _micros += ms * 1000UL;
+}
+
+uint64_t elapsedMillis() { return _elapsedMs; }
+
+void setLevel(uint8_t pin, int level) {
+    if (pin >= MAX_PINS) return;
+    int old = _levels[pin];
+    _levels[pin] = level ? HIGH : LOW;
+    if (level) _levelBits |= 1ULL << pin; else _levelBits &= ~(1ULL << pin);
+    if (old == _levels[pin] || _interrupts[pin].isr == nullptr) return;
+    int edge = _levels[pin] == HIGH ? RISING : FALLING;
+    if (_interrupts[pin].mode & edge) _interrupts[pin].isr(_interrupts[pin].arg);
+}
+
+int getLevel(uint8_t pin) { return digitalRead(pin); }
+
+uint32_t getWriteCount(uint8_t pin) { return pin < MAX_PINS ? _writes[pin] : 0; }
+
+void setDeviceCount(uint8_t count) { _deviceCount = count < MAX_DEVICES ? count : MAX_DEVICES; }
+
+void makeAddress(uint8_t index, uint8_t* address) {
+    memset(address, 0, sizeof(DeviceAddress));
+    address[0] = 0x28;
+    address[1] = index;
+}
+
+void setDeviceTempF(uint8_t index, float tempF) {
+    if (index < MAX_DEVICES) _deviceTempF[index] = tempF;
+}
+
+float getDeviceTempF(uint8_t index) { return index < MAX_DEVICES ? _deviceTempF[index] : 0.0f; }
+
+void setConversionMs(uint32_t ms) { _conversionMs = ms; }
+uint32_t getConversionCount() { return _conversions; }
+uint32_t getReadCount(uint8_t index) { return index < MAX_DEVICES ? _reads[index] : 0; }
+uint8_t getResolution(uint8_t index) { return index < MAX_DEVICES ? _resolution[index] : 0; }
+uint32_t getResolutionWriteCount() { return _resolutionWrites; }
+
+void injectDeviceFault(uint8_t index, DeviceFault fault, uint8_t reads) {
+    if (index >= MAX_DEVICES) return;
+    switch (fault) {
+        case DeviceFault::POWER_ON_RESET: _powerOnReset[index] = true; break;
+        case DeviceFault::STUCK_CONVERSION: _stuckPending[index] = true; break;
+        default:
+            _fault[index] = fault;
+            _faultReads[index] = reads;
+            break;
+    }
+}
+
+// Comparator mode: an alert is asserted while the hot junction is past its limit
+static void updateAlertPin() {
+    if (_alertPin < 0) return;
+    float tempC = (_thermocoupleF - 32.0f) * 5.0f / 9.0f;
+    bool asserted = false;
+    for (const SimAlert& a : _alerts) {
+        if (a.enabled && (a.rising ? tempC >= a.limitC : tempC <= a.limitC)) asserted = true;
+    }
+    setLevel(_alertPin, asserted ? LOW : HIGH);
+}
+
+void setThermocoupleTempF(float tempF) {
+    _thermocoupleF = tempF;
+    updateAlertPin();
+}
+
+void setThermocoupleAlertPin(uint8_t pin) {
+    _alertPin = pin;
+    updateAlertPin();
+}
+
+uint32_t getThermocoupleReadCount() { return _thermocoupleReads; }
+
+}  // namespace SimHardware
+
+// --- DallasTemperature stand-in ---
+
+uint8_t DallasTemperature::getDeviceCount() { return _deviceCount; }
+
+bool DallasTemperature::getAddress(uint8_t* deviceAddress, uint8_t index) {
+    if (index >= _deviceCount) return false;
+    SimHardware::makeAddress(index, deviceAddress);
+    return true;
+}
+
+// Sensor conversion time halves with each bit of resolution dropped
+static uint32_t conversionMsFor(uint8_t resolution) {
+    return _conversionMs >> (12 - resolution);
+}
+
+static bool validDevice(const uint8_t* deviceAddress) {
+    return deviceAddress != nullptr && deviceAddress[0] == 0x28 && deviceAddress[1] < _deviceCount;
+}
+
+uint8_t OneWire::crc8(const uint8_t* addr, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        uint8_t inbyte = *addr++;
+        for (uint8_t i = 8; i; i--) {
+            uint8_t mix = (crc ^ inbyte) & 0x01;
+            crc >>= 1;
+            if (mix) crc ^= 0x8C;
+            inbyte >>= 1;
+        }
+    }
+    return crc;
+}
+
+// Convert T replaces the reset value and arms a pending stuck conversion
+static void startConversion(uint8_t index) {
+    _powerOnReset[index] = false;
+    if (_stuckPending[index]) {
+        _stuckPending[index] = false;
+        _stuckDevice = index;
+    }
+}
+
+void DallasTemperature::requestTemperatures() {
+    for (uint8_t i = 0; i < _deviceCount; i++) startConversion(i);
+    _conversions++;
+    _conversionDoneMs = _elapsedMs + _conversionMs;
+    // The real library busy-waits for the conversion when wait is enabled
+    if (_waitForConversion) SimHardware::advanceMillis(_conversionMs);
+}
+
+void DallasTemperature::requestTemperaturesByAddress(const uint8_t* deviceAddress) {
+    if (!validDevice(deviceAddress)) return;
+    startConversion(deviceAddress[1]);
+    _conversions++;
+    uint64_t done = _elapsedMs + conversionMsFor(_resolution[deviceAddress[1]]);
+    if (_conversionDoneMs < _elapsedMs || done > _conversionDoneMs) _conversionDoneMs = done;
+    if (_waitForConversion) SimHardware::advanceMillis(conversionMsFor(_resolution[deviceAddress[1]]));
+}
+
+bool DallasTemperature::isConversionComplete() {
+    return _stuckDevice < 0 && _elapsedMs >= _conversionDoneMs;
+}
+
+uint8_t DallasTemperature::getResolution(const uint8_t* deviceAddress) {
+    return validDevice(deviceAddress) ? _resolution[deviceAddress[1]] : 0;
+}
+
+bool DallasTemperature::setResolution(const uint8_t* deviceAddress, uint8_t newResolution, bool) {
+    if (!validDevice(deviceAddress) || newResolution < 9 || newResolution > 12) return false;
+    if (_resolution[deviceAddress[1]] != newResolution) {
+        _resolution[deviceAddress[1]] = newResolution;
+        _resolutionWrites++;
+    }
+    return true;
+}
+
+// DS18B20 datasheet maximum conversion times
+uint16_t DallasTemperature::millisToWaitForConversion(uint8_t bitResolution) {
+    switch (bitResolution) {
+        case 9: return 94;
+        case 10: return 188;
+        case 11: return 375;
+        default: return 750;
+    }
+}
+
+bool DallasTemperature::readScratchPad(const uint8_t* deviceAddress, uint8_t* scratchPad) {
+    memset(scratchPad, 0xFF, sizeof(ScratchPad));
+    if (!validDevice(deviceAddress)) return false;
+    uint8_t index = deviceAddress[1];
+    SimHardware::DeviceFault fault = SimHardware::DeviceFault::NONE;
+    if (_faultReads[index] > 0) {
+        fault = _fault[index];
+        _faultReads[index]--;
+    }
+    if (fault == SimHardware::DeviceFault::DISCONNECT) return false;
+    _reads[index]++;
+    // The stuck conversion ends once its result is read
+    if (_stuckDevice == index) _stuckDevice = -1;
+
+    float tempF = _deviceTempF[index];
+    if (fault == SimHardware::DeviceFault::SPIKE) tempF += 100.0f;
+    float tempC = (tempF - 32.0f) * 5.0f / 9.0f;
+    // DS18B20: 1/16 °C steps at 12 bits, doubling per bit dropped
+    uint8_t shift = _resolution[index] - 9;
+    int16_t counts = (int16_t)(lroundf(tempC * (float)(2 << shift)) * (8 >> shift));
+    if (_powerOnReset[index]) counts = 85 * 16;
+    scratchPad[0] = (uint8_t)(counts & 0xFF);
+    scratchPad[1] = (uint8_t)((uint16_t)counts >> 8);
+    scratchPad[2] = 0x4B;                                   // TH/TL alarm defaults
+    scratchPad[3] = 0x46;
+    scratchPad[4] = (uint8_t)(((_resolution[index] - 9) << 5) | 0x1F);
+    scratchPad[5] = 0xFF;
+    scratchPad[6] = 0x0C;
+    scratchPad[7] = 0x10;
+    scratchPad[8] = OneWire::crc8(scratchPad, 8);
+    if (fault == SimHardware::DeviceFault::CRC) scratchPad[0] ^= 0x10;
+    return true;
+}
+
+int32_t DallasTemperature::getTemp(const uint8_t* deviceAddress) {
+    ScratchPad scratchPad;
+    if (!readScratchPad(deviceAddress, scratchPad) || OneWire::crc8(scratchPad, 8) != scratchPad[8]) {
+        return DEVICE_DISCONNECTED_RAW;
+    }
+    // Reported in 1/128 °C units
+    return ((int32_t)(int8_t)scratchPad[1] << 11) | ((int32_t)scratchPad[0] << 3);
+}
+
+// --- Adafruit_MCP9600 stand-in ---
+
+float Adafruit_MCP9600::readThermocouple() {
+    _thermocoupleReads++;
+    return (_thermocoupleF - 32.0f) * 5.0f / 9.0f;
+}
+
+// Alert limits are 0.25 °C steps
+void Adafruit_MCP9600::setAlertTemperature(uint8_t alert, float temp) {
+    if (alert < 1 || alert > 2) return;
+    _alerts[alert - 1].limitC = roundf(temp * 4.0f) / 4.0f;
+    SimHardware::updateAlertPin();
+}
+
+float Adafruit_MCP9600::getAlertTemperature(uint8_t alert) {
+    return alert >= 1 && alert <= 2 ? _alerts[alert - 1].limitC : 0.0f;
+}
+
+void Adafruit_MCP9600::configureAlert(uint8_t alert, bool enabled, bool rising, bool, bool, bool) {
+    if (alert < 1 || alert > 2) return;
+    _alerts[alert - 1].enabled = enabled;
+    _alerts[alert - 1].rising = rising;
+    SimHardware::updateAlertPin();
+}
@@ -0,0 +1,75 @@
+// Host (native) Logger: same interface as src/Logger.cpp, but writes only to
+// stdout (when --verbose) and keeps per-level counters for the run summary.
+#include "Logger.h"
+
+Logger Log;
+
+static uint32_t _levelCounts[4] = {};
+
+uint32_t simLogCount(Logger::Level level) {
+    return _levelCounts[level];
+}
+
+Logger::Logger()
+    : _level(LOG_INFO)
+    , _serialEnabled(false)
+    , _mqttEnabled(false)
+    , _sdCardEnabled(false)
+    , _wsEnabled(false)
+    , _mqttClient(nullptr)
+    , _ws(nullptr)
+    , _sdReady(false)
+    , _maxFileSize(DEFAULT_MAX_FILE_SIZE)
+    , _maxRotatedFiles(DEFAULT_MAX_ROTATED_FILES)
+    , _compressionAvailable(false)
+    , _ringBufferMax(0)
+    , _ringBufferHead(0)
+    , _ringBufferCount(0)
+{
+}
+
+void Logger::setLevel(Level level) { _level = level; }
+Logger::Level Logger::getLevel() { return _level; }
+
+const char* Logger::getLevelName(Level level) {
+    switch (level) {
+        case LOG_ERROR: return "ERROR";
+        case LOG_WARN:  return "WARN ";
+        case LOG_INFO:  return "INFO ";
+        case LOG_DEBUG: return "DEBUG";
+        default:        return "?????";
+    }
+}
+
+void Logger::enableSerial(bool enable) { _serialEnabled = enable; }
+bool Logger::isSerialEnabled() { return _serialEnabled; }
+
+void Logger::error(const char* tag, const char* format, ...) {
+    va_list args; va_start(args, format); log(LOG_ERROR, tag, format, args); va_end(args);
+}
+void Logger::warn(const char* tag, const char* format, ...) {
+    va_list args; va_start(args, format); log(LOG_WARN, tag, format, args); va_end(args);
+}
+void Logger::info(const char* tag, const char* format, ...) {
+    va_list args; va_start(args, format); log(LOG_INFO, tag, format, args); va_end(args);
+}
+void Logger::debug(const char* tag, const char* format, ...) {
+    va_list args; va_start(args, format); log(LOG_DEBUG, tag, format, args); va_end(args);
+}
+
+void Logger::log(Level level, const char* tag, const char* format, va_list args) {
+    if (level > _level) return;
+    _levelCounts[level]++;
+    if (!_serialEnabled) return;
+
+    char msg[384];
+    vsnprintf(msg, sizeof(msg), format, args);
+    snprintf(_buffer, sizeof(_buffer), "[%s] %10lums [%s] %s", getLevelName(level),
+             (unsigned long)millis(), tag, msg);
+    writeToSerial(_buffer);
+}
+
+void Logger::writeToSerial(const char* msg) {
+    fputs(msg, stdout);
+    fputc('\n', stdout);
+}
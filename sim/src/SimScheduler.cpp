@@ -0,0 +1,126 @@
+#include <TaskSchedulerDeclarations.h>
+
+Task::Task(unsigned long aInterval, long aIterations, TaskCallback aCallback,
+           Scheduler* aScheduler, bool aEnable, TaskOnEnable aOnEnable, TaskOnDisable aOnDisable)
+    : _interval(aInterval)
+    , _iterations(aIterations)
+    , _setIterations(aIterations)
+    , _callback(aCallback)
+    , _onEnable(aOnEnable)
+    , _onDisable(aOnDisable)
+    , _scheduler(aScheduler)
+{
+    if (_scheduler != nullptr) _scheduler->addTask(*this);
+    if (aEnable) enable();
+}
+
+Task::~Task() {
+    if (_scheduler != nullptr) _scheduler->deleteTask(*this);
+}
+
+bool Task::enable() {
+    _runCounter = 0;
+    _iterations = _setIterations;
+    if (_onEnable && !_enabled) {
+        _enabled = true;
+        if (!_onEnable()) {
+            _enabled = false;
+            return false;
+        }
+    }
+    _enabled = true;
+    _nextRun = millis();
+    return true;
+}
+
+bool Task::enableIfNot() {
+    if (_enabled) return false;
+    return enable();
+}
+
+bool Task::enableDelayed(unsigned long aDelay) {
+    if (!enable()) return false;
+    delay(aDelay);
+    return true;
+}
+
+bool Task::restart() {
+    _enabled = false;
+    return enable();
+}
+
+bool Task::restartDelayed(unsigned long aDelay) {
+    if (!restart()) return false;
+    delay(aDelay);
+    return true;
+}
+
+void Task::delay(unsigned long aDelay) {
+    _nextRun = millis() + (uint32_t)(aDelay == 0 ? _interval : aDelay);
+}
+
+void Task::forceNextIteration() {
+    _nextRun = millis();
+}
+
+bool Task::disable() {
+    bool was = _enabled;
+    _enabled = false;
+    if (was && _onDisable) _onDisable();
+    return was;
+}
+
+void Scheduler::addTask(Task& aTask) {
+    _tasks.push_back(&aTask);
+}
+
+void Scheduler::deleteTask(Task& aTask) {
+    for (size_t i = 0; i < _tasks.size(); i++) {
+        if (_tasks[i] == &aTask) {
+            _tasks.erase(_tasks.begin() + i);
+            return;
+        }
+    }
+}
+
+bool Scheduler::execute() {
+    bool idle = true;
+    for (size_t i = 0; i < _tasks.size(); i++) {
+        Task* t = _tasks[i];
+        if (!t->_enabled) continue;
+        if ((int32_t)(millis() - t->_nextRun) < 0) continue;
+
+        if (t->_iterations == 0) {
+            t->disable();
+            continue;
+        }
+        uint32_t late = millis() - t->_nextRun;
+        _runs++;
+        _lateSumMs += late;
+        if (late > _lateMaxMs) _lateMaxMs = late;
+        if (late > LATE_MS) _lateRuns++;
+        // Schedule relative to the planned start, like TaskScheduler's default mode
+        t->_nextRun += (uint32_t)t->_interval;
+        if ((int32_t)(millis() - t->_nextRun) > 0 && t->_interval > 0) {
+            t->_nextRun = millis() + (uint32_t)t->_interval;
+        }
+        if (t->_iterations > 0) t->_iterations--;
+        t->_runCounter++;
+        idle = false;
+        if (t->_callback) t->_callback();
+        if (t->_iterations == 0 && t->_enabled) t->disable();
+    }
+    return idle;
+}
+
+uint32_t Scheduler::msUntilNextRun() const {
+    uint32_t best = UINT32_MAX;
+    uint32_t now = millis();
+    for (const Task* t : _tasks) {
+        if (!t->_enabled) continue;
+        int32_t d = (int32_t)(t->_nextRun - now);
+        uint32_t wait = d > 0 ? (uint32_t)d : 0;
+        if (wait < best) best = wait;
+    }
+    return best;
+}
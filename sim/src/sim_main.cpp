@@ -0,0 +1,979 @@
+// Host simulation of the GoodmanHP controller against a virtual clock.
+//
+// Runs the real GoodmanHP/InputPin/OutPin/TempSensor sources with simulated
+// GPIO and sensor sources so months of thermostat calls complete in seconds.
+// A simple thermal plant closes the loop: the house cools toward ambient and is
+// heated/cooled by CNT (and W), the outdoor coil frosts while heating and thaws
+// in defrost, and DFT follows the coil temperature.
+//
+//   pio run -e native
+//   .pio/build/native/program --scenario heat --days 90
+//   .pio/build/native/program --scenario bug1
+//   .pio/build/native/program --bench 200000
+//   .pio/build/native/program --days 3 --trace-out run.ghpt
+//   .pio/build/native/program --replay trace.ghpt     (downloaded from the device at /trace)
+#include <Arduino.h>
+#include <TaskSchedulerDeclarations.h>
+#include <DallasTemperature.h>
+#include <chrono>
+#include <random>
+#include "SimHardware.h"
+#include "GoodmanHP.h"
+#include "BoardConfig.h"
+#include "Logger.h"
+#include "TraceRecorder.h"
+#include <vector>
+
+uint32_t simLogCount(Logger::Level level);
+
+// The sim builds the ESP32-S3 board (see SelectedBoardPins in BoardConfig.h)
+static constexpr const BoardDef& SIM_BOARD = SelectedBoardPins::def();
+static const uint8_t LPS_PIN = SIM_BOARD.inputs[(uint8_t)GoodmanHP::InputId::LPS].gpio;
+static const uint8_t DFT_PIN = SIM_BOARD.inputs[(uint8_t)GoodmanHP::InputId::DFT].gpio;
+static const uint8_t Y_PIN = SIM_BOARD.inputs[(uint8_t)GoodmanHP::InputId::Y].gpio;
+static const uint8_t O_PIN = SIM_BOARD.inputs[(uint8_t)GoodmanHP::InputId::O].gpio;
+static const uint8_t CNT_PIN = SIM_BOARD.outputs[(uint8_t)GoodmanHP::OutputId::CNT].gpio;
+static const uint8_t W_PIN = SIM_BOARD.outputs[(uint8_t)GoodmanHP::OutputId::W].gpio;
+static const uint8_t RV_PIN = SIM_BOARD.outputs[(uint8_t)GoodmanHP::OutputId::RV].gpio;
+
+// OneWire device index order matches TempSensor::getDefaultDescription()
+enum SimDevice { DEV_COMPRESSOR = 0, DEV_SUCTION, DEV_AMBIENT, DEV_CONDENSER, DEV_COUNT };
+
+static const uint32_t PLANT_STEP_MS = 1000;
+static const uint32_t DAY_MS = 24UL * 60 * 60 * 1000;
+
+enum class Scenario { HEAT, COOL, BUG1 };
+
+struct SimOptions {
+    Scenario scenario = Scenario::HEAT;
+    double days = 30.0;
+    uint32_t seed = 1;
+    uint32_t benchTicks = 0;
+    float heatRuntimeThresholdMin = 90.0f;
+    float lpsTripPerDay = 0.0f;
+    float sensorFaultsPerDay = 0.0f;
+    float sensorNoiseF = 0.0f;      // --sensor-noise: std deviation added to each published plant temperature
+    TempFilter::Config sensorFilter = TempFilter::DEFAULTS;  // --sensor-filter, applied to every sensor
+    bool verbose = false;
+    String traceOut;                // --trace-out: write the run's trace here
+    String replay;                  // --replay: replay this trace instead of simulating
+};
+
+struct SimStats {
+    uint64_t schedulerPasses = 0;
+    uint32_t cntStarts = 0;
+    uint32_t defrostsStarted = 0;
+    uint32_t stateChanges = 0;
+    uint32_t lpsTrips = 0;
+    uint64_t stateMs[6] = {};
+    // Safety invariant violations
+    uint32_t cntWithoutY = 0;       // CNT on with Y inactive for more than 1 s (bugs/1.md)
+    uint32_t shortCycles = 0;       // CNT restarted sooner than the CNT short cycle delay
+    uint32_t cntDuringLps = 0;      // CNT on while an LPS fault is latched
+    uint32_t snapshotStale = 0;     // Published snapshot disagrees with the controller after update()
+    uint32_t spuriousTemps = 0;     // A valid published temperature far from the plant's
+    float peakSuctionF = -1000.0f;
+    // LPS edge -> CNT off latency (only trips that found CNT running)
+    uint32_t lpsLatencyCount = 0;
+    uint64_t lpsLatencySumMs = 0;
+    uint32_t lpsLatencyMaxMs = 0;
+};
+
+// --- Thermal plant ---
+
+class Plant {
+  public:
+    Plant(const SimOptions& opt) : _opt(opt), _rng(opt.seed), _noiseRng(opt.seed + 2) {
+        _indoorF = (opt.scenario == Scenario::COOL) ? 76.0f : 66.0f;
+        _ambientF = ambientAt(0);
+        _coilF = _ambientF;
+        _suctionF = _ambientF;
+        _compressorF = _ambientF;
+        _liquidF = _ambientF;
+        scheduleLpsTrip(0);
+    }
+
+    float ambientAt(uint64_t ms) const {
+        double phase = 2.0 * M_PI * (double)(ms % DAY_MS) / (double)DAY_MS;
+        double seasonal = 4.0 * sin(2.0 * M_PI * (double)ms / (double)(30ULL * DAY_MS));
+        if (_opt.scenario == Scenario::COOL) return (float)(84.0 + 10.0 * sin(phase) + seasonal);
+        return (float)(30.0 + 12.0 * sin(phase) + seasonal);
+    }
+
+    // Advance the plant by dtMs using the current output levels
+    void step(uint64_t nowMs, uint32_t dtMs) {
+        float dtMin = dtMs / 60000.0f;
+        bool cnt = SimHardware::getLevel(CNT_PIN);
+        bool rv = SimHardware::getLevel(RV_PIN);
+        bool w = SimHardware::getLevel(W_PIN);
+        bool y = SimHardware::getLevel(Y_PIN);
+
+        _ambientF = ambientAt(nowMs);
+
+        // House: loses heat to ambient, gains from CNT (heat) / W, loses to CNT (cool)
+        float rate = -(_indoorF - _ambientF) / (8.0f * 60.0f);
+        if (cnt && !rv && y) rate += 10.0f / 60.0f;
+        if (cnt && rv && y) rate -= (_opt.scenario == Scenario::COOL) ? 12.0f / 60.0f : 4.0f / 60.0f;
+        if (w) rate += 8.0f / 60.0f;
+        _indoorF += rate * dtMin;
+
+        // Outdoor coil: runs below ambient while heating, warms in defrost (RV+CNT)
+        float coilTarget = _ambientF;
+        if (cnt && !rv) coilTarget = _ambientF - 12.0f;
+        if (cnt && rv) coilTarget = (_opt.scenario == Scenario::COOL) ? _ambientF + 25.0f : 80.0f;
+        approach(_coilF, coilTarget, cnt && rv ? 4.0f : 3.0f, dtMin);
+
+        // Suction line: climbs fast when the compressor runs without indoor airflow
+        float suctionTarget = _ambientF;
+        if (cnt && !y) suctionTarget = 150.0f;
+        else if (cnt && rv) suctionTarget = (_opt.scenario == Scenario::COOL) ? 42.0f : 50.0f;
+        else if (cnt) suctionTarget = _ambientF - 20.0f;
+        approach(_suctionF, suctionTarget, cnt && !y ? 6.0f : 3.0f, dtMin);
+
+        approach(_compressorF, cnt ? 170.0f : _ambientF, cnt ? 10.0f : 20.0f, dtMin);
+
+        // Liquid line: leaves the indoor coil warm when heating, the outdoor coil when cooling
+        float liquidTarget = _ambientF;
+        if (cnt && !rv) liquidTarget = _indoorF + 25.0f;
+        else if (cnt && rv) liquidTarget = _ambientF + 15.0f;
+        approach(_liquidF, liquidTarget, cnt ? 2.0f : 15.0f, dtMin);
+
+        // DFT closes at 32°F coil temperature (1°F hysteresis)
+        if (_coilF < 32.0f) _dft = true;
+        else if (_coilF > 33.0f) _dft = false;
+
+        publish();
+    }
+
+    // Discrete events land on arbitrary milliseconds, not the plant step grid,
+    // so input-to-output latency is measured against unaligned edges
+    uint64_t nextEventMs() const { return _nextLpsEventMs; }
+
+    void applyEvents(uint64_t nowMs) {
+        if (nowMs < _nextLpsEventMs) return;
+        if (_lpsLowUntil == 0) {
+            _lpsLowUntil = nowMs + 2UL * 60 * 1000;   // 2 min low-pressure event
+            _nextLpsEventMs = _lpsLowUntil;
+        } else {
+            _lpsLowUntil = 0;
+            scheduleLpsTrip(nowMs);
+        }
+        SimHardware::setLevel(LPS_PIN, _lpsLowUntil == 0);
+    }
+
+    // Simple two-stage thermostat with 0.5°F hysteresis around the setpoint
+    void thermostat() {
+        if (_opt.scenario == Scenario::COOL) {
+            if (_indoorF > 75.5f) _callY = true;
+            else if (_indoorF < 74.5f) _callY = false;
+            _callO = true;
+        } else {
+            if (_indoorF < 67.5f) _callY = true;
+            else if (_indoorF > 68.5f) _callY = false;
+            _callO = false;
+        }
+    }
+
+    void setCall(bool y, bool o) { _callY = y; _callO = o; }
+    void publish() {
+        SimHardware::setLevel(Y_PIN, _callY);
+        SimHardware::setLevel(O_PIN, _callY && _callO);
+        SimHardware::setLevel(DFT_PIN, _dft);
+        SimHardware::setLevel(LPS_PIN, _lpsLowUntil == 0);
+        SimHardware::setDeviceTempF(DEV_COMPRESSOR, _compressorF + noise());
+        SimHardware::setDeviceTempF(DEV_SUCTION, _suctionF + noise());
+        SimHardware::setDeviceTempF(DEV_AMBIENT, _ambientF + noise());
+        SimHardware::setDeviceTempF(DEV_CONDENSER, _coilF + noise());
+        SimHardware::setThermocoupleTempF(_liquidF + noise());
+    }
+
+    bool lpsLow() const { return _lpsLowUntil != 0; }
+    float suctionF() const { return _suctionF; }
+    void setCoilF(float f) { _coilF = f; }
+
+  private:
+    void scheduleLpsTrip(uint64_t nowMs) {
+        if (_opt.lpsTripPerDay <= 0.0f) {
+            _nextLpsEventMs = UINT64_MAX;
+            return;
+        }
+        std::exponential_distribution<double> gap(_opt.lpsTripPerDay / (double)DAY_MS);
+        _nextLpsEventMs = nowMs + 1 + (uint64_t)gap(_rng);
+    }
+
+    // Own generator, so noise does not move the LPS trip times
+    float noise() {
+        if (_opt.sensorNoiseF <= 0.0f) return 0.0f;
+        std::normal_distribution<float> dist(0.0f, _opt.sensorNoiseF);
+        return dist(_noiseRng);
+    }
+
+    static void approach(float& value, float target, float tauMin, float dtMin) {
+        float k = dtMin / tauMin;
+        if (k > 1.0f) k = 1.0f;
+        value += (target - value) * k;
+    }
+
+    const SimOptions& _opt;
+    std::mt19937 _rng;
+    std::mt19937 _noiseRng;
+    float _indoorF;
+    float _ambientF;
+    float _coilF;
+    float _suctionF;
+    float _compressorF;
+    float _liquidF;
+    bool _dft = false;
+    bool _callY = false;
+    bool _callO = false;
+    uint64_t _lpsLowUntil = 0;
+    uint64_t _nextLpsEventMs = UINT64_MAX;
+};
+
+// --- Sensor faults ---
+
+// A valid reading this far from the plant got through the acquisition checks
+static const float SPURIOUS_TEMP_F = 20.0f;
+
+// Injects DS18B20 bus faults at random times, on random devices
+class SensorFaults {
+  public:
+    SensorFaults(const SimOptions& opt) : _opt(opt), _rng(opt.seed + 1) { schedule(0); }
+
+    uint64_t nextEventMs() const { return _nextMs; }
+
+    void apply(uint64_t nowMs) {
+        if (nowMs < _nextMs) return;
+        using Fault = SimHardware::DeviceFault;
+        uint8_t device = _rng() % DEV_COUNT;
+        Fault fault = (Fault)(1 + _rng() % ((uint8_t)Fault::COUNT - 1));
+        // Long enough outages to exhaust the retries and invalidate the sensor
+        uint8_t reads = fault == Fault::SPIKE ? 1 : 1 + _rng() % 12;
+        SimHardware::injectDeviceFault(device, fault, reads);
+        _injected[(uint8_t)fault]++;
+        schedule(nowMs);
+    }
+
+    uint32_t getInjected(SimHardware::DeviceFault fault) const { return _injected[(uint8_t)fault]; }
+
+  private:
+    void schedule(uint64_t nowMs) {
+        if (_opt.sensorFaultsPerDay <= 0.0f) {
+            _nextMs = UINT64_MAX;
+            return;
+        }
+        std::exponential_distribution<double> gap(_opt.sensorFaultsPerDay / (double)DAY_MS);
+        _nextMs = nowMs + 1 + (uint64_t)gap(_rng);
+    }
+
+    const SimOptions& _opt;
+    std::mt19937 _rng;
+    uint64_t _nextMs = UINT64_MAX;
+    uint32_t _injected[(uint8_t)SimHardware::DeviceFault::COUNT] = {};
+};
+
+// --- Controller wiring (mirrors setup() in main.cpp) ---
+
+static bool simOutPin(OutPin*, bool, bool, float&, float) { return true; }
+
+// Stands in for inputISRChange in main.cpp: an input edge is traced, counted and wakes the debouncer
+static InputDebouncer* _simDebouncer = nullptr;
+
+static void simInputISR(void* arg) {
+    InputPin* pin = static_cast<InputPin*>(arg);
+    uint8_t level = digitalRead(pin->getPin());
+    Trace.record(TraceEvent::INPUT_EDGE, pin->getPin(), level);
+    pin->recordEdge(level, millis(), micros());   // The ring drain in loop(), inline
+    _simDebouncer->requestSampleFromISR();
+}
+
+// Stands in for tempSensorChangeCallback in main.cpp, which publishes to MQTT
+static uint32_t _simTempChanges = 0;
+
+static void simTempChanged(TempSensor*) { _simTempChanges++; }
+
+static void buildController(GoodmanHP& hp, SelectedBoardPins& pins, Scheduler* ts, DallasTemperature* sensors,
+                            const TempFilter::Config& filter = TempFilter::DEFAULTS) {
+    pins.begin(ts, hp, nullptr, simOutPin);
+    _simDebouncer = &pins.debouncer();
+    for (auto& pair : hp.getInputMap()) {
+        attachInterruptArg(pair.second->getPin(), simInputISR, pair.second, CHANGE);
+    }
+
+    SimHardware::setDeviceCount(DEV_COUNT);
+    for (uint8_t i = 0; i < DEV_COUNT; i++) {
+        TempSensor* sensor = new TempSensor(TempSensor::getDefaultDescription(i));
+        DeviceAddress addr;
+        SimHardware::makeAddress(i, addr);
+        sensor->setDeviceAddress(addr);
+        hp.addTempSensor(sensor->getDescription(), sensor);
+    }
+    hp.setDallasTemperature(sensors);
+
+    // Liquid line thermocouple; replay leaves it without a converter so its
+    // readings also come only from TEMP_SAMPLE
+    TempSensor* liquid = new TempSensor("LIQUID_TEMP");
+    if (sensors != nullptr) {
+        static Adafruit_MCP9600 mcp;
+        liquid->setMCP9600(&mcp);
+    }
+    hp.addTempSensor(liquid->getDescription(), liquid);
+    for (auto& pair : hp.getTempSensorMap()) {
+        pair.second->setChangeCallback(simTempChanged);
+        pair.second->setFilter(filter);
+    }
+    if (sensors != nullptr) {
+        SimHardware::setThermocoupleAlertPin(SIM_BOARD.mcpAlert);
+        hp.setTempSensorAlertPin(liquid, SIM_BOARD.mcpAlert);
+    }
+}
+
+static const char* scenarioName(Scenario s) {
+    switch (s) {
+        case Scenario::COOL: return "cool";
+        case Scenario::BUG1: return "bug1";
+        default: return "heat";
+    }
+}
+
+static void printUsage() {
+    printf("usage: program [--scenario heat|cool|bug1] [--days N] [--seed N]\n"
+           "               [--defrost-threshold-min N] [--lps-trips-per-day N]\n"
+           "               [--sensor-faults-per-day N] [--sensor-noise F]\n"
+           "               [--sensor-filter MEDIAN,TAU,SLEW,DEADBAND]\n"
+           "               [--bench TICKS] [--trace-out FILE] [--verbose]\n"
+           "       program --replay FILE [--verbose]\n");
+}
+
+static bool parseArgs(int argc, char** argv, SimOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--scenario" && hasValue) {
+            String s = argv[++i];
+            if (s == "heat") opt.scenario = Scenario::HEAT;
+            else if (s == "cool") opt.scenario = Scenario::COOL;
+            else if (s == "bug1") opt.scenario = Scenario::BUG1;
+            else return false;
+        } else if (arg == "--days" && hasValue) {
+            opt.days = atof(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            opt.seed = (uint32_t)atol(argv[++i]);
+        } else if (arg == "--defrost-threshold-min" && hasValue) {
+            opt.heatRuntimeThresholdMin = (float)atof(argv[++i]);
+        } else if (arg == "--lps-trips-per-day" && hasValue) {
+            opt.lpsTripPerDay = (float)atof(argv[++i]);
+        } else if (arg == "--sensor-faults-per-day" && hasValue) {
+            opt.sensorFaultsPerDay = (float)atof(argv[++i]);
+        } else if (arg == "--sensor-noise" && hasValue) {
+            opt.sensorNoiseF = (float)atof(argv[++i]);
+        } else if (arg == "--sensor-filter" && hasValue) {
+            unsigned median = 1;
+            TempFilter::Config& fc = opt.sensorFilter;
+            if (sscanf(argv[++i], "%u,%f,%f,%f", &median, &fc.emaTauSec, &fc.slewFPerSec, &fc.deadbandF) != 4) {
+                return false;
+            }
+            fc.median = (uint8_t)(median < TempFilter::MAX_MEDIAN ? median : TempFilter::MAX_MEDIAN);
+        } else if (arg == "--bench" && hasValue) {
+            opt.benchTicks = (uint32_t)atol(argv[++i]);
+        } else if (arg == "--trace-out" && hasValue) {
+            opt.traceOut = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            opt.replay = argv[++i];
+        } else if (arg == "--verbose") {
+            opt.verbose = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- Run loop ---
+
+static int runSimulation(const SimOptions& opt) {
+    Scheduler ts;
+    DallasTemperature sensors;
+    GoodmanHP hp(&ts);
+    SelectedBoardPins pins;
+    SimStats stats;
+    Plant plant(opt);
+    SensorFaults faults(opt);
+
+    buildController(hp, pins, &ts, &sensors, opt.sensorFilter);
+    TempSensor* devices[DEV_COUNT];
+    bool deviceSpurious[DEV_COUNT] = {};
+    for (uint8_t i = 0; i < DEV_COUNT; i++) {
+        devices[i] = hp.getTempSensorMap().at(TempSensor::getDefaultDescription(i));
+    }
+    hp.setHeatRuntimeThresholdMs((uint32_t)(opt.heatRuntimeThresholdMin * 60000.0f));
+    hp.setStateChangeCallback([&stats](GoodmanHP::State newState, GoodmanHP::State oldState) {
+        if (newState != oldState) stats.stateChanges++;
+        if (newState == GoodmanHP::State::DEFROST && oldState != GoodmanHP::State::DEFROST) stats.defrostsStarted++;
+    });
+    hp.setLPSFaultCallback([&stats](bool active) { if (active) stats.lpsTrips++; });
+    plant.publish();
+    pins.debouncer().seed();   // Boot levels are settled before the controller starts, as on the device
+    hp.begin();
+
+    const uint64_t endMs = (uint64_t)(opt.days * (double)DAY_MS);
+    const uint64_t startMs = SimHardware::elapsedMillis();
+    uint64_t nextPlantMs = startMs;
+    uint64_t lastMs = startMs;
+    uint64_t cntOffAt = 0;
+    uint64_t cntNoYSince = 0;
+    bool cntWasOn = false;
+    bool bug1YDropped = false;
+    uint64_t bug1DropAt = 0;
+    uint64_t lpsTripAt = 0;
+    bool lpsTripPending = false;
+    bool cntLpsWas = false;
+
+    if (opt.scenario == Scenario::BUG1) {
+        // Hold a heat call through the startup lockout so runtime builds toward defrost
+        plant.setCall(true, false);
+        plant.setCoilF(20.0f);
+    }
+
+    auto wallStart = std::chrono::steady_clock::now();
+
+    while (SimHardware::elapsedMillis() - startMs < endMs) {
+        uint64_t now = SimHardware::elapsedMillis();
+
+        if (now >= nextPlantMs) {
+            if (opt.scenario == Scenario::BUG1) {
+                // bugs/1.md: thermostat satisfies during defrost Phase 2, before CNT restarts
+                if (!bug1YDropped && hp.isDefrostCntPendingActive()) {
+                    plant.setCall(false, false);
+                    bug1YDropped = true;
+                    bug1DropAt = now;
+                } else if (bug1YDropped && now - bug1DropAt > 30UL * 60 * 1000) {
+                    plant.thermostat();
+                }
+            } else {
+                plant.thermostat();
+            }
+            plant.step(now, (uint32_t)(now - lastMs));
+            lastMs = now;
+            nextPlantMs = now + PLANT_STEP_MS;
+        }
+
+        if (now >= plant.nextEventMs()) {
+            bool cntRunning = SimHardware::getLevel(CNT_PIN);
+            plant.applyEvents(now);
+            if (cntRunning && !SimHardware::getLevel(LPS_PIN)) {
+                lpsTripAt = now;
+                lpsTripPending = true;
+            }
+        }
+
+        faults.apply(now);
+
+        uint32_t updatesBefore = hp.getUpdateCount();
+        pins.debouncer().serviceSampleRequests();
+        hp.serviceUpdateRequests();
+        ts.execute();
+        stats.schedulerPasses++;
+
+        if (hp.getUpdateCount() != updatesBefore) {
+            GoodmanHP::Snapshot snap;
+            hp.readSnapshot(snap);
+            // begin() publishes once, then every update() does
+            if (snap.generation != hp.getUpdateCount() + 1 || snap.state != hp.getState() ||
+                snap.isProtectionActive(GoodmanHP::ProtectionId::LPS_FAULT) != hp.isLPSFaultActive()) {
+                stats.snapshotStale++;
+            }
+        }
+
+        // Invariants — sampled after every scheduler pass
+        bool cntOn = SimHardware::getLevel(CNT_PIN);
+        bool yOn = SimHardware::getLevel(Y_PIN);
+        if (cntOn && !cntWasOn) {
+            stats.cntStarts++;
+            if (cntOffAt > 0 && now - cntOffAt < hp.getCntShortCycleMs()) stats.shortCycles++;
+        }
+        if (!cntOn && cntWasOn) cntOffAt = now;
+        if (lpsTripPending && !cntOn) {
+            uint32_t latency = (uint32_t)(now - lpsTripAt);
+            stats.lpsLatencyCount++;
+            stats.lpsLatencySumMs += latency;
+            if (latency > stats.lpsLatencyMaxMs) stats.lpsLatencyMaxMs = latency;
+            lpsTripPending = false;
+        }
+        if (cntOn && !yOn) {
+            if (cntNoYSince == 0) cntNoYSince = now;
+            if (now - cntNoYSince > 1000) { stats.cntWithoutY++; cntNoYSince = UINT64_MAX / 2; }
+        } else {
+            cntNoYSince = 0;
+        }
+        bool cntLps = cntOn && hp.isLPSFaultActive();
+        if (cntLps && !cntLpsWas) stats.cntDuringLps++;
+        cntLpsWas = cntLps;
+        cntWasOn = cntOn;
+        if (plant.suctionF() > stats.peakSuctionF) stats.peakSuctionF = plant.suctionF();
+        for (uint8_t i = 0; i < DEV_COUNT; i++) {
+            bool spurious = devices[i]->isValid() &&
+                            fabsf(devices[i]->getTempF() - SimHardware::getDeviceTempF(i)) > SPURIOUS_TEMP_F;
+            if (spurious && !deviceSpurious[i]) stats.spuriousTemps++;
+            deviceSpurious[i] = spurious;
+        }
+
+        // Jump the virtual clock to the next scheduled task or plant step
+        uint32_t wait = ts.msUntilNextRun();
+        uint64_t plantWait = nextPlantMs > now ? nextPlantMs - now : 0;
+        if (plantWait < wait) wait = (uint32_t)plantWait;
+        uint64_t eventWait = plant.nextEventMs() > now ? plant.nextEventMs() - now : 0;
+        if (eventWait < wait) wait = (uint32_t)eventWait;
+        uint64_t faultWait = faults.nextEventMs() > now ? faults.nextEventMs() - now : 0;
+        if (faultWait < wait) wait = (uint32_t)faultWait;
+        // A flagged request is serviced on the next loop() pass, as on the device
+        if (hp.isUpdateRequestPending()) wait = 0;
+        if (wait == 0) wait = 1;
+        stats.stateMs[(int)hp.getState()] += wait;
+        SimHardware::advanceMillis(wait);
+    }
+
+    double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double simDays = (SimHardware::elapsedMillis() - startMs) / (double)DAY_MS;
+    uint64_t updateTicks = hp.getUpdateCount();
+
+    printf("scenario: %s  simulated: %.2f days  wall: %.2f s  (%.0fx real time)\n",
+           scenarioName(opt.scenario), simDays, wallSec,
+           wallSec > 0 ? simDays * 86400.0 / wallSec : 0.0);
+    printf("scheduler passes: %llu  update() calls: %llu  run wall per update(): %.3f us\n",
+           (unsigned long long)stats.schedulerPasses, (unsigned long long)updateTicks,
+           updateTicks > 0 ? wallSec * 1e6 / (double)updateTicks : 0.0);
+    printf("scheduler jitter: avg %.2f ms  max %u ms  late >%u ms: %llu of %llu runs\n",
+           ts.getAvgLatenessMs(), ts.getMaxLatenessMs(), Scheduler::LATE_MS,
+           (unsigned long long)ts.getLateRunCount(), (unsigned long long)ts.getRunCount());
+    static const char* deviceNames[DEV_COUNT] = {"compressor", "suction", "ambient", "condenser"};
+    printf("sensor reads (avg interval):");
+    for (uint8_t i = 0; i < DEV_COUNT; i++) {
+        uint32_t reads = SimHardware::getReadCount(i);
+        printf(" %s=%u (%.1f s)", deviceNames[i], reads,
+               reads > 0 ? (double)(SimHardware::elapsedMillis() - startMs) / reads / 1000.0 : 0.0);
+    }
+    printf("\nsensor sweeps: %u  DS18B20 resolution writes: %u\n",
+           hp.getSensorAcquisition().getSweepCount(), SimHardware::getResolutionWriteCount());
+    SensorAcquisition::Health health = {};
+    for (uint8_t i = 0; i < DEV_COUNT; i++) {
+        SensorAcquisition::Health h = {};
+        hp.getSensorAcquisition().getSensorHealth(devices[i], h);
+        health.crcErrors += h.crcErrors;
+        health.disconnects += h.disconnects;
+        health.timeouts += h.timeouts;
+        health.retries += h.retries;
+        health.powerOnResets += h.powerOnResets;
+        health.implausible += h.implausible;
+        health.failedReads += h.failedReads;
+    }
+    printf("sensor errors: crc=%u disconnect=%u timeout=%u retries=%u power-on-reset=%u implausible=%u failed=%u\n",
+           health.crcErrors, health.disconnects, health.timeouts, health.retries,
+           health.powerOnResets, health.implausible, health.failedReads);
+    TempSensor* liquid = hp.getTempSensor("LIQUID_TEMP");
+    SensorAcquisition::Health liquidHealth = {};
+    hp.getSensorAcquisition().getSensorHealth(liquid, liquidHealth);
+    printf("liquid thermocouple: reads=%u alerts=%u bus-busy=%u\n",
+           SimHardware::getThermocoupleReadCount(), liquidHealth.alerts, liquidHealth.busBusy);
+    uint32_t suppressed = 0;
+    for (auto& pair : hp.getTempSensorMap()) suppressed += pair.second->getFilter().getSuppressedCount();
+    printf("temp changes published: %u  suppressed by filter: %u\n", _simTempChanges, suppressed);
+    if (opt.sensorFaultsPerDay > 0.0f) {
+        using Fault = SimHardware::DeviceFault;
+        printf("sensor faults injected: crc=%u disconnect=%u power-on-reset=%u spike=%u stuck-conversion=%u\n",
+               faults.getInjected(Fault::CRC), faults.getInjected(Fault::DISCONNECT),
+               faults.getInjected(Fault::POWER_ON_RESET), faults.getInjected(Fault::SPIKE),
+               faults.getInjected(Fault::STUCK_CONVERSION));
+    }
+    printf("CNT starts: %u  defrosts: %u  state changes: %u  LPS trips: %u  peak suction: %.1fF\n",
+           stats.cntStarts, stats.defrostsStarted, stats.stateChanges, stats.lpsTrips, stats.peakSuctionF);
+    static const char* stateNames[] = {"OFF", "COOL", "HEAT", "DEFROST", "ERROR", "LOW_TEMP"};
+    printf("time in state:");
+    for (int i = 0; i < 6; i++) {
+        printf(" %s=%.1f%%", stateNames[i],
+               100.0 * (double)stats.stateMs[i] / (double)(SimHardware::elapsedMillis() - startMs));
+    }
+    printf("\nlog lines: error=%u warn=%u info=%u\n",
+           simLogCount(Logger::LOG_ERROR), simLogCount(Logger::LOG_WARN), simLogCount(Logger::LOG_INFO));
+    if (stats.lpsLatencyCount > 0) {
+        printf("LPS->CNT off latency: avg %.1f ms  max %u ms  (%u trips with CNT running)\n",
+               (double)stats.lpsLatencySumMs / stats.lpsLatencyCount, stats.lpsLatencyMaxMs,
+               stats.lpsLatencyCount);
+    }
+
+    // OutPin accounting must agree with the GPIO-level observer above
+    uint32_t accountingErrors = 0;
+    OutPin* cnt = hp.getOutputMap()["CNT"];
+    if (cnt != nullptr) {
+        OutPinStats cs;
+        cnt->getStats(cs);
+        printf("CNT accounting: on %.1f h of %.1f h (%.1f%% duty)  cycles %u  last hour %u  shortest off %.1f s\n",
+               cs.onMs / 3.6e6, cs.trackedMs / 3.6e6,
+               cs.trackedMs > 0 ? 100.0 * (double)cs.onMs / (double)cs.trackedMs : 0.0,
+               cs.cycles, cnt->getCyclesLastHour(), cs.shortestOffMs / 1000.0);
+        printf("  on  :");
+        for (uint8_t b = 0; b < OutPinStats::BUCKETS; b++) printf(" %s=%u", OutPinStats::BUCKET_LABELS[b], cs.onHist[b]);
+        printf("\n  off :");
+        for (uint8_t b = 0; b < OutPinStats::BUCKETS; b++) printf(" %s=%u", OutPinStats::BUCKET_LABELS[b], cs.offHist[b]);
+        printf("\n");
+        uint32_t onCount = 0, offCount = 0;
+        for (uint8_t b = 0; b < OutPinStats::BUCKETS; b++) { onCount += cs.onHist[b]; offCount += cs.offHist[b]; }
+        if (cs.cycles != stats.cntStarts) accountingErrors++;
+        if (onCount + (SimHardware::getLevel(CNT_PIN) ? 1 : 0) != cs.cycles) accountingErrors++;
+        if (cs.cycles > 0 && offCount != cs.cycles - 1) accountingErrors++;
+        if (cs.shortestOffMs != 0 && cs.shortestOffMs < hp.getCntShortCycleMs()) accountingErrors++;
+    }
+
+    // Debounced changes / raw edges and the shortest raw pulse, per input
+    printf("input edges:");
+    for (uint8_t i = 0; i < (uint8_t)GoodmanHP::InputId::COUNT; i++) {
+        InputPin* pin = hp.getInput((GoodmanHP::InputId)i);
+        if (pin == nullptr) continue;
+        InputPinStats st;
+        pin->getStats(st);
+        printf(" %s %u/%u", GoodmanHP::getInputName((GoodmanHP::InputId)i), st.edges, st.rawEdges);
+        if (st.minPulseUs > 0) printf(" min %.1f s", st.minPulseUs / 1e6);
+        uint32_t histCount = 0;
+        for (uint8_t b = 0; b < InputPinStats::BUCKETS; b++) histCount += st.bounceHist[b];
+        if (histCount != st.edges || st.rawEdges < st.edges) accountingErrors++;
+    }
+    printf("\n");
+
+    printf("violations: cnt-without-y=%u short-cycle=%u cnt-during-lps=%u snapshot-stale=%u accounting=%u spurious-temp=%u\n",
+           stats.cntWithoutY, stats.shortCycles, stats.cntDuringLps, stats.snapshotStale, accountingErrors,
+           stats.spuriousTemps);
+
+    bool failed = stats.cntWithoutY > 0 || stats.shortCycles > 0 || stats.cntDuringLps > 0 ||
+                  stats.snapshotStale > 0 || accountingErrors > 0 || stats.spuriousTemps > 0;
+    if (opt.scenario == Scenario::BUG1 && !bug1YDropped) {
+        printf("bug1: defrost Phase 2 was never reached\n");
+        failed = true;
+    }
+    printf("%s\n", failed ? "FAIL" : "PASS");
+    return failed ? 1 : 0;
+}
+
+// --- Trace export and replay ---
+
+// Large enough for a few simulated weeks without wrapping (64 MB of host memory)
+static const uint32_t SIM_TRACE_CAPACITY = 1UL << 22;
+
+// Sim GPIOs in InputId / OutputId slot order, for mapping a device trace onto the sim pins
+static const uint8_t SIM_INPUT_PINS[(uint8_t)GoodmanHP::InputId::COUNT] = { LPS_PIN, DFT_PIN, Y_PIN, O_PIN };
+
+static bool writeTrace(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (f == nullptr) {
+        printf("trace: cannot write %s\n", path);
+        return false;
+    }
+    TraceRecorder::Export exp = Trace.beginExport();
+    size_t total = Trace.exportSize(exp);
+    std::vector<uint8_t> buf(64 * 1024);
+    for (size_t offset = 0; offset < total;) {
+        size_t n = Trace.readExport(exp, offset, buf.data(), buf.size());
+        fwrite(buf.data(), 1, n, f);
+        offset += n;
+    }
+    fclose(f);
+    printf("trace: %u records written to %s", exp.count, path);
+    if (exp.dropped > 0) printf(" (%u oldest overwritten, not replayable)", exp.dropped);
+    printf("\n");
+    return true;
+}
+
+static bool loadTrace(const char* path, TraceFileHeader& hdr, std::vector<TraceRecord>& records) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) {
+        printf("replay: cannot open %s\n", path);
+        return false;
+    }
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 && memcmp(hdr.magic, "GHPT", 4) == 0 &&
+              hdr.version == TraceRecorder::VERSION && hdr.recordSize == sizeof(TraceRecord);
+    if (ok) {
+        records.resize(hdr.count);
+        ok = fread(records.data(), sizeof(TraceRecord), hdr.count, f) == hdr.count;
+    }
+    fclose(f);
+    if (!ok) printf("replay: %s is not a version %u trace\n", path, TraceRecorder::VERSION);
+    return ok;
+}
+
+// Observable results after BEGIN, with output GPIOs mapped to OutputId slots
+// so a device trace compares against the sim's own pin numbers
+static void collectResults(const std::vector<TraceRecord>& records, std::vector<TraceRecord>& out) {
+    int16_t outputSlot[256];
+    for (int16_t& slot : outputSlot) slot = -1;
+    bool begun = false;
+    for (const TraceRecord& r : records) {
+        switch ((TraceEvent)r.type) {
+            case TraceEvent::PIN_MAP:
+                if (r.value == (uint32_t)TracePinKind::OUT) outputSlot[r.id] = (int16_t)r.aux;
+                break;
+            case TraceEvent::BEGIN:
+                begun = true;
+                break;
+            case TraceEvent::OUTPUT_LEVEL:
+                if (begun && outputSlot[r.id] >= 0) {
+                    TraceRecord m = r;
+                    m.id = (uint8_t)outputSlot[r.id];
+                    out.push_back(m);
+                }
+                break;
+            case TraceEvent::STATE:
+            case TraceEvent::PROTECTION:
+                if (begun) out.push_back(r);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static const char* traceEventName(uint8_t type) {
+    switch ((TraceEvent)type) {
+        case TraceEvent::OUTPUT_LEVEL: return "OUTPUT";
+        case TraceEvent::STATE: return "STATE";
+        case TraceEvent::PROTECTION: return "PROTECTION";
+        default: return "?";
+    }
+}
+
+static void applyConfig(GoodmanHP& hp, const TraceRecord& r) {
+    float f = TraceRecorder::toFloat(r.value);
+    switch ((TraceConfig)r.id) {
+        case TraceConfig::LOW_TEMP_F: hp.setLowTempThreshold(f); break;
+        case TraceConfig::HIGH_SUCTION_TEMP_F: hp.setHighSuctionTempThreshold(f); break;
+        case TraceConfig::RV_SHORT_CYCLE_MS: hp.setRvShortCycleMs(r.value); break;
+        case TraceConfig::CNT_SHORT_CYCLE_MS: hp.setCntShortCycleMs(r.value); break;
+        case TraceConfig::DEFROST_MIN_RUNTIME_MS: hp.setDefrostMinRuntimeMs(r.value); break;
+        case TraceConfig::DEFROST_EXIT_F: hp.setDefrostExitTempF(f); break;
+        case TraceConfig::HEAT_RUNTIME_THRESHOLD_MS: hp.setHeatRuntimeThresholdMs(r.value); break;
+        case TraceConfig::HEAT_RUNTIME_MS: hp.setHeatRuntimeMs(r.value); break;
+        case TraceConfig::RV_FAIL: hp.setRvFail(); break;
+        case TraceConfig::SOFTWARE_DEFROST: hp.restoreSoftwareDefrost(); break;
+    }
+}
+
+// Recorded where the loop task applied the command, so apply it directly
+static void applyCommand(GoodmanHP& hp, const TraceRecord& r) {
+    hp.runCommand((TraceCommand)r.id, r.value != 0, r.aux < 0xFF ? (uint8_t)r.aux : 0xFF);
+}
+
+// Replays a trace through a fresh controller: stimuli are re-applied at their
+// recorded times and update() runs exactly where the recording ran it, so the
+// outputs, states and protections must come out identical. Inputs take the
+// levels the recording's debouncer accepted rather than being re-debounced
+// against this run's scheduler timing. OutPin delay tasks still run from the
+// scheduler, so their edges may land a few ms apart (skew).
+static int runReplay(const SimOptions& opt) {
+    TraceFileHeader hdr;
+    std::vector<TraceRecord> recorded;
+    if (!loadTrace(opt.replay.c_str(), hdr, recorded)) return 2;
+    bool hasBegin = false;
+    for (const TraceRecord& r : recorded) {
+        if ((TraceEvent)r.type == TraceEvent::BEGIN) { hasBegin = true; break; }
+    }
+    if (hdr.dropped > 0 || !hasBegin || recorded.empty()) {
+        printf("replay: trace does not start at boot (%u records overwritten); "
+               "clear /trace after a reboot and download before the ring wraps\n", hdr.dropped);
+        return 2;
+    }
+
+    Scheduler ts;
+    GoodmanHP hp(&ts);
+    SelectedBoardPins pins;
+    Trace.begin(SIM_TRACE_CAPACITY);
+    buildController(hp, pins, &ts, nullptr);   // No bus: readings come only from TEMP_SAMPLE
+    pins.debouncer().setSamplingEnabled(false); // Debounced levels come only from INPUT_DEBOUNCED
+    SimHardware::setMillis(recorded.front().ms);
+
+    int16_t inputPin[256], inputSlot[256];
+    for (int16_t& pin : inputPin) pin = -1;
+    for (int16_t& slot : inputSlot) slot = -1;
+    uint32_t updates = 0;
+    bool seeding = false;
+    auto wallStart = std::chrono::steady_clock::now();
+
+    for (const TraceRecord& r : recorded) {
+        // Run scheduler work (debouncer, OutPin delays, temp task) up to the record's time
+        for (;;) {
+            pins.debouncer().serviceSampleRequests();
+            ts.execute();
+            int32_t remain = (int32_t)(r.ms - millis());
+            if (remain <= 0) break;
+            uint32_t wait = ts.msUntilNextRun();
+            if (wait == 0) wait = 1;
+            SimHardware::advanceMillis(wait < (uint32_t)remain ? wait : (uint32_t)remain);
+        }
+
+        if ((TraceEvent)r.type != TraceEvent::INPUT_EDGE) seeding = false;
+        switch ((TraceEvent)r.type) {
+            case TraceEvent::PIN_MAP:
+                if (r.value == (uint32_t)TracePinKind::IN && r.aux < (uint32_t)GoodmanHP::InputId::COUNT) {
+                    inputPin[r.id] = SIM_INPUT_PINS[r.aux];
+                    inputSlot[r.id] = (int16_t)r.aux;
+                }
+                break;
+            case TraceEvent::CONFIG:
+                applyConfig(hp, r);
+                break;
+            case TraceEvent::BEGIN:
+                hp.begin();
+                hp.setUpdateTaskEnabled(false);   // update() runs only at UPDATE records
+                seeding = true;
+                break;
+            case TraceEvent::INPUT_EDGE:
+                if (inputPin[r.id] >= 0) SimHardware::setLevel((uint8_t)inputPin[r.id], (int)r.value);
+                // The levels logged with BEGIN were already settled on the device
+                if (seeding) pins.debouncer().seed();
+                break;
+            case TraceEvent::INPUT_DEBOUNCED:
+                if (inputSlot[r.id] >= 0) {
+                    hp.getInput((GoodmanHP::InputId)inputSlot[r.id])->debouncedEdge((uint16_t)r.value, r.aux);
+                }
+                break;
+            case TraceEvent::TEMP_SAMPLE: {
+                TempSensor* sensor = hp.getTempSensor((GoodmanHP::SensorId)r.id);
+                if (sensor != nullptr) {
+                    sensor->setDeciF(TraceRecorder::toDeciF(r.value));
+                    sensor->setValid(r.aux != 0);
+                }
+                break;
+            }
+            case TraceEvent::COMMAND:
+                applyCommand(hp, r);
+                break;
+            case TraceEvent::UPDATE:
+                hp.update();
+                updates++;
+                break;
+            default:
+                break;
+        }
+    }
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+
+    std::vector<TraceRecord> replayed, expected, actual;
+    TraceRecorder::Export exp = Trace.beginExport();
+    replayed.resize(exp.count);
+    Trace.readExport(exp, sizeof(TraceFileHeader), (uint8_t*)replayed.data(), exp.count * sizeof(TraceRecord));
+    collectResults(recorded, expected);
+    collectResults(replayed, actual);
+
+    // Same events in the same order with the same values; timestamps may skew
+    size_t compared = expected.size() < actual.size() ? expected.size() : actual.size();
+    size_t divergeAt = SIZE_MAX;
+    uint32_t skewed = 0, maxSkewMs = 0;
+    for (size_t i = 0; i < compared; i++) {
+        const TraceRecord& e = expected[i];
+        const TraceRecord& a = actual[i];
+        if (e.type != a.type || e.id != a.id || e.value != a.value || e.aux != a.aux) {
+            divergeAt = i;
+            break;
+        }
+        uint32_t skew = (uint32_t)abs((int32_t)(a.ms - e.ms));
+        if (skew > 0) skewed++;
+        if (skew > maxSkewMs) maxSkewMs = skew;
+    }
+    if (divergeAt == SIZE_MAX && expected.size() != actual.size()) divergeAt = compared;
+
+    printf("replay: %s\n", opt.replay.c_str());
+    printf("records=%u updates=%u span=%.2f h wall=%.1f ms\n", hdr.count, updates,
+           (double)(recorded.back().ms - recorded.front().ms) / 3600000.0, wallMs);
+    printf("results: recorded=%u replayed=%u skewed=%u max-skew=%u ms\n",
+           (uint32_t)expected.size(), (uint32_t)actual.size(), skewed, maxSkewMs);
+    if (divergeAt != SIZE_MAX) {
+        printf("diverged at result %u:\n", (uint32_t)divergeAt);
+        if (divergeAt < expected.size()) {
+            const TraceRecord& e = expected[divergeAt];
+            printf("  recorded %-10s id=%u value=%u aux=%u at %u ms\n", traceEventName(e.type), e.id, e.value, e.aux, e.ms);
+        }
+        if (divergeAt < actual.size()) {
+            const TraceRecord& a = actual[divergeAt];
+            printf("  replayed %-10s id=%u value=%u aux=%u at %u ms\n", traceEventName(a.type), a.id, a.value, a.aux, a.ms);
+        }
+        printf("FAIL\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
+
+// --- Benchmark: wall-clock cost of a single update() tick ---
+
+static double benchState(const char* label, bool y, bool o, uint32_t ticks, const SimOptions& opt) {
+    Scheduler ts;
+    DallasTemperature sensors;
+    GoodmanHP hp(&ts);
+    SelectedBoardPins pins;
+    buildController(hp, pins, &ts, &sensors);
+    hp.setHeatRuntimeThresholdMs((uint32_t)(opt.heatRuntimeThresholdMin * 60000.0f));
+
+    SimHardware::setLevel(LPS_PIN, HIGH);
+    SimHardware::setLevel(Y_PIN, y);
+    SimHardware::setLevel(O_PIN, o);
+    SimHardware::setLevel(DFT_PIN, LOW);
+    SimHardware::setDeviceTempF(DEV_COMPRESSOR, 120.0f);
+    SimHardware::setDeviceTempF(DEV_SUCTION, 45.0f);
+    SimHardware::setDeviceTempF(DEV_AMBIENT, 50.0f);
+    SimHardware::setDeviceTempF(DEV_CONDENSER, 50.0f);
+    pins.debouncer().seed();
+    hp.begin();
+
+    // Get past the startup lockout and into steady state (sensors read, CNT running)
+    uint32_t warmupMs = GoodmanHP::STARTUP_LOCKOUT_MS + 5UL * 60 * 1000;
+    for (uint32_t t = 0; t < warmupMs; t += 500) {
+        SimHardware::advanceMillis(500);
+        ts.execute();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < ticks; i++) {
+        SimHardware::advanceMillis(500);
+        hp.update();
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    double perTick = ns / ticks;
+    printf("  %-8s %9.1f ns/update  (state %s)\n", label, perTick, hp.getStateString());
+    return perTick;
+}
+
+static int runBenchmark(const SimOptions& opt) {
+    printf("update() benchmark, %u ticks per state:\n", opt.benchTicks);
+    benchState("idle", false, false, opt.benchTicks, opt);
+    benchState("heat", true, false, opt.benchTicks, opt);
+    benchState("cool", true, true, opt.benchTicks, opt);
+
+    Trace.begin(SIM_TRACE_CAPACITY);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < opt.benchTicks; i++) {
+        Trace.record(TraceEvent::UPDATE, 0, i);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    printf("  %-8s %9.1f ns/record\n", "trace", ns / opt.benchTicks);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    SimOptions opt;
+    if (!parseArgs(argc, argv, opt)) {
+        printUsage();
+        return 2;
+    }
+    if (opt.scenario == Scenario::BUG1 && opt.days == 30.0) {
+        opt.days = 1.0;
+        opt.heatRuntimeThresholdMin = 20.0f;
+    }
+
+    HardwareSerial::enabled = opt.verbose;
+    Log.enableSerial(opt.verbose);
+    Log.setLevel(opt.verbose ? Logger::LOG_DEBUG : Logger::LOG_INFO);
+
+    if (opt.replay.length() > 0) return runReplay(opt);
+    if (opt.benchTicks > 0) return runBenchmark(opt);
+    if (opt.traceOut.length() > 0) Trace.begin(SIM_TRACE_CAPACITY);
+    int result = runSimulation(opt);
+    if (opt.traceOut.length() > 0 && !writeTrace(opt.traceOut.c_str())) return 2;
+    return result;
+}
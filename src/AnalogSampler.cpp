@@ -0,0 +1,171 @@
+#include "AnalogSampler.h"
+#include "Logger.h"
+#include <driver/adc.h>
+
+// The classic ESP32's driver needs the conversion limit enabled; the S3's
+// must have it off
+#if CONFIG_IDF_TARGET_ESP32
+#define ANALOG_OUTPUT_FORMAT ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define ANALOG_CONV_LIMIT_EN 1
+#define ANALOG_RESULT_CHANNEL(p) ((p)->type1.channel)
+#define ANALOG_RESULT_DATA(p) ((p)->type1.data)
+#else
+#define ANALOG_OUTPUT_FORMAT ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define ANALOG_CONV_LIMIT_EN 0
+#define ANALOG_RESULT_CHANNEL(p) ((p)->type2.channel)
+#define ANALOG_RESULT_DATA(p) ((p)->type2.data)
+#endif
+
+AnalogSampler::AnalogSampler(Scheduler* ts)
+    : _channels()
+    , _count(0)
+    , _oversample(DEFAULT_OVERSAMPLE)
+    , _running(false)
+    , _overruns(0)
+{
+    for (uint8_t c = 0; c < SOC_ADC_MAX_CHANNEL_NUM; c++) _slotForChannel[c] = -1;
+    _tsk = new Task(DRAIN_MS, TASK_FOREVER, [this]() {
+        this->drain();
+    }, ts, false);
+}
+
+bool AnalogSampler::addInput(InputPin* pin, uint8_t filterShift) {
+    if (_running || _count >= MAX_INPUTS || _count >= SOC_ADC_PATT_LEN_MAX) {
+        Log.error("ADC", "Cannot sample %s: sampler full or already running", pin->getName().c_str());
+        return false;
+    }
+    // ADC1 channels come first in the core's numbering; ADC2 follows
+    int8_t channel = digitalPinToAnalogChannel(pin->getPin());
+    if (channel < 0 || channel >= SOC_ADC_MAX_CHANNEL_NUM) {
+        Log.error("ADC", "Cannot sample %s: GPIO %u is not an ADC1 pin", pin->getName().c_str(), pin->getPin());
+        return false;
+    }
+    if (_slotForChannel[channel] >= 0) {
+        Log.error("ADC", "Cannot sample %s: ADC1 channel %d already registered", pin->getName().c_str(), channel);
+        return false;
+    }
+    if (filterShift > MAX_FILTER_SHIFT) filterShift = MAX_FILTER_SHIFT;
+
+    Channel& ch = _channels[_count];
+    ch.pin = pin;
+    ch.adcChannel = (uint8_t)channel;
+    ch.filterShift = filterShift;
+    ch.primed = false;
+    ch.sum = 0;
+    ch.samples = 0;
+    ch.filtered = 0;
+    _slotForChannel[channel] = _count;
+    _count++;
+    return true;
+}
+
+void AnalogSampler::setOversample(uint16_t samples) {
+    // 12-bit results: 4096 of them keep the sum well inside 32 bits
+    if (samples == 0) samples = 1;
+    if (samples > 4096) samples = 4096;
+    _oversample = samples;
+    for (uint8_t i = 0; i < _count; i++) {
+        _channels[i].sum = 0;
+        _channels[i].samples = 0;
+    }
+}
+
+bool AnalogSampler::setFilterShift(InputPin* pin, uint8_t filterShift) {
+    if (filterShift > MAX_FILTER_SHIFT) filterShift = MAX_FILTER_SHIFT;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_channels[i].pin != pin) continue;
+        _channels[i].filterShift = filterShift;
+        _channels[i].primed = false;    // Reseed at the new scale
+        return true;
+    }
+    return false;
+}
+
+bool AnalogSampler::begin() {
+    if (_running || _count == 0) return false;
+
+    uint32_t chanMask = 0;
+    adc_digi_pattern_config_t pattern[SOC_ADC_PATT_LEN_MAX] = {};
+    for (uint8_t i = 0; i < _count; i++) {
+        chanMask |= 1UL << _channels[i].adcChannel;
+        pattern[i].atten = ADC_ATTEN_DB_11;
+        pattern[i].channel = _channels[i].adcChannel;
+        pattern[i].unit = 0;            // ADC1
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    adc_digi_init_config_t initCfg = {};
+    initCfg.max_store_buf_size = STORE_BYTES;
+    initCfg.conv_num_each_intr = FRAME_BYTES;
+    initCfg.adc1_chan_mask = chanMask;
+    initCfg.adc2_chan_mask = 0;
+    esp_err_t err = adc_digi_initialize(&initCfg);
+    if (err != ESP_OK) {
+        Log.error("ADC", "Continuous ADC init failed: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    adc_digi_configuration_t digCfg = {};
+    digCfg.conv_limit_en = ANALOG_CONV_LIMIT_EN;
+    digCfg.conv_limit_num = 250;
+    digCfg.pattern_num = _count;
+    digCfg.adc_pattern = pattern;
+    digCfg.sample_freq_hz = SAMPLE_HZ;
+    digCfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digCfg.format = ANALOG_OUTPUT_FORMAT;
+    err = adc_digi_controller_configure(&digCfg);
+    if (err == ESP_OK) err = adc_digi_start();
+    if (err != ESP_OK) {
+        Log.error("ADC", "Continuous ADC start failed: %s", esp_err_to_name(err));
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    _running = true;
+    _tsk->enable();
+    Log.info("ADC", "Sampling %u analog input(s) at %lu Hz, %u samples per value",
+             _count, SAMPLE_HZ, _oversample);
+    return true;
+}
+
+void AnalogSampler::drain() {
+    for (;;) {
+        uint32_t len = 0;
+        esp_err_t err = adc_digi_read_bytes(_frame, FRAME_BYTES, &len, 0);
+        if (err == ESP_ERR_INVALID_STATE) {
+            // Driver ring overflowed before this drain; the data returned is still valid
+            _overruns++;
+            if ((_overruns & (_overruns - 1)) == 0) {
+                Log.warn("ADC", "Continuous ADC overrun (%lu total)", _overruns);
+            }
+        } else if (err != ESP_OK) {
+            return;                     // ESP_ERR_TIMEOUT: ring is empty
+        }
+        for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES) {
+            const adc_digi_output_data_t* p = (const adc_digi_output_data_t*)&_frame[i];
+            uint8_t channel = ANALOG_RESULT_CHANNEL(p);
+            if (channel >= SOC_ADC_MAX_CHANNEL_NUM) continue;
+            int8_t slot = _slotForChannel[channel];
+            if (slot < 0) continue;
+            accumulate(_channels[slot], ANALOG_RESULT_DATA(p));
+        }
+        if (len < FRAME_BYTES) return;
+    }
+}
+
+void AnalogSampler::accumulate(Channel& ch, uint16_t raw) {
+    ch.sum += raw;
+    if (++ch.samples < _oversample) return;
+
+    uint16_t value = (uint16_t)((ch.sum + _oversample / 2) / _oversample);
+    ch.sum = 0;
+    ch.samples = 0;
+
+    if (!ch.primed) {
+        ch.filtered = (uint32_t)value << ch.filterShift;
+        ch.primed = true;
+    } else {
+        ch.filtered = ch.filtered - (ch.filtered >> ch.filterShift) + value;
+    }
+    ch.pin->setSampledValue((uint16_t)(ch.filtered >> ch.filterShift));
+}
@@ -3,7 +3,6 @@
 #include "esp_random.h"
 
 // External callbacks for temp sensors
-extern void tempSensorUpdateCallback(TempSensor* sensor);
 extern void tempSensorChangeCallback(TempSensor* sensor);
 
 uint8_t Config::_aesKey[32] = {0};
@@ -245,6 +244,7 @@ bool Config::loadTempConfig(const char* filename, TempSensorMap& config, Project
     JsonObject runtime = doc["runtime"];
     proj.heatRuntimeAccumulatedMs = runtime["heatAccumulatedMs"] | 0;
     Serial.printf("Read heat runtime: %u ms\n", proj.heatRuntimeAccumulatedMs);
+    outputStatsFromJson(runtime["outputs"], proj.outputStats);
 
     // Load timezone settings
     JsonObject timezone = doc["timezone"];
@@ -299,6 +299,9 @@ bool Config::loadTempConfig(const char* filename, TempSensorMap& config, Project
     _adminPasswordHash = decryptPassword(adminPwStr);
     Serial.printf("Admin password: %s\n", _adminPasswordHash.length() > 0 ? "set" : "not set");
 
+    sensorFiltersFromJson(doc["sensors"]["filter"], proj.sensorFilters);
+    Serial.printf("Read sensor filters: %u\n", (unsigned)proj.sensorFilters.size());
+
     clearConfig(config);
     for (JsonPair sensors_temp_item : doc["sensors"]["temp"].as<JsonObject>()) {
         const char* key = sensors_temp_item.key().c_str();
@@ -315,16 +318,15 @@ bool Config::loadTempConfig(const char* filename, TempSensorMap& config, Project
         Serial.printf("Devstr:%s\n", devaddrStr.c_str());
         TempSensor::stringToAddress(devaddrStr, sensor->getDeviceAddress());
 
-        sensor->setValue(last_value);
-        sensor->setPrevious(sensor->getValue());
+        sensor->setDeciF((DeciF)(last_value * 10));
+        sensor->setPreviousDeciF(sensor->getDeciF());
         sensor->setValid(true);
         sensor->setChangeCallback(tempSensorChangeCallback);
-        sensor->setUpdateCallback(tempSensorUpdateCallback);
 
         Serial.printf("JSON description: %s\tID:%s\t Value:%.1f\n",
              sensor->getDescription().c_str(),
              TempSensor::addressToString(sensor->getDeviceAddress()).c_str(),
-             sensor->getValue());
+             sensor->getTempF());
     }
     _configFile.close();
     return true;
@@ -376,6 +378,7 @@ bool Config::saveConfiguration(const char* filename, TempSensorMap& config, Proj
 
     JsonObject runtime = doc["runtime"].to<JsonObject>();
     runtime["heatAccumulatedMs"] = proj.heatRuntimeAccumulatedMs;
+    outputStatsToJson(runtime["outputs"].to<JsonObject>(), proj.outputStats);
 
     JsonObject timezone = doc["timezone"].to<JsonObject>();
     timezone["gmtOffset"] = proj.gmtOffsetSec;
@@ -417,9 +420,10 @@ bool Config::saveConfiguration(const char* filename, TempSensorMap& config, Proj
         String id = TempSensor::addressToString(mp.second->getDeviceAddress());
         JsonObject temp = sensors_temp[id].to<JsonObject>();
         temp["description"] = mp.second->getDescription();
-        temp["last-value"] = mp.second->getValue();
+        temp["last-value"] = mp.second->getTempF();
         temp["name"] = mp.first;
     }
+    sensorFiltersToJson(sensors["filter"].to<JsonObject>(), proj.sensorFilters);
     String output;
     serializeJson(doc, _configFile);
     serializeJsonPretty(doc, output);
@@ -429,7 +433,7 @@ bool Config::saveConfiguration(const char* filename, TempSensorMap& config, Proj
     return true;
 }
 
-bool Config::updateConfig(const char* filename, TempSensorMap& config, ProjectInfo& proj) {
+bool Config::updateConfig(const char* filename, const TempSensorMap& config, ProjectInfo& proj) {
     if (!_sdInitialized) {
         return false;
     }
@@ -468,6 +472,7 @@ bool Config::updateConfig(const char* filename, TempSensorMap& config, ProjectIn
 
     JsonObject runtime = doc["runtime"].to<JsonObject>();
     runtime["heatAccumulatedMs"] = proj.heatRuntimeAccumulatedMs;
+    outputStatsToJson(runtime["outputs"].to<JsonObject>(), proj.outputStats);
 
     JsonObject timezone = doc["timezone"].to<JsonObject>();
     timezone["gmtOffset"] = proj.gmtOffsetSec;
@@ -540,7 +545,73 @@ bool Config::loadCertificates(const char* certFile, const char* keyFile) {
     return true;
 }
 
-bool Config::updateRuntime(const char* filename, uint32_t heatRuntimeMs, bool softwareDefrost) {
+// Raw OutPinStats fields per output name; histograms in BUCKET_LABELS order
+void Config::outputStatsToJson(JsonObject outputs, const std::map<String, OutPinStats>& stats) {
+    for (const auto& pair : stats) {
+        const OutPinStats& st = pair.second;
+        JsonObject o = outputs[pair.first].to<JsonObject>();
+        o["onMs"] = st.onMs;
+        o["trackedMs"] = st.trackedMs;
+        o["cycles"] = st.cycles;
+        o["shortestOffMs"] = st.shortestOffMs;
+        JsonArray onHist = o["onHist"].to<JsonArray>();
+        JsonArray offHist = o["offHist"].to<JsonArray>();
+        for (uint8_t i = 0; i < OutPinStats::BUCKETS; i++) {
+            onHist.add(st.onHist[i]);
+            offHist.add(st.offHist[i]);
+        }
+    }
+}
+
+void Config::outputStatsFromJson(JsonObject outputs, std::map<String, OutPinStats>& stats) {
+    stats.clear();
+    if (outputs.isNull()) return;
+    for (JsonPair kv : outputs) {
+        JsonObject o = kv.value();
+        OutPinStats st = {};
+        st.onMs = o["onMs"] | (uint64_t)0;
+        st.trackedMs = o["trackedMs"] | (uint64_t)0;
+        st.cycles = o["cycles"] | 0;
+        st.shortestOffMs = o["shortestOffMs"] | 0;
+        JsonArray onHist = o["onHist"];
+        JsonArray offHist = o["offHist"];
+        for (uint8_t i = 0; i < OutPinStats::BUCKETS; i++) {
+            st.onHist[i] = onHist[i] | 0;
+            st.offHist[i] = offHist[i] | 0;
+        }
+        if (st.trackedMs < st.onMs) st.trackedMs = st.onMs;
+        stats[String(kv.key().c_str())] = st;
+    }
+}
+
+void Config::sensorFiltersToJson(JsonObject filters, const std::map<String, TempFilter::Config>& configs) {
+    for (const auto& pair : configs) {
+        const TempFilter::Config& fc = pair.second;
+        JsonObject o = filters[pair.first].to<JsonObject>();
+        o["median"] = fc.median;
+        o["emaTauSec"] = fc.emaTauSec;
+        o["slewFPerSec"] = fc.slewFPerSec;
+        o["deadbandF"] = fc.deadbandF;
+    }
+}
+
+// Stages left out of an entry keep their TempFilter::DEFAULTS setting
+void Config::sensorFiltersFromJson(JsonObject filters, std::map<String, TempFilter::Config>& configs) {
+    configs.clear();
+    if (filters.isNull()) return;
+    for (JsonPair kv : filters) {
+        JsonObject o = kv.value();
+        TempFilter::Config fc = TempFilter::DEFAULTS;
+        fc.median = o["median"] | fc.median;
+        fc.emaTauSec = o["emaTauSec"] | fc.emaTauSec;
+        fc.slewFPerSec = o["slewFPerSec"] | fc.slewFPerSec;
+        fc.deadbandF = o["deadbandF"] | fc.deadbandF;
+        configs[String(kv.key().c_str())] = fc;
+    }
+}
+
+bool Config::updateRuntime(const char* filename, uint32_t heatRuntimeMs, bool softwareDefrost,
+                           const std::map<String, OutPinStats>& outputStats) {
     if (!_sdInitialized) {
         return false;
     }
@@ -560,6 +631,7 @@ bool Config::updateRuntime(const char* filename, uint32_t heatRuntimeMs, bool so
 
     // Update runtime and defrost active fields
     doc["runtime"]["heatAccumulatedMs"] = heatRuntimeMs;
+    outputStatsToJson(doc["runtime"]["outputs"].to<JsonObject>(), outputStats);
     doc["heatpump"]["defrost"]["active"] = softwareDefrost;
 
     // Write back
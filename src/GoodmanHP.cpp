@@ -1,70 +1,285 @@
 #include "GoodmanHP.h"
 #include "Logger.h"
-
-// Static instance pointer for runtime callback
-GoodmanHP* GoodmanHP::_instance = nullptr;
+#include "TraceRecorder.h"
+#include <cmath>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+
+// Names for the fixed InputId/OutputId/SensorId slots (same order as the enums)
+static const char* const INPUT_NAMES[] = { "LPS", "DFT", "Y", "O" };
+static const char* const OUTPUT_NAMES[] = { "FAN", "CNT", "W", "RV" };
+static const char* const SENSOR_NAMES[] = {
+    "AMBIENT_TEMP", "COMPRESSOR_TEMP", "SUCTION_TEMP", "CONDENSER_TEMP", "LIQUID_TEMP"
+};
+
+// Sensor behind each temperature ProtectionSource, in ProtectionSource order
+static const GoodmanHP::SensorId SOURCE_SENSORS[] = {
+    GoodmanHP::SensorId::COMPRESSOR, GoodmanHP::SensorId::SUCTION, GoodmanHP::SensorId::AMBIENT
+};
+
+static_assert(sizeof(INPUT_NAMES) / sizeof(INPUT_NAMES[0]) == (size_t)GoodmanHP::InputId::COUNT,
+              "INPUT_NAMES out of sync with InputId");
+static_assert(sizeof(OUTPUT_NAMES) / sizeof(OUTPUT_NAMES[0]) == (size_t)GoodmanHP::OutputId::COUNT,
+              "OUTPUT_NAMES out of sync with OutputId");
+static_assert(sizeof(SENSOR_NAMES) / sizeof(SENSOR_NAMES[0]) == (size_t)GoodmanHP::SensorId::COUNT,
+              "SENSOR_NAMES out of sync with SensorId");
+
+// Slot index for a known name, or -1 for pins/sensors not used by the controller
+template <size_t N>
+static int slotIndex(const char* const (&names)[N], const String& name) {
+    for (size_t i = 0; i < N; i++) {
+        if (name == names[i]) return (int)i;
+    }
+    return -1;
+}
+
+// Protection rules, evaluated in table order once per update(). Order matters:
+// earlier trips inhibit later rules (e.g. compressor overtemp suppresses LPS).
+const GoodmanHP::ProtectionRule GoodmanHP::PROTECTION_RULES[] = {
+    // Compressor over-temperature: shut CNT, keep FAN on to cool the compressor
+    { ProtectionId::COMPRESSOR_OVERTEMP, "Compressor overtemp",
+      ProtectionSource::COMPRESSOR_TEMP, TripDirection::ABOVE,
+      toDeciF(COMPRESSOR_OVERTEMP_ON_F), toDeciF(COMPRESSOR_OVERTEMP_OFF_F), nullptr, nullptr, DECIF_NONE, 0,
+      COMPRESSOR_OVERTEMP_CHECK_MS, 0, SCOPE_ANY, SCOPE_ANY, 0, State::OFF,
+      ACT_CNT_OFF | ACT_FAN_ON, 0, 0,
+      FLAG_NOTIFY_CLEAR },
+
+    // Suction low temperature (COOL only): shut CNT, keep FAN on
+    { ProtectionId::SUCTION_LOW_TEMP, "Suction low temp",
+      ProtectionSource::SUCTION_TEMP, TripDirection::BELOW,
+      toDeciF(SUCTION_CRITICAL_F), toDeciF(SUCTION_RESUME_F), nullptr, nullptr, toDeciF(SUCTION_WARN_F), 0,
+      SUCTION_CHECK_MS, 0, 1 << (uint8_t)State::COOL,
+      (1 << (uint8_t)State::COOL) | (1 << (uint8_t)State::ERROR), 0, State::OFF,
+      ACT_CNT_OFF | ACT_FAN_ON, 0, 0,
+      FLAG_NOTIFY_CLEAR },
+
+    // High suction temp during active defrost means the RV failed to shift:
+    // latch RV fail, stop defrost, auxiliary heat if HEAT is requested
+    { ProtectionId::HIGH_SUCTION_TEMP, "High suction temp (RV fail)",
+      ProtectionSource::SUCTION_TEMP, TripDirection::ABOVE,
+      0, 0, &GoodmanHP::_highSuctionTemp, &GoodmanHP::_highSuctionTemp, DECIF_NONE, 0,
+      0, PROTECTION_CONFIRM_MS, SCOPE_DEFROST_ACTIVE, 0, 0, State::OFF,
+      ACT_CNT_OFF | ACT_FAN_ON | ACT_W_ON_HEAT | ACT_RV_OFF | ACT_LATCH_RV_FAIL | ACT_STOP_DEFROST, 0, 0,
+      FLAG_NO_AUTO_CLEAR },
+
+    // Low pressure switch open: ERROR state, CNT off, auxiliary heat in HEAT mode
+    { ProtectionId::LPS_FAULT, "LPS fault (low refrigerant pressure)",
+      ProtectionSource::LPS_INPUT, TripDirection::BELOW,
+      toDeciF(0.5f), toDeciF(0.5f), nullptr, nullptr, DECIF_NONE, 0,
+      0, 0, SCOPE_ANY, SCOPE_ANY, protectionBit(ProtectionId::COMPRESSOR_OVERTEMP), State::ERROR,
+      ACT_CNT_OFF | ACT_W_ON_HEAT, 0, ACT_W_OFF | ACT_RESET_Y_TIMER,
+      FLAG_ENTER_STATE | FLAG_LPS_CALLBACK | FLAG_CLEAR_INFO },
+
+    // Low ambient: LOW_TEMP state, compressor/FAN/RV off, W unless COOL requested
+    { ProtectionId::LOW_AMBIENT, "Low ambient temp",
+      ProtectionSource::AMBIENT_TEMP, TripDirection::BELOW,
+      0, 0, &GoodmanHP::_lowTemp, &GoodmanHP::_lowTemp, DECIF_NONE, toDeciF(LOW_TEMP_CLEAR_BAND_F),
+      0, PROTECTION_CONFIRM_MS, SCOPE_ANY, SCOPE_ANY,
+      (uint8_t)(protectionBit(ProtectionId::COMPRESSOR_OVERTEMP) | protectionBit(ProtectionId::LPS_FAULT)), State::LOW_TEMP,
+      ACT_CNT_OFF | ACT_FAN_OFF | ACT_RV_OFF | ACT_W_ON_NOT_COOL, ACT_W_OFF_IF_COOL, ACT_W_OFF,
+      FLAG_ENTER_STATE | FLAG_TRIP_WARN | FLAG_CLEAR_INFO },
+};
+
+// Defrost state hierarchy, indexed by DefrostPhase. Leaves settle for the
+// referenced member before COND_SETTLED holds; superstates only group rows.
+constexpr GoodmanHP::DefrostNode GoodmanHP::DEFROST_NODES[] = {
+    { "NONE",           DefrostPhase::NODE_COUNT,    nullptr,                     nullptr },
+    { "PENDING",        DefrostPhase::ANY_REQUESTED, nullptr,                     nullptr },
+    { "ENTRY_EQUALIZE", DefrostPhase::ANY_ENTRY,     &GoodmanHP::_rvShortCycleMs,  nullptr },
+    { "ENTRY_CNT_WAIT", DefrostPhase::ANY_ENTRY,     &GoodmanHP::_cntShortCycleMs, nullptr },
+    { "ACTIVE",         DefrostPhase::ANY_RUNNING,   nullptr,                     nullptr },
+    { "SUSPENDED",      DefrostPhase::ANY_RUNNING,   nullptr,                     nullptr },
+    { "EXIT_EQUALIZE",  DefrostPhase::ANY_EXIT,      &GoodmanHP::_rvShortCycleMs,  nullptr },
+    { "EXIT_CNT_WAIT",  DefrostPhase::ANY_EXIT,      &GoodmanHP::_cntShortCycleMs, nullptr },
+    { "ANY_REQUESTED",  DefrostPhase::NODE_COUNT,    nullptr,                     nullptr },
+    { "ANY_ENTRY",      DefrostPhase::ANY_REQUESTED, nullptr,                     nullptr },
+    { "ANY_RUNNING",    DefrostPhase::ANY_REQUESTED, nullptr,                     &GoodmanHP::monitorDefrost },
+    { "ANY_EXIT",       DefrostPhase::NODE_COUNT,    nullptr,                     nullptr },
+};
+
+// Defrost transitions, grouped by source node in DefrostPhase order. A leaf's
+// rows are tried before its superstates' rows; the first match fires. Rows
+// that must not fire once Y is gone carry COND_Y_ACTIVE so the superstate's
+// Y-lost row wins instead.
+constexpr GoodmanHP::DefrostTransition GoodmanHP::DEFROST_TRANSITIONS[] = {
+    { DefrostPhase::NONE,           DefrostTrigger::START,   COND_HAS_OUTPUTS,                 DefrostPhase::ENTRY_EQUALIZE, &GoodmanHP::startDefrost },
+    { DefrostPhase::NONE,           DefrostTrigger::TICK,    COND_HEAT_DUE | COND_HAS_OUTPUTS, DefrostPhase::ENTRY_EQUALIZE, &GoodmanHP::startDefrostOnRuntime },
+    { DefrostPhase::NONE,           DefrostTrigger::RESTORE, 0,                                DefrostPhase::PENDING,        nullptr },
+
+    { DefrostPhase::PENDING,        DefrostTrigger::Y_DROP,  0,                                DefrostPhase::PENDING,        &GoodmanHP::shutdownForYDrop },
+
+    { DefrostPhase::ENTRY_EQUALIZE, DefrostTrigger::TICK,    COND_SETTLED | COND_Y_ACTIVE,     DefrostPhase::ENTRY_CNT_WAIT, &GoodmanHP::engageDefrostValves },
+
+    { DefrostPhase::ENTRY_CNT_WAIT, DefrostTrigger::TICK,    COND_SETTLED | COND_CNT_FREE | COND_Y_ACTIVE,
+                                                                                               DefrostPhase::ACTIVE,         &GoodmanHP::engageDefrostCompressor },
+
+    { DefrostPhase::ACTIVE,         DefrostTrigger::Y_DROP,  0,                                DefrostPhase::SUSPENDED,      &GoodmanHP::shutdownForYDrop },
+
+    { DefrostPhase::SUSPENDED,      DefrostTrigger::Y_DROP,  0,                                DefrostPhase::SUSPENDED,      &GoodmanHP::shutdownForYDrop },
+
+    { DefrostPhase::EXIT_EQUALIZE,  DefrostTrigger::TICK,    COND_SETTLED | COND_Y_ACTIVE,     DefrostPhase::EXIT_CNT_WAIT,  &GoodmanHP::releaseDefrostValves },
+
+    { DefrostPhase::EXIT_CNT_WAIT,  DefrostTrigger::TICK,    COND_SETTLED | COND_CNT_FREE | COND_Y_ACTIVE,
+                                                                                               DefrostPhase::NONE,           &GoodmanHP::finishDefrostExit },
+
+    { DefrostPhase::ANY_REQUESTED,  DefrostTrigger::RESUME,  0,                                DefrostPhase::ENTRY_EQUALIZE, &GoodmanHP::restartDefrostEntry },
+    { DefrostPhase::ANY_REQUESTED,  DefrostTrigger::COOL_REQUEST, 0,                           DefrostPhase::NONE,           &GoodmanHP::cancelDefrostForCool },
+    { DefrostPhase::ANY_REQUESTED,  DefrostTrigger::STOP,    0,                                DefrostPhase::NONE,           &GoodmanHP::dropDefrostRequest },
+    { DefrostPhase::ANY_REQUESTED,  DefrostTrigger::ABORT,   0,                                DefrostPhase::NONE,           &GoodmanHP::abortDefrost },
+
+    { DefrostPhase::ANY_ENTRY,      DefrostTrigger::Y_DROP,  0,                                DefrostPhase::PENDING,        &GoodmanHP::shutdownForYDrop },
+    { DefrostPhase::ANY_ENTRY,      DefrostTrigger::TICK,    COND_Y_INACTIVE,                  DefrostPhase::PENDING,        &GoodmanHP::shutdownForYLost },
+
+    { DefrostPhase::ANY_RUNNING,    DefrostTrigger::TICK,    COND_DONE | COND_Y_ACTIVE,        DefrostPhase::EXIT_EQUALIZE,  &GoodmanHP::beginDefrostExit },
+    { DefrostPhase::ANY_RUNNING,    DefrostTrigger::TICK,    COND_DONE | COND_Y_INACTIVE,      DefrostPhase::NONE,           &GoodmanHP::endDefrost },
+
+    { DefrostPhase::ANY_EXIT,       DefrostTrigger::Y_DROP,  0,                                DefrostPhase::NONE,           &GoodmanHP::cancelDefrostExit },
+    { DefrostPhase::ANY_EXIT,       DefrostTrigger::TICK,    COND_Y_INACTIVE,                  DefrostPhase::NONE,           &GoodmanHP::shutdownForYLost },
+    { DefrostPhase::ANY_EXIT,       DefrostTrigger::ABORT,   0,                                DefrostPhase::NONE,           &GoodmanHP::abortDefrost },
+};
+
+constexpr uint8_t GoodmanHP::DEFROST_ROW_COUNT = sizeof(DEFROST_TRANSITIONS) / sizeof(DEFROST_TRANSITIONS[0]);
+
+// Compile-time table helpers (C++11 constexpr: single-expression recursion)
+constexpr uint8_t GoodmanHP::defrostRowsBefore(uint8_t node, uint8_t row) {
+    return row >= DEFROST_ROW_COUNT ? 0
+         : (uint8_t)(((uint8_t)DEFROST_TRANSITIONS[row].from < node ? 1 : 0) + defrostRowsBefore(node, row + 1));
+}
+
+constexpr uint16_t GoodmanHP::defrostAncestry(uint8_t node) {
+    return node >= (uint8_t)DefrostPhase::NODE_COUNT ? 0
+         : (uint16_t)((1u << node) | defrostAncestry((uint8_t)DEFROST_NODES[node].parent));
+}
+
+// Rows sorted by source, targets are leaves, guards known and consistent, and
+// COND_SETTLED only on leaves that have a settle time
+constexpr bool GoodmanHP::defrostRowsValid(uint8_t row) {
+    return row >= DEFROST_ROW_COUNT ||
+           ((uint8_t)DEFROST_TRANSITIONS[row].from < (uint8_t)DefrostPhase::NODE_COUNT &&
+            (uint8_t)DEFROST_TRANSITIONS[row].to < (uint8_t)DefrostPhase::COUNT &&
+            (row == 0 || DEFROST_TRANSITIONS[row - 1].from <= DEFROST_TRANSITIONS[row].from) &&
+            (DEFROST_TRANSITIONS[row].guards & ~COND_ALL) == 0 &&
+            (DEFROST_TRANSITIONS[row].guards & (COND_Y_ACTIVE | COND_Y_INACTIVE)) != (COND_Y_ACTIVE | COND_Y_INACTIVE) &&
+            (!(DEFROST_TRANSITIONS[row].guards & COND_SETTLED) ||
+             ((uint8_t)DEFROST_TRANSITIONS[row].from < (uint8_t)DefrostPhase::COUNT &&
+              DEFROST_NODES[(uint8_t)DEFROST_TRANSITIONS[row].from].settleMs != nullptr)) &&
+            defrostRowsValid(row + 1));
+}
+
+// Parents are superstates, listed before any superstate they contain (so no
+// cycles), and every leaf but NONE has a way out through its own rows or a
+// superstate's
+constexpr bool GoodmanHP::defrostNodesValid(uint8_t node) {
+    return node >= (uint8_t)DefrostPhase::NODE_COUNT ||
+           ((DEFROST_NODES[node].parent == DefrostPhase::NODE_COUNT ||
+             (DEFROST_NODES[node].parent >= DefrostPhase::COUNT &&
+              (node < (uint8_t)DefrostPhase::COUNT || DEFROST_NODES[node].parent < (DefrostPhase)node))) &&
+            (node == (uint8_t)DefrostPhase::NONE || node >= (uint8_t)DefrostPhase::COUNT ||
+             defrostRowsBefore(node + 1) > defrostRowsBefore(node) ||
+             (defrostAncestry(node) & ~(1u << node)) != 0) &&
+            defrostNodesValid(node + 1));
+}
+
+// First row of each node; node N's rows are [START[N], START[N + 1])
+constexpr uint8_t GoodmanHP::DEFROST_ROW_START[] = {
+    defrostRowsBefore(0), defrostRowsBefore(1), defrostRowsBefore(2), defrostRowsBefore(3),
+    defrostRowsBefore(4), defrostRowsBefore(5), defrostRowsBefore(6), defrostRowsBefore(7),
+    defrostRowsBefore(8), defrostRowsBefore(9), defrostRowsBefore(10), defrostRowsBefore(11),
+    defrostRowsBefore(12)
+};
+
+// Bit per node for each leaf phase: itself and all of its superstates
+constexpr uint16_t GoodmanHP::DEFROST_ANCESTRY[] = {
+    defrostAncestry(0), defrostAncestry(1), defrostAncestry(2), defrostAncestry(3),
+    defrostAncestry(4), defrostAncestry(5), defrostAncestry(6), defrostAncestry(7)
+};
 
 GoodmanHP::GoodmanHP(Scheduler *ts)
     : _ts(ts)
-    , _sensors(nullptr)
+    , _inputs()
+    , _outputs()
+    , _tempSensors()
+    , _tempSensorsDirty(false)
+    , _inputLatch(0)
+    , _inputGeneration(0)
     , _state(State::OFF)
     , _yActiveStartTick(0)
     , _yWasActive(false)
     , _cntActivated(false)
     , _cntShortCycleMs(DEFAULT_CNT_SHORT_CYCLE_MS)
+    , _cntMinOffStale(false)
     , _defrostMinRuntimeMs(DEFROST_MIN_RUNTIME_MS)
-    , _defrostExitTempF(DEFROST_EXIT_F)
+    , _defrostExit(toDeciF(DEFROST_EXIT_F))
     , _heatRuntimeThresholdMs(HEAT_RUNTIME_THRESHOLD_MS)
     , _heatRuntimeMs(0)
     , _heatRuntimeLastTick(0)
     , _heatRuntimeLastLogMs(0)
-    , _softwareDefrost(false)
+    , _defrostPhase(DefrostPhase::NONE)
     , _defrostStartTick(0)
-    , _defrostLastCondCheckTick(0)
-    , _lpsFault(false)
-    , _lowTemp(false)
-    , _lowTempThreshold(DEFAULT_LOW_TEMP_F)
-    , _compressorOverTemp(false)
-    , _compressorOverTempStartTick(0)
-    , _compressorOverTempLastCheckTick(0)
-    , _suctionLowTemp(false)
-    , _suctionLowTempStartTick(0)
-    , _suctionLowTempLastCheckTick(0)
+    , _defrostDone(false)
+    , _lowTemp(toDeciF(DEFAULT_LOW_TEMP_F))
     , _rvFail(false)
-    , _highSuctionTemp(false)
-    , _highSuctionTempThreshold(DEFAULT_HIGH_SUCTION_TEMP_F)
+    , _highSuctionTemp(toDeciF(DEFAULT_HIGH_SUCTION_TEMP_F))
     , _rvShortCycleMs(DEFAULT_RV_SHORT_CYCLE_MS)
-    , _defrostTransition(false)
-    , _defrostTransitionStart(0)
-    , _defrostCntPending(false)
-    , _defrostCntPendingStart(0)
-    , _defrostExiting(false)
     , _manualOverride(false)
-    , _manualOverrideStart(0)
     , _startupLockout(true)
-    , _startupTick(0)
+    , _isrUpdateRequest(false)
+    , _updateCount(0)
+    , _timerMux(portMUX_INITIALIZER_UNLOCKED)
+    , _outputTimers(ts)
+    , _acquisition(ts)
+    , _sensorThresholds()
+    , _outTxn()
+    , _commands()
+    , _commandHead(0)
+    , _commandCount(0)
+    , _commandMux(portMUX_INITIALIZER_UNLOCKED)
+    , _snapshots()
+    , _snapshotGen(0)
+    , _protection()
+    , _faultMask(0)
+    , _cntHoldMask(0)
 {
-    _instance = this;
-    _tskUpdate = new Task(500, TASK_FOREVER, [this]() {
+    static_assert(sizeof(PROTECTION_RULES) / sizeof(PROTECTION_RULES[0]) == (size_t)ProtectionId::COUNT,
+                  "PROTECTION_RULES out of sync with ProtectionId");
+    for (const ProtectionRule& rule : PROTECTION_RULES) {
+        if (rule.tripActions & ACT_CNT_OFF) _cntHoldMask |= protectionBit(rule.id);
+    }
+    for (uint8_t& count : _sensorThresholdCount) count = 0xFF;
+    _tskUpdate = new Task(UPDATE_BACKSTOP_MS, TASK_FOREVER, [this]() {
         this->update();
-    }, ts, false);
-    _tskCheckTemps = new Task(10 * TASK_SECOND, TASK_FOREVER, [this]() {
-        if (_sensors != nullptr) {
-            _sensors->requestTemperatures();
-        }
-        for (auto& mp : _tempSensorMap) {
-            if (mp.second == nullptr) continue;
-            mp.second->update(_sensors);
-        }
+        this->scheduleNextUpdate();
     }, ts, false);
 }
 
 void GoodmanHP::setDallasTemperature(DallasTemperature *sensors) {
-    _sensors = sensors;
+    _acquisition.setDallasTemperature(sensors);
+}
+
+void GoodmanHP::setTempSensorAlertPin(TempSensor *sensor, uint8_t gpio) {
+    _acquisition.setAlertPin(sensor, gpio);
+}
+
+void GoodmanHP::setUpdateTaskEnabled(bool enabled) {
+    if (enabled) {
+        _tskUpdate->enableIfNot();
+    } else {
+        _tskUpdate->disable();
+    }
+}
+
+// Only the slotted sensors feed the controller, so only they are traced
+void GoodmanHP::traceTempSample(TempSensor* sensor) {
+    if (!Trace.isEnabled()) return;
+    for (uint8_t i = 0; i < (uint8_t)SensorId::COUNT; i++) {
+        if (getTempSensor((SensorId)i) != sensor) continue;
+        Trace.recordDeciF(TraceEvent::TEMP_SAMPLE, i, sensor->getDeciF(), sensor->isValid());
+        return;
+    }
 }
 
 void GoodmanHP::begin() {
-    // Ensure all outputs are OFF on startup and verify via digital read
+    // Ensure all outputs are OFF on startup and verify via the output latch
     for (auto& pair : _outputMap) {
         if (pair.second != nullptr) {
             pair.second->turnOff();
@@ -78,24 +293,298 @@ void GoodmanHP::begin() {
     _cntActivated = false;
 
     _startupLockout = true;
-    _startupTick = millis();
-
+    armTimer(TimerId::STARTUP_LOCKOUT, millis(), STARTUP_LOCKOUT_MS);
+
+    // Initial conditions for replay: levels and readings that produced no edge/change yet
+    latchInputs();
+    Trace.record(TraceEvent::BEGIN, 0, 0);
+    for (uint8_t i = 0; i < (uint8_t)InputId::COUNT; i++) {
+        InputPin* pin = _inputs[i];
+        if (pin != nullptr) Trace.record(TraceEvent::INPUT_EDGE, pin->getPin(), isInputActive((InputId)i) ? HIGH : LOW);
+    }
+    for (uint8_t i = 0; i < (uint8_t)SensorId::COUNT; i++) {
+        TempSensor* sensor = getTempSensor((SensorId)i);
+        if (sensor != nullptr) traceTempSample(sensor);
+    }
+    publishSnapshot();
     _tskUpdate->enable();
-    _tskCheckTemps->enable();
+    // Sensors are fixed from here on: the acquisition task walks its own table
+    for (auto& pair : _tempSensorMap) {
+        int slot = slotIndex(SENSOR_NAMES, pair.first);
+        _acquisition.addSensor(pair.second, slot >= 0 ? (uint8_t)slot : SensorAcquisition::NO_TRACE_ID);
+    }
+    _acquisition.begin();
     Log.info("HP", "GoodmanHP controller started, all outputs verified OFF, %lu sec startup lockout",
              STARTUP_LOCKOUT_MS / 1000UL);
 }
 
+void GoodmanHP::requestUpdate() {
+    if (_tskUpdate->isEnabled()) _tskUpdate->forceNextIteration();
+}
+
+void IRAM_ATTR GoodmanHP::requestUpdateFromISR() {
+    _isrUpdateRequest = true;
+}
+
+void GoodmanHP::serviceUpdateRequests() {
+    // Re-evaluate protections against new readings now, not at the next tick
+    bool tempsChanged = _acquisition.serviceChanges();
+    if (!_isrUpdateRequest && !tempsChanged) return;
+    _isrUpdateRequest = false;
+    serviceCommands();
+    requestUpdate();
+}
+
+uint32_t GoodmanHP::getUpdateCount() const {
+    return _updateCount;
+}
+
+// Seqlock writer: only ever called from the scheduler (loop) task. Writes go to
+// the buffer readers are not pointed at; the generation flip publishes it.
+void GoodmanHP::publishSnapshot() {
+    State lastState = _snapshots[_snapshotGen & 1].data.state;
+    if (_state != lastState) Trace.record(TraceEvent::STATE, (uint8_t)0, (uint32_t)_state, (uint32_t)lastState);
+
+    uint32_t gen = _snapshotGen + 1;
+    SnapshotBuffer& buf = _snapshots[gen & 1];
+    buf.seq = buf.seq + 1;  // Odd: write in progress
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    Snapshot& snap = buf.data;
+    uint32_t now = millis();
+    snap.generation = gen;
+    snap.publishedMs = now;
+    snap.state = _state;
+
+    snap.inputPresent = 0;
+    snap.inputActive = _inputLatch;
+    snap.inputGeneration = _inputGeneration;
+    snap.inputAccountOn = 0;
+    uint32_t inputStatsVersion = 0;
+    for (uint8_t i = 0; i < (uint8_t)InputId::COUNT; i++) {
+        InputPin* pin = _inputs[i];
+        snap.inputPin[i] = pin != nullptr ? pin->getPin() : 0;
+        if (pin == nullptr) continue;
+        snap.inputPresent |= 1 << i;
+        if (pin->getValue()) snap.inputAccountOn |= 1 << i;
+        inputStatsVersion += pin->getStatsVersion();
+    }
+    if (inputStatsVersion != buf.inputStatsVersion || gen <= 2) {
+        for (uint8_t i = 0; i < (uint8_t)InputId::COUNT; i++) {
+            InputPin* pin = _inputs[i];
+            if (pin != nullptr) {
+                snap.inputStats[i] = pin->getRawStats();
+                snap.inputChangeMs[i] = pin->getStatsChangeTick();
+            } else {
+                memset(&snap.inputStats[i], 0, sizeof(InputPinStats));
+                snap.inputChangeMs[i] = now;
+            }
+        }
+        buf.inputStatsVersion = inputStatsVersion;
+    }
+    snap.outputPresent = 0;
+    snap.outputOn = 0;
+    snap.outputAccountOn = 0;
+    uint32_t statsVersion = 0;
+    for (uint8_t i = 0; i < (uint8_t)OutputId::COUNT; i++) {
+        OutPin* pin = _outputs[i];
+        snap.outputPin[i] = pin != nullptr ? pin->getPin() : -1;
+        snap.cyclesLastHour[i] = pin != nullptr ? pin->getCyclesLastHour() : 0;
+        if (pin == nullptr) continue;
+        snap.outputPresent |= 1 << i;
+        if (pin->isPinOn()) snap.outputOn |= 1 << i;
+        if (pin->isStatsOn()) snap.outputAccountOn |= 1 << i;
+        statsVersion += pin->getStatsVersion();
+    }
+    // Stats only move on transitions; skip the copy on the common idle pass
+    if (statsVersion != buf.statsVersion || gen <= 2) {
+        for (uint8_t i = 0; i < (uint8_t)OutputId::COUNT; i++) {
+            OutPin* pin = _outputs[i];
+            if (pin != nullptr) {
+                snap.outputStats[i] = pin->getRawStats();
+                snap.outputChangeMs[i] = pin->getStatsChangeTick();
+            } else {
+                memset(&snap.outputStats[i], 0, sizeof(OutPinStats));
+                snap.outputChangeMs[i] = now;
+            }
+        }
+        buf.statsVersion = statsVersion;
+    }
+
+    snap.faultMask = _faultMask;
+    snap.softwareDefrost = isSoftwareDefrostActive();
+    snap.defrostPhase = _defrostPhase;
+    snap.rvFail = _rvFail;
+    snap.startupLockout = _startupLockout;
+    snap.shortCycleProtection = isShortCycleProtectionActive();
+    snap.defrostTransition = isDefrostTransitionActive();
+    snap.defrostCntPending = isDefrostCntPendingActive();
+    snap.defrostExiting = isDefrostExitingActive();
+    snap.manualOverride = _manualOverride;
+    snap.heatRuntimeMs = _heatRuntimeMs;
+    snap.startupLockoutRemainMs = getStartupLockoutRemainingMs();
+    snap.defrostTransitionRemainMs = getDefrostTransitionRemainingMs();
+    snap.defrostCntPendingRemainMs = getDefrostCntPendingRemainingMs();
+    snap.manualOverrideRemainMs = getManualOverrideRemainingMs();
+    snap.cntShortCycleRemainMs = cntShortCycleRemainingMs();
+
+    snap.tempCount = 0;
+    for (const auto& m : _tempSensorMap) {
+        if (snap.tempCount >= SNAPSHOT_MAX_TEMPS) break;
+        if (m.second == nullptr || !m.second->isValid()) continue;
+        strlcpy(snap.temps[snap.tempCount].name, m.first.c_str(), SNAPSHOT_NAME_LEN);
+        snap.temps[snap.tempCount].deciF = m.second->getDeciF();
+        snap.tempCount++;
+    }
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    buf.seq = buf.seq + 1;  // Even: stable
+    __atomic_store_n(&_snapshotGen, gen, __ATOMIC_RELEASE);
+}
+
+// Seqlock reader: retries only if a second publish lands in the buffer being
+// copied, which needs two update() passes during one memcpy.
+void GoodmanHP::readSnapshot(Snapshot& out) const {
+    for (;;) {
+        uint32_t gen = __atomic_load_n(&_snapshotGen, __ATOMIC_ACQUIRE);
+        const SnapshotBuffer& buf = _snapshots[gen & 1];
+        uint32_t seq = buf.seq;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (seq & 1) continue;
+        memcpy(&out, (const void*)&buf.data, sizeof(Snapshot));
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (buf.seq == seq) return;
+    }
+}
+
+const char* GoodmanHP::getInputName(InputId id) {
+    return id < InputId::COUNT ? INPUT_NAMES[(uint8_t)id] : "";
+}
+
+const char* GoodmanHP::getOutputName(OutputId id) {
+    return id < OutputId::COUNT ? OUTPUT_NAMES[(uint8_t)id] : "";
+}
+
+void GoodmanHP::armTimer(TimerId id, uint32_t now, uint32_t ms) {
+    portENTER_CRITICAL_SAFE(&_timerMux);
+    _timers.arm((uint8_t)id, now, ms);
+    portEXIT_CRITICAL_SAFE(&_timerMux);
+}
+
+void GoodmanHP::cancelTimer(TimerId id) {
+    portENTER_CRITICAL_SAFE(&_timerMux);
+    _timers.cancel((uint8_t)id);
+    portEXIT_CRITICAL_SAFE(&_timerMux);
+}
+
+uint32_t GoodmanHP::timerRemainingMs(TimerId id) const {
+    uint32_t now = millis();
+    portENTER_CRITICAL_SAFE(&_timerMux);
+    uint32_t remaining = _timers.remainingMs((uint8_t)id, now);
+    portEXIT_CRITICAL_SAFE(&_timerMux);
+    return remaining;
+}
+
+// Keeps the original start: moves the deadline by the change in duration
+void GoodmanHP::retimeTimer(TimerId id, uint32_t oldMs, uint32_t newMs) {
+    portENTER_CRITICAL_SAFE(&_timerMux);
+    if (_timers.isArmed((uint8_t)id)) {
+        _timers.armAt((uint8_t)id, _timers.deadline((uint8_t)id) - oldMs + newMs);
+    }
+    portEXIT_CRITICAL_SAFE(&_timerMux);
+}
+
+void GoodmanHP::expireTimers() {
+    uint32_t now = millis();
+    portENTER_CRITICAL_SAFE(&_timerMux);
+    _timers.expire(now);
+    portEXIT_CRITICAL_SAFE(&_timerMux);
+}
+
+// Milliseconds until the earliest timer update() is waiting on, capped at the
+// backstop. Deadlines already due were handled by the update() just run.
+uint32_t GoodmanHP::nextDeadlineMs() {
+    uint32_t now = millis();
+    portENTER_CRITICAL_SAFE(&_timerMux);
+    uint32_t next = _timers.nextMs(now, UPDATE_BACKSTOP_MS);
+    portEXIT_CRITICAL_SAFE(&_timerMux);
+    if (_startupLockout || _manualOverride) return next;
+
+    auto consider = [&next, now](uint32_t startTick, uint32_t durationMs) {
+        uint32_t elapsed = now - startTick;
+        if (elapsed >= durationMs) return;
+        if (durationMs - elapsed < next) next = durationMs - elapsed;
+    };
+
+    // CNT off window (tracked by the OutPin, not a controller timer)
+    if (_yWasActive && !_cntActivated) {
+        OutPin* cnt = getOutput(OutputId::CNT);
+        if (cnt != nullptr && cnt->getOffTick() > 0) {
+            consider(cnt->getOffTick(), 5UL * 60 * 1000);
+            // The commitOutputs() guard ends with CNT's minimum off timer, which wakes update()
+        }
+    }
+
+    // Heat runtime reaching the defrost threshold
+    if (_state == State::HEAT && !isSoftwareDefrostActive() && _heatRuntimeMs < _heatRuntimeThresholdMs) {
+        OutPin* cnt = getOutput(OutputId::CNT);
+        if (cnt != nullptr && cnt->isOn() && isDFTActive()) {
+            uint32_t remaining = _heatRuntimeThresholdMs - _heatRuntimeMs;
+            if (remaining < next) next = remaining;
+        }
+    }
+    return next;
+}
+
+void GoodmanHP::scheduleNextUpdate() {
+    uint32_t wait = nextDeadlineMs();
+    if (wait < UPDATE_BACKSTOP_MS) {
+        _tskUpdate->delay(wait > 0 ? wait : 1);
+    }
+}
+
 void GoodmanHP::addInput(const String& name, InputPin* pin) {
+    int slot = slotIndex(INPUT_NAMES, name);
+    if (slot >= 0) {
+        addInput((InputId)slot, pin);
+        return;
+    }
     _inputMap[name] = pin;
     pin->initPin();
 }
 
+void GoodmanHP::addInput(InputId id, InputPin* pin) {
+    _inputMap[INPUT_NAMES[(uint8_t)id]] = pin;
+    _inputs[(uint8_t)id] = pin;
+    Trace.record(TraceEvent::PIN_MAP, pin->getPin(), (uint32_t)TracePinKind::IN, (uint32_t)id);
+    pin->initPin();
+}
+
 void GoodmanHP::addOutput(const String& name, OutPin* pin) {
+    int slot = slotIndex(OUTPUT_NAMES, name);
+    if (slot >= 0) {
+        addOutput((OutputId)slot, pin);
+        return;
+    }
     _outputMap[name] = pin;
+    pin->attachTimers(&_outputTimers);
+    pin->initPin();
+    pin->setRuntimeCallback([this](OutPin* p, uint32_t onDuration) { return handleOutPinRuntime(p, onDuration); });
+}
+
+void GoodmanHP::addOutput(OutputId id, OutPin* pin) {
+    _outputMap[OUTPUT_NAMES[(uint8_t)id]] = pin;
+    _outputs[(uint8_t)id] = pin;
+    Trace.record(TraceEvent::PIN_MAP, pin->getPin(), (uint32_t)TracePinKind::OUT, (uint32_t)id);
+    pin->attachTimers(&_outputTimers);
+    if (id == OutputId::CNT) {
+        // Short cycle guard: CNT stays off this long, then update() retries a blocked start
+        pin->setMinOffMs(_cntShortCycleMs);
+        pin->setMinOffCallback([this](OutPin*) { requestUpdate(); });
+    }
     pin->initPin();
     // Set runtime callback so GoodmanHP can respond to OutPin events
-    pin->setRuntimeCallback(outPinRuntimeCallback);
+    pin->setRuntimeCallback([this](OutPin* p, uint32_t onDuration) { return handleOutPinRuntime(p, onDuration); });
 }
 
 InputPin* GoodmanHP::getInput(const String& name) {
@@ -124,6 +613,8 @@ std::map<String, OutPin*>& GoodmanHP::getOutputMap() {
 
 void GoodmanHP::addTempSensor(const String& name, TempSensor* sensor) {
     _tempSensorMap[name] = sensor;
+    int slot = slotIndex(SENSOR_NAMES, name);
+    if (slot >= 0) _tempSensors[slot] = sensor;
 }
 
 TempSensor* GoodmanHP::getTempSensor(const String& name) {
@@ -134,10 +625,24 @@ TempSensor* GoodmanHP::getTempSensor(const String& name) {
     return nullptr;
 }
 
-TempSensorMap& GoodmanHP::getTempSensorMap() {
+TempSensor* GoodmanHP::getTempSensor(SensorId id) {
+    if (_tempSensorsDirty) resolveTempSensors();
+    return _tempSensors[(uint8_t)id];
+}
+
+TempSensorMap& GoodmanHP::editTempSensorMap() {
+    _tempSensorsDirty = true;
     return _tempSensorMap;
 }
 
+void GoodmanHP::resolveTempSensors() {
+    for (uint8_t i = 0; i < (uint8_t)SensorId::COUNT; i++) {
+        auto it = _tempSensorMap.find(SENSOR_NAMES[i]);
+        _tempSensors[i] = (it != _tempSensorMap.end()) ? it->second : nullptr;
+    }
+    _tempSensorsDirty = false;
+}
+
 void GoodmanHP::clearTempSensors() {
     for (auto& pair : _tempSensorMap) {
         if (pair.second != nullptr) {
@@ -145,354 +650,470 @@ void GoodmanHP::clearTempSensors() {
         }
     }
     _tempSensorMap.clear();
+    for (auto& sensor : _tempSensors) sensor = nullptr;
+    _tempSensorsDirty = false;
 }
 
 void GoodmanHP::update() {
+    _updateCount++;
+    Trace.record(TraceEvent::UPDATE, 0, _updateCount);
+    latchInputs();
+    if (_cntMinOffStale) {
+        _cntMinOffStale = false;
+        OutPin* cnt = getOutput(OutputId::CNT);
+        if (cnt != nullptr) cnt->setMinOffMs(_cntShortCycleMs);
+    }
+    beginOutputs();
+    runControlLoop();
+    commitOutputs();
+    pushSensorThresholds();
+    publishSnapshot();
+}
+
+// The one place the controller samples its inputs; everything else in the
+// pass (and the snapshot it publishes) reads _inputLatch
+void GoodmanHP::latchInputs() {
+    uint8_t active = 0;
+    for (uint8_t i = 0; i < (uint8_t)InputId::COUNT; i++) {
+        if (_inputs[i] != nullptr && _inputs[i]->isActive()) active |= 1 << i;
+    }
+    if (active != _inputLatch) {
+        _inputLatch = active;
+        _inputGeneration++;
+    }
+}
+
+void GoodmanHP::runControlLoop() {
+    expireTimers();
+
     // Startup lockout: keep all outputs OFF until sensors have stabilized
     if (_startupLockout) {
-        if (millis() - _startupTick >= STARTUP_LOCKOUT_MS) {
-            _startupLockout = false;
-            Log.info("HP", "Startup lockout complete, enabling output control");
-        } else {
-            return;
-        }
+        if (isTimerArmed(TimerId::STARTUP_LOCKOUT)) return;
+        _startupLockout = false;
+        Log.info("HP", "Startup lockout complete, enabling output control");
     }
 
     // Manual override: skip state machine, only check timeout
     if (_manualOverride) {
-        if (millis() - _manualOverrideStart >= MANUAL_OVERRIDE_TIMEOUT_MS) {
+        if (!isTimerArmed(TimerId::MANUAL_OVERRIDE)) {
             Log.warn("HP", "Manual override timeout (30 min), disabling");
-            setManualOverride(false);
+            applyManualOverride(false);
         }
+        // Protections are not evaluated; none may carry a confirmation past the override
+        for (const ProtectionRule& rule : PROTECTION_RULES) confirmCondition(rule, false, millis());
         return;
     }
 
-    checkCompressorTemp();
-    checkSuctionTemp();
-    checkHighSuctionTemp();
-    checkLPSFault();
-    checkAmbientTemp();
+    evaluateProtections();
     checkYAndActivateCNT();
     accumulateHeatRuntime();
     updateState();
-    checkDefrostNeeded();
+    updateDefrost();
 }
 
-void GoodmanHP::checkLPSFault() {
-    // Don't override compressor overtemp
-    if (_compressorOverTemp) return;
+uint16_t GoodmanHP::currentScope() const {
+    uint16_t scope = 1 << (uint8_t)_state;
+    if (inDefrost(DefrostPhase::ANY_RUNNING)) scope |= SCOPE_DEFROST_ACTIVE;
+    return scope;
+}
 
-    if (!isLPSActive() && !_lpsFault) {
-        _lpsFault = true;
-        State oldState = _state;
-        _state = State::ERROR;
-        Log.error("HP", "LPS fault: low refrigerant pressure detected");
-        OutPin* cnt = getOutput("CNT");
-        if (cnt != nullptr && cnt->isOn()) {
-            cnt->turnOff();
-            _cntActivated = false;
-            Log.error("HP", "CNT shut down due to LPS fault");
-        }
-        // Turn on W if in HEAT mode (Y active, O not active)
-        OutPin* w = getOutput("W");
-        if (w != nullptr && isYActive() && !isOActive()) {
-            w->turnOn();
-            Log.info("HP", "W turned ON for ERROR state (HEAT mode)");
-        }
-        if (_lpsFaultCb) _lpsFaultCb(true);
-        if (_stateChangeCb) _stateChangeCb(State::ERROR, oldState);
-    } else if (isLPSActive() && _lpsFault) {
-        _lpsFault = false;
-        Log.info("HP", "LPS fault cleared: pressure restored");
-        // Turn off W that was enabled during ERROR
-        OutPin* w = getOutput("W");
-        if (w != nullptr && w->isOn()) {
-            w->turnOff();
-            Log.info("HP", "W turned OFF (LPS fault cleared)");
-        }
-        // Reset Y active start so short-cycle protection applies from recovery
-        if (_yWasActive) {
-            _yActiveStartTick = millis();
+void GoodmanHP::readProtectionSnapshot(ProtectionSnapshot& snap) {
+    snap.validMask = 0;
+    for (uint8_t i = 0; i < sizeof(SOURCE_SENSORS) / sizeof(SOURCE_SENSORS[0]); i++) {
+        TempSensor* sensor = getTempSensor(SOURCE_SENSORS[i]);
+        if (sensor == nullptr || !sensor->isValid()) continue;
+        snap.value[i] = sensor->getDeciF();
+        snap.validMask |= 1 << i;
+    }
+    snap.value[(uint8_t)ProtectionSource::LPS_INPUT] = isLPSActive() ? toDeciF(1.0f) : 0;
+    snap.validMask |= 1 << (uint8_t)ProtectionSource::LPS_INPUT;
+}
+
+// Hands each sensor's live thresholds to the acquisition task, which samples
+// a sensor faster the closer it gets to one: trip (and warn) points of the
+// rules in scope, the clear point of a tripped rule, and the defrost exit
+// temperature while defrost runs. Only changed lists are pushed.
+void GoodmanHP::pushSensorThresholds() {
+    DeciF thresholds[(uint8_t)SensorId::COUNT][SensorAcquisition::MAX_THRESHOLDS];
+    uint8_t counts[(uint8_t)SensorId::COUNT] = {};
+    auto add = [&](SensorId id, DeciF t) {
+        uint8_t i = (uint8_t)id;
+        if (counts[i] < SensorAcquisition::MAX_THRESHOLDS) thresholds[i][counts[i]++] = t;
+    };
+
+    uint16_t scope = currentScope();
+    for (const ProtectionRule& rule : PROTECTION_RULES) {
+        if (rule.source == ProtectionSource::LPS_INPUT) continue;
+        SensorId id = SOURCE_SENSORS[(uint8_t)rule.source];
+        if (isTripped(rule.id)) {
+            if (!(rule.flags & FLAG_NO_AUTO_CLEAR)) add(id, clearThreshold(rule));
+        } else if (scope & rule.scope) {
+            add(id, rule.tripRef ? this->*rule.tripRef : rule.trip);
+            if (rule.warn != DECIF_NONE) add(id, rule.warn);
         }
-        if (_lpsFaultCb) _lpsFaultCb(false);
-        // Don't set _state here — let updateState() determine the correct state
+    }
+    if (inDefrost(DefrostPhase::ANY_RUNNING)) add(SensorId::CONDENSER, _defrostExit);
+
+    for (uint8_t i = 0; i < (uint8_t)SensorId::COUNT; i++) {
+        if (counts[i] == _sensorThresholdCount[i] &&
+            memcmp(thresholds[i], _sensorThresholds[i], counts[i] * sizeof(DeciF)) == 0) continue;
+        memcpy(_sensorThresholds[i], thresholds[i], counts[i] * sizeof(DeciF));
+        _sensorThresholdCount[i] = counts[i];
+        TempSensor* sensor = getTempSensor((SensorId)i);
+        if (sensor != nullptr) _acquisition.setThresholds(sensor, thresholds[i], counts[i]);
     }
 }
 
-void GoodmanHP::checkAmbientTemp() {
-    // Don't override higher-priority faults
-    if (_compressorOverTemp || _lpsFault) return;
+void GoodmanHP::evaluateProtections() {
+    ProtectionSnapshot snap;
+    readProtectionSnapshot(snap);
+    uint32_t now = millis();
+    for (const ProtectionRule& rule : PROTECTION_RULES) {
+        evaluateRule(rule, snap, now);
+    }
+}
 
-    TempSensor* ambient = getTempSensor("AMBIENT_TEMP");
-    if (ambient == nullptr || !ambient->isValid()) return;
+void GoodmanHP::evaluateRule(const ProtectionRule& rule, const ProtectionSnapshot& snap, uint32_t now) {
+    if (_faultMask & rule.inhibitMask) {
+        confirmCondition(rule, false, now);
+        return;
+    }
 
-    float temp = ambient->getValue();
+    bool tripped = isTripped(rule.id);
+    uint16_t scope = currentScope();
 
-    if (temp < _lowTempThreshold && !_lowTemp) {
-        _lowTemp = true;
-        State oldState = _state;
-        _state = State::LOW_TEMP;
-        Log.warn("HP", "Low ambient temp %.1fF < %.1fF threshold, entering LOW_TEMP state",
-                 temp, _lowTempThreshold);
-
-        // Shut down CNT if running
-        OutPin* cnt = getOutput("CNT");
-        if (cnt != nullptr && cnt->isOn()) {
-            cnt->turnOff();
-            _cntActivated = false;
-            Log.warn("HP", "CNT shut down due to low ambient temp");
+    if (tripped) {
+        if (rule.flags & FLAG_NO_AUTO_CLEAR) return;
+        if (!(scope & rule.holdScope)) {
+            confirmCondition(rule, false, now);
+            clearProtection(rule, "out of scope", now);
+            return;
         }
+    } else if (!(scope & rule.scope)) {
+        confirmCondition(rule, false, now);
+        return;
+    }
 
-        // Turn off FAN and RV
-        OutPin* fan = getOutput("FAN");
-        if (fan != nullptr) fan->turnOff();
-        OutPin* rv = getOutput("RV");
-        if (rv != nullptr) rv->turnOff();
-
-        // Turn on W (auxiliary heat) only if not in COOL mode (O+Y)
-        OutPin* w = getOutput("W");
-        if (w != nullptr && !isOActive()) {
-            w->turnOn();
-            Log.info("HP", "W turned ON for LOW_TEMP mode");
-        }
+    if (rule.recheckMs > 0) {
+        if (isTimerArmed(recheckTimer(rule.id))) return;
+        armTimer(recheckTimer(rule.id), now, rule.recheckMs);
+    }
 
-        if (_stateChangeCb) _stateChangeCb(State::LOW_TEMP, oldState);
-    } else if (temp < _lowTempThreshold && _lowTemp) {
-        // Already in LOW_TEMP — ensure W is off if switched to COOL mode (Y+O)
-        OutPin* w = getOutput("W");
-        if (w != nullptr && w->isOn() && isOActive()) {
-            w->turnOff();
-            Log.info("HP", "W turned OFF in LOW_TEMP (switched to COOL request)");
+    uint8_t source = (uint8_t)rule.source;
+    if (!(snap.validMask & (1 << source))) {
+        confirmCondition(rule, false, now);     // A gap in the readings starts confirmation over
+        return;
+    }
+    DeciF value = snap.value[source];
+    bool above = (rule.direction == TripDirection::ABOVE);
+
+    if (tripped) {
+        DeciF clear = clearThreshold(rule);
+        if (rule.recheckMs > 0) {
+            Log.info("HP", "%s recheck: %.1fF (recovery %s %.1fF)", rule.name, fromDeciF(value),
+                     above ? "<" : ">=", fromDeciF(clear));
+        }
+        bool cleared = confirmCondition(rule, above ? (value < clear) : (value >= clear), now);
+        if (cleared) {
+            char reason[48];
+            snprintf(reason, sizeof(reason), "%.1fF %s %.1fF", fromDeciF(value), above ? "<" : ">=", fromDeciF(clear));
+            clearProtection(rule, reason, now);
+        } else if (rule.holdActions) {
+            applyProtectionActions(rule.holdActions, rule);
         }
         return;
-    } else if (temp >= _lowTempThreshold && _lowTemp) {
-        _lowTemp = false;
-        Log.info("HP", "Ambient temp %.1fF >= %.1fF threshold, exiting LOW_TEMP state",
-                 temp, _lowTempThreshold);
+    }
 
-        // Turn off W
-        OutPin* w = getOutput("W");
-        if (w != nullptr) w->turnOff();
+    DeciF trip = rule.tripRef ? this->*rule.tripRef : rule.trip;
+    if (confirmCondition(rule, above ? (value >= trip) : (value < trip), now)) {
+        tripProtection(rule, value, trip, now);
+    } else if (rule.warn != DECIF_NONE && (above ? (value >= rule.warn) : (value < rule.warn))) {
+        Log.warn("HP", "%s warning: %.1fF %s %.1fF", rule.name, fromDeciF(value), above ? ">=" : "<",
+                 fromDeciF(rule.warn));
+    }
+}
 
-        // Don't set _state here — let updateState() determine the correct state
+// Debounces a rule's trip or clear condition over confirmMs: true once it
+// has held on every evaluation since the confirm timer was armed. The timer
+// wakes update() when it expires, so a steady condition is not left waiting
+// on the next reading.
+bool GoodmanHP::confirmCondition(const ProtectionRule& rule, bool holds, uint32_t now) {
+    ProtectionStatus& status = _protection[(uint8_t)rule.id];
+    if (!holds || rule.confirmMs == 0) {
+        if (status.confirming) {
+            cancelTimer(confirmTimer(rule.id));
+            status.confirming = false;
+        }
+        return holds;
     }
+    if (!status.confirming) {
+        status.confirming = true;
+        armTimer(confirmTimer(rule.id), now, rule.confirmMs);
+        return false;
+    }
+    if (isTimerArmed(confirmTimer(rule.id))) return false;
+    status.confirming = false;
+    return true;
 }
 
-void GoodmanHP::checkCompressorTemp() {
+// Recovery point of a tripped rule, clearBand past its clear threshold
+DeciF GoodmanHP::clearThreshold(const ProtectionRule& rule) const {
+    DeciF clear = rule.clearRef ? this->*rule.clearRef : rule.clear;
+    return rule.direction == TripDirection::ABOVE ? clear - rule.clearBand : clear + rule.clearBand;
+}
 
-    uint32_t now = millis();
+void GoodmanHP::tripProtection(const ProtectionRule& rule, DeciF value, DeciF threshold, uint32_t now) {
+    _faultMask |= protectionBit(rule.id);
+    Trace.recordDeciF(TraceEvent::PROTECTION, (uint8_t)rule.id, value, 1);
+    _protection[(uint8_t)rule.id].startTick = now;
 
-    // If already in overtemp, recheck every 1 minute for recovery
-    if (_compressorOverTemp) {
-        if (now - _compressorOverTempLastCheckTick < COMPRESSOR_OVERTEMP_CHECK_MS) return;
-        _compressorOverTempLastCheckTick = now;
+    State oldState = _state;
+    if (rule.flags & FLAG_ENTER_STATE) _state = rule.tripState;
 
-        TempSensor* comp = getTempSensor("COMPRESSOR_TEMP");
-        if (comp == nullptr || !comp->isValid()) return;
+    char msg[96];
+    if (rule.source == ProtectionSource::LPS_INPUT) {
+        snprintf(msg, sizeof(msg), "%s detected", rule.name);
+    } else {
+        snprintf(msg, sizeof(msg), "%s: %.1fF %s %.1fF", rule.name, fromDeciF(value),
+                 rule.direction == TripDirection::ABOVE ? ">=" : "<", fromDeciF(threshold));
+    }
+    if (rule.flags & FLAG_TRIP_WARN) {
+        Log.warn("HP", "%s, state %s", msg, getStateString());
+    } else {
+        Log.error("HP", "%s, state %s", msg, getStateString());
+    }
 
-        float temp = comp->getValue();
-        Log.info("HP", "Compressor overtemp recheck: %.1fF (recovery < %.1fF)", temp, COMPRESSOR_OVERTEMP_OFF_F);
+    applyProtectionActions(rule.tripActions, rule);
 
-        if (temp < COMPRESSOR_OVERTEMP_OFF_F) {
-            uint32_t elapsed = now - _compressorOverTempStartTick;
-            Log.warn("HP", "Compressor overtemp cleared: %.1fF < %.1fF, resolved in %lu min %lu sec",
-                     temp, COMPRESSOR_OVERTEMP_OFF_F, elapsed / 60000UL, (elapsed / 1000UL) % 60);
-            _compressorOverTemp = false;
-            if (_stateChangeCb) _stateChangeCb(_state, _state);
-        }
-        return;
-    }
+    if ((rule.flags & FLAG_LPS_CALLBACK) && _lpsFaultCb) _lpsFaultCb(true);
+    if (_stateChangeCb) _stateChangeCb(_state, oldState);
+}
 
-    // Only check every 1 minute for new overtemp condition
-    if (now - _compressorOverTempLastCheckTick < COMPRESSOR_OVERTEMP_CHECK_MS) return;
-    _compressorOverTempLastCheckTick = now;
+void GoodmanHP::clearProtection(const ProtectionRule& rule, const char* reason, uint32_t now) {
+    _faultMask &= ~protectionBit(rule.id);
+    Trace.record(TraceEvent::PROTECTION, (uint8_t)rule.id, 0, 0);
 
-    TempSensor* comp = getTempSensor("COMPRESSOR_TEMP");
-    if (comp == nullptr || !comp->isValid()) return;
+    uint32_t elapsed = now - _protection[(uint8_t)rule.id].startTick;
+    if (rule.flags & FLAG_CLEAR_INFO) {
+        Log.info("HP", "%s cleared: %s, resolved in %lu min %lu sec",
+                 rule.name, reason, elapsed / 60000UL, (elapsed / 1000UL) % 60);
+    } else {
+        Log.warn("HP", "%s cleared: %s, resolved in %lu min %lu sec",
+                 rule.name, reason, elapsed / 60000UL, (elapsed / 1000UL) % 60);
+    }
 
-    float temp = comp->getValue();
+    applyProtectionActions(rule.clearActions, rule);
 
-    if (temp >= COMPRESSOR_OVERTEMP_ON_F) {
-        _compressorOverTemp = true;
-        _compressorOverTempStartTick = now;
-        Log.error("HP", "Compressor overtemp: %.1fF >= %.1fF, shutting down CNT (FAN stays on)",
-                  temp, COMPRESSOR_OVERTEMP_ON_F);
+    if ((rule.flags & FLAG_LPS_CALLBACK) && _lpsFaultCb) _lpsFaultCb(false);
+    // State is left for updateState() to recompute
+    if ((rule.flags & FLAG_NOTIFY_CLEAR) && _stateChangeCb) _stateChangeCb(_state, _state);
+}
 
-        // Shut down CNT
-        OutPin* cnt = getOutput("CNT");
-        if (cnt != nullptr && cnt->isOn()) {
-            cnt->turnOff();
+void GoodmanHP::applyProtectionActions(uint16_t actions, const ProtectionRule& rule) {
+    if (actions & ACT_CNT_OFF) {
+        if (isOutputOn(OutputId::CNT)) {
+            setOutput(OutputId::CNT, false, rule.name);
             _cntActivated = false;
+            if (rule.flags & FLAG_TRIP_WARN) {
+                Log.warn("HP", "CNT shut down (%s)", rule.name);
+            } else {
+                Log.error("HP", "CNT shut down (%s)", rule.name);
+            }
         }
-
-        // Keep FAN on to cool the compressor
-        OutPin* fan = getOutput("FAN");
-        if (fan != nullptr && !fan->isOn()) {
-            fan->turnOn();
-            Log.info("HP", "FAN turned ON to cool compressor");
+    }
+    if ((actions & ACT_FAN_ON) && !isOutputOn(OutputId::FAN)) {
+        setOutput(OutputId::FAN, true, rule.name);
+    } else if (actions & ACT_FAN_OFF) {
+        setOutput(OutputId::FAN, false, rule.name);
+    }
+    if (actions & ACT_RV_OFF) setOutput(OutputId::RV, false, rule.name);
+    if (actions & (ACT_W_ON_HEAT | ACT_W_ON_NOT_COOL | ACT_W_OFF_IF_COOL | ACT_W_OFF)) {
+        bool oActive = isOActive();
+        if (((actions & ACT_W_ON_HEAT) && isYActive() && !oActive) ||
+            ((actions & ACT_W_ON_NOT_COOL) && !oActive)) {
+            setOutput(OutputId::W, true, rule.name);
+        } else if (isOutputOn(OutputId::W) && ((actions & ACT_W_OFF) || ((actions & ACT_W_OFF_IF_COOL) && oActive))) {
+            setOutput(OutputId::W, false, rule.name);
         }
-
-        if (_stateChangeCb) _stateChangeCb(_state, _state);
+    }
+    if (actions & ACT_LATCH_RV_FAIL) {
+        _rvFail = true;
+        Log.error("HP", "RV fail latched — CNT blocked until cleared via config page");
+    }
+    if (actions & ACT_STOP_DEFROST) dispatchDefrost(DefrostTrigger::STOP, millis());
+    if ((actions & ACT_RESET_Y_TIMER) && _yWasActive) {
+        // Short-cycle protection applies from recovery
+        _yActiveStartTick = millis();
+        armTimer(TimerId::Y_SHORT_CYCLE, _yActiveStartTick, _cntShortCycleMs);
     }
 }
 
-void GoodmanHP::checkSuctionTemp() {
-    // Only applies in COOL mode
-    if (_state != State::COOL && !_suctionLowTemp) return;
-
-    uint32_t now = millis();
+void GoodmanHP::beginOutputs() {
+    _outTxn.depth++;
+}
 
-    // If already in suction low temp fault, recheck for recovery
-    if (_suctionLowTemp) {
-        // Auto-clear if no longer in COOL mode
-        if (_state != State::COOL && _state != State::ERROR) {
-            uint32_t elapsed = now - _suctionLowTempStartTick;
-            Log.info("HP", "Suction low temp cleared: no longer in COOL mode, resolved in %lu min %lu sec",
-                     elapsed / 60000UL, (elapsed / 1000UL) % 60);
-            _suctionLowTemp = false;
-            if (_stateChangeCb) _stateChangeCb(_state, _state);
-            return;
-        }
+// Outside a transaction the change is committed immediately
+void GoodmanHP::setOutput(OutputId id, bool on, const char* reason) {
+    if (getOutput(id) == nullptr) return;
+    uint8_t bit = outputBit(id);
+    beginOutputs();
+    _outTxn.stagedMask |= bit;
+    if (on) {
+        _outTxn.onMask |= bit;
+    } else {
+        _outTxn.onMask &= ~bit;
+    }
+    _outTxn.reason[(uint8_t)id] = reason;
+    commitOutputs();
+}
 
-        if (now - _suctionLowTempLastCheckTick < SUCTION_CHECK_MS) return;
-        _suctionLowTempLastCheckTick = now;
+// Staged level if a change is pending, so decisions later in the same update() see it
+bool GoodmanHP::isOutputOn(OutputId id) {
+    uint8_t bit = outputBit(id);
+    if (_outTxn.stagedMask & bit) return (_outTxn.onMask & bit) != 0;
+    OutPin* pin = getOutput(id);
+    return pin != nullptr && pin->isOn();
+}
 
-        TempSensor* suction = getTempSensor("SUCTION_TEMP");
-        if (suction == nullptr || !suction->isValid()) return;
+uint32_t GoodmanHP::cntShortCycleRemainingMs() const {
+    OutPin* cnt = getOutput(OutputId::CNT);
+    return cnt != nullptr ? cnt->minOffRemainingMs() : 0;
+}
 
-        float temp = suction->getValue();
-        Log.info("HP", "Suction low temp recheck: %.1fF (recovery > %.1fF)", temp, SUCTION_RESUME_F);
+void GoodmanHP::commitOutputs() {
+    if (_outTxn.depth == 0 || --_outTxn.depth > 0) return;
+    uint8_t staged = _outTxn.stagedMask;
+    if (staged == 0) return;
+    _outTxn.stagedMask = 0;
 
-        if (temp > SUCTION_RESUME_F) {
-            uint32_t elapsed = now - _suctionLowTempStartTick;
-            Log.warn("HP", "Suction low temp cleared: %.1fF > %.1fF, resolved in %lu min %lu sec",
-                     temp, SUCTION_RESUME_F, elapsed / 60000UL, (elapsed / 1000UL) % 60);
-            _suctionLowTemp = false;
-            if (_stateChangeCb) _stateChangeCb(_state, _state);
+    uint8_t current = 0;
+    for (uint8_t i = 0; i < (uint8_t)OutputId::COUNT; i++) {
+        if ((staged & (1 << i)) && _outputs[i]->isOn()) current |= 1 << i;
+    }
+    uint8_t target = _outTxn.onMask & staged;
+
+    // Short cycle guard, once for the whole transition: no path may restart
+    // CNT inside the short cycle delay
+    uint8_t cntBit = outputBit(OutputId::CNT);
+    if ((target & cntBit) && !(current & cntBit)) {
+        uint32_t remainMs = cntShortCycleRemainingMs();
+        if (remainMs > 0) {
+            Log.warn("HP", "CNT start blocked (%s): short cycle, %lu s remaining",
+                     _outTxn.reason[(uint8_t)OutputId::CNT], (remainMs + 999) / 1000UL);
+            staged &= ~cntBit;
+            target &= ~cntBit;
+            _cntActivated = false;
         }
-        return;
     }
 
-    // Only check every 1 minute for new condition
-    if (now - _suctionLowTempLastCheckTick < SUCTION_CHECK_MS) return;
-    _suctionLowTempLastCheckTick = now;
-
-    TempSensor* suction = getTempSensor("SUCTION_TEMP");
-    if (suction == nullptr || !suction->isValid()) return;
-
-    float temp = suction->getValue();
+    // Pin bookkeeping first, then every level in one write per GPIO bank.
+    // Clear before set so a release never overlaps the next energize.
+    uint32_t setMask[2] = { 0, 0 };
+    uint32_t clearMask[2] = { 0, 0 };
+    uint8_t written = 0;
+    for (uint8_t i = 0; i < (uint8_t)OutputId::COUNT; i++) {
+        uint8_t bit = 1 << i;
+        if (!(staged & bit)) continue;
+        OutPin* pin = _outputs[i];
+        bool on = (target & bit) != 0;
+        if (!pin->prepareLevel(on)) continue;
+        written |= bit;
+        if (pin->getPWM()) {
+            pin->writeLevel(on);        // LEDC drives the pad, not the output latch
+            continue;
+        }
+        uint8_t gpio = pin->getPin();
+        if (pin->levelFor(on) == HIGH) {
+            setMask[gpio >> 5] |= 1UL << (gpio & 31);
+        } else {
+            clearMask[gpio >> 5] |= 1UL << (gpio & 31);
+        }
+    }
+    if (clearMask[0]) REG_WRITE(GPIO_OUT_W1TC_REG, clearMask[0]);
+    if (clearMask[1]) REG_WRITE(GPIO_OUT1_W1TC_REG, clearMask[1]);
+    if (setMask[0]) REG_WRITE(GPIO_OUT_W1TS_REG, setMask[0]);
+    if (setMask[1]) REG_WRITE(GPIO_OUT1_W1TS_REG, setMask[1]);
+    for (uint8_t i = 0; i < (uint8_t)OutputId::COUNT; i++) {
+        if (written & (1 << i)) _outputs[i]->finishLevel();
+    }
 
-    if (temp < SUCTION_CRITICAL_F) {
-        _suctionLowTemp = true;
-        _suctionLowTempStartTick = now;
-        Log.error("HP", "Suction temp critically low: %.1fF < %.1fF, shutting down CNT (FAN stays on)",
-                  temp, SUCTION_CRITICAL_F);
+    uint8_t changed = (target ^ current) & written;
+    if (changed == 0) return;
 
-        OutPin* cnt = getOutput("CNT");
-        if (cnt != nullptr && cnt->isOn()) {
-            cnt->turnOff();
-            _cntActivated = false;
-        }
+    char line[160];
+    size_t len = 0;
+    for (uint8_t i = 0; i < (uint8_t)OutputId::COUNT && len < sizeof(line); i++) {
+        if (!(changed & (1 << i))) continue;
+        len += snprintf(line + len, sizeof(line) - len, "%s%s %s (%s)", len > 0 ? ", " : "",
+                        OUTPUT_NAMES[i], (target & (1 << i)) ? "ON" : "OFF", _outTxn.reason[i]);
+    }
+    Log.info("HP", "Outputs: %s", line);
 
-        // Keep FAN on
-        OutPin* fan = getOutput("FAN");
-        if (fan != nullptr && !fan->isOn()) {
-            fan->turnOn();
-            Log.info("HP", "FAN kept ON during suction low temp");
+    if (_outputChangeCb) {
+        uint8_t onMask = 0;
+        for (uint8_t i = 0; i < (uint8_t)OutputId::COUNT; i++) {
+            if (_outputs[i] != nullptr && _outputs[i]->isOn()) onMask |= 1 << i;
         }
-
-        if (_stateChangeCb) _stateChangeCb(_state, _state);
-    } else if (temp < SUCTION_WARN_F) {
-        Log.warn("HP", "Suction temp low: %.1fF < %.1fF", temp, SUCTION_WARN_F);
+        _outputChangeCb(onMask, changed);
     }
 }
 
 void GoodmanHP::checkYAndActivateCNT() {
-    InputPin* y = getInput("Y");
-    OutPin* cnt = getOutput("CNT");
+    InputPin* y = getInput(InputId::Y);
+    OutPin* cnt = getOutput(OutputId::CNT);
 
     if (y == nullptr || cnt == nullptr) {
         return;
     }
 
-    bool yActive = y->isActive();
-
-    OutPin* fan = getOutput("FAN");
+    bool yActive = isInputActive(InputId::Y);
 
     if (yActive && !_yWasActive) {
         // Y just became active - record start time
         _yActiveStartTick = millis();
+        armTimer(TimerId::Y_SHORT_CYCLE, _yActiveStartTick, _cntShortCycleMs);
         _yWasActive = true;
         // Turn on FAN when Y activates (unless in defrost)
-        if (fan != nullptr && _state != State::DEFROST) {
-            fan->turnOn();
-            Log.info("HP", "FAN turned ON (Y activated)");
-        }
+        if (_state != State::DEFROST) setOutput(OutputId::FAN, true, "Y activated");
         Log.info("HP", "Y input activated, starting 30s timer");
     } else if (!yActive && _yWasActive) {
         // Y just became inactive - reset
         _yWasActive = false;
         _yActiveStartTick = 0;
-        // Turn off FAN when Y deactivates
-        if (fan != nullptr) {
-            fan->turnOff();
-            Log.info("HP", "FAN turned OFF (Y deactivated)");
-        }
+        cancelTimer(TimerId::Y_SHORT_CYCLE);
+        // Turn off FAN (and CNT) when Y deactivates
+        setOutput(OutputId::FAN, false, "Y deactivated");
         if (_cntActivated) {
-            cnt->turnOff();
+            setOutput(OutputId::CNT, false, "Y deactivated");
             _cntActivated = false;
-            Log.info("HP", "Y input deactivated, CNT turned off");
-        }
-        if (_softwareDefrost) {
-            // RV and W off — system shuts down, but _softwareDefrost stays set
-            // so defrost resumes on next Y activation in HEAT mode
-            OutPin* rv = getOutput("RV");
-            if (rv != nullptr) rv->turnOff();
-            OutPin* w = getOutput("W");
-            if (w != nullptr) w->turnOff();
-            _defrostTransition = false;
-            _defrostCntPending = false;
-            Log.info("HP", "Y dropped during defrost, system shutdown (defrost pending)");
-        }
-        if (_defrostExiting) {
-            // Cancel exit transition — all outputs already off from Y-drop above
-            OutPin* rv = getOutput("RV");
-            OutPin* w = getOutput("W");
-            if (rv != nullptr) rv->turnOff();
-            if (w != nullptr) w->turnOff();
-            _defrostExiting = false;
-            _defrostTransition = false;
-            _defrostCntPending = false;
-            Log.info("HP", "Y dropped during defrost exit, exit cancelled");
         }
+        // Defrost stays requested (resumes on next Y in HEAT); an exit is cancelled
+        dispatchDefrost(DefrostTrigger::Y_DROP, millis());
     } else if (yActive && _yWasActive && !_cntActivated) {
-        if (_lpsFault || _lowTemp || _compressorOverTemp || _suctionLowTemp || _rvFail || _softwareDefrost || _defrostExiting) return;
+        if (isCntHeldOff() || _rvFail || _defrostPhase != DefrostPhase::NONE) return;
         // Check if CNT was off for less than 5 minutes - if so, enforce short cycle delay
         uint32_t offElapsed = millis() - cnt->getOffTick();
         if (cnt->getOffTick() > 0 && offElapsed < 5UL * 60 * 1000) {
             // Y still active, CNT off < 5 min - check if short cycle delay has passed
-            uint32_t elapsed = millis() - _yActiveStartTick;
-            if (elapsed >= _cntShortCycleMs) {
-                cnt->turnOn();
+            if (!isTimerArmed(TimerId::Y_SHORT_CYCLE)) {
                 _cntActivated = true;
-                Log.info("HP", "Y active for 30s, CNT activated (short cycle protection)");
+                setOutput(OutputId::CNT, true, "Y active past short cycle delay");
             }
         } else {
             // CNT off >= 5 min or never turned off - activate immediately
-            cnt->turnOn();
             _cntActivated = true;
-            Log.info("HP", "Y active, CNT activated immediately (off > 5 min)");
+            setOutput(OutputId::CNT, true, "Y active, CNT off > 5 min");
         }
     }
 }
 
 void GoodmanHP::updateState() {
     // Don't compute new state while faulted or low temp
-    if (_lpsFault || _lowTemp) return;
+    if (isTripped(ProtectionId::LPS_FAULT) || isTripped(ProtectionId::LOW_AMBIENT)) return;
 
-    InputPin* dft = getInput("DFT");
-    InputPin* y = getInput("Y");
-    InputPin* o = getInput("O");
+    InputPin* dft = getInput(InputId::DFT);
+    InputPin* y = getInput(InputId::Y);
+    InputPin* o = getInput(InputId::O);
 
     if (dft == nullptr || y == nullptr || o == nullptr) {
         return;
@@ -500,26 +1121,19 @@ void GoodmanHP::updateState() {
 
     State newState = State::OFF;
 
-    if (_softwareDefrost && y->isActive() && !o->isActive()) {
+    bool yActive = isInputActive(InputId::Y);
+    bool oActive = isInputActive(InputId::O);
+    bool defrostRequested = isSoftwareDefrostActive();
+    if (defrostRequested && yActive && !oActive) {
         newState = State::DEFROST;
-    } else if (_softwareDefrost && y->isActive() && o->isActive()) {
+    } else if (defrostRequested && yActive && oActive) {
         // Thermostat switched to COOL during pending defrost — cancel defrost
-        Log.info("HP", "COOL mode requested during defrost, cancelling defrost and clearing heat runtime");
-        OutPin* rv = getOutput("RV");
-        OutPin* cnt = getOutput("CNT");
-        OutPin* w = getOutput("W");
-        if (cnt != nullptr) { cnt->turnOff(); _cntActivated = false; }
-        if (rv != nullptr) rv->turnOff();
-        if (w != nullptr) w->turnOff();
-        _softwareDefrost = false;
-        _defrostTransition = false;
-        _defrostCntPending = false;
-        resetHeatRuntime();
+        dispatchDefrost(DefrostTrigger::COOL_REQUEST, millis());
         newState = State::COOL;
-    } else if (y->isActive() && o->isActive()) {
+    } else if (yActive && oActive) {
         newState = State::COOL;
-    } else if (y->isActive()) {
-        // If _softwareDefrost is set, re-enter DEFROST is handled above
+    } else if (yActive) {
+        // A requested defrost re-enters DEFROST above
         newState = State::HEAT;
     }
 
@@ -537,57 +1151,34 @@ void GoodmanHP::updateState() {
         }
 
         // Control RV based on mode: ON for COOL, OFF for HEAT/OFF
-        OutPin* rv = getOutput("RV");
-        if (rv != nullptr && !_softwareDefrost && !_defrostExiting) {
+        if (_defrostPhase == DefrostPhase::NONE) {
             if (newState == State::COOL) {
-                rv->turnOn();
-                Log.info("HP", "RV turned ON for COOL mode");
+                setOutput(OutputId::RV, true, "COOL mode");
             } else if (newState == State::HEAT || newState == State::OFF) {
-                rv->turnOff();
-                Log.info("HP", "RV turned OFF for %s mode",
-                         newState == State::HEAT ? "HEAT" : "OFF");
+                setOutput(OutputId::RV, false, newState == State::HEAT ? "HEAT mode" : "OFF mode");
             }
         }
 
         // Control W: ON in DEFROST (after Phase 1), HEAT with RV fail; OFF otherwise
-        OutPin* w = getOutput("W");
-        if (w != nullptr) {
-            if (newState == State::DEFROST && !_defrostTransition) {
-                w->turnOn();
-                Log.info("HP", "W turned ON for DEFROST mode");
-            } else if (newState == State::HEAT && _rvFail) {
-                w->turnOn();
-                Log.info("HP", "W turned ON for HEAT mode (RV fail — auxiliary heat)");
-            } else if (!_defrostExiting) {
-                w->turnOff();
-                Log.info("HP", "W turned OFF for %s mode", getStateString());
-            }
+        if (newState == State::DEFROST && !isDefrostTransitionActive()) {
+            setOutput(OutputId::W, true, "DEFROST mode");
+        } else if (newState == State::HEAT && _rvFail) {
+            setOutput(OutputId::W, true, "HEAT mode, RV fail auxiliary heat");
+        } else if (!isDefrostExitingActive()) {
+            setOutput(OutputId::W, false, getStateName(newState));
         }
 
         // Resume defrost from Phase 1 when Y returns in HEAT mode
-        if (newState == State::DEFROST && _softwareDefrost && oldState != State::DEFROST) {
-            OutPin* cnt = getOutput("CNT");
-            OutPin* dfFan = getOutput("FAN");
-            Log.info("HP", "Defrost resuming, restarting transition from Phase 1 (%lu s RV short cycle)",
-                     _rvShortCycleMs / 1000UL);
-            if (cnt != nullptr) { cnt->turnOff(); _cntActivated = false; }
-            if (dfFan != nullptr) dfFan->turnOff();
-            _defrostTransition = true;
-            _defrostTransitionStart = millis();
-            _defrostCntPending = false;
+        if (newState == State::DEFROST && oldState != State::DEFROST) {
+            dispatchDefrost(DefrostTrigger::RESUME, millis());
         }
 
         // Control FAN: OFF during DEFROST, restore when leaving DEFROST if Y active
-        OutPin* fan = getOutput("FAN");
-        if (fan != nullptr) {
-            if (newState == State::DEFROST) {
-                fan->turnOff();
-                Log.info("HP", "FAN turned OFF for DEFROST mode");
-            } else if (oldState == State::DEFROST && y->isActive() && !_defrostExiting) {
-                // Leaving defrost with Y still active — turn FAN back on
-                fan->turnOn();
-                Log.info("HP", "FAN turned ON (defrost complete, Y active)");
-            }
+        if (newState == State::DEFROST) {
+            setOutput(OutputId::FAN, false, "DEFROST mode");
+        } else if (oldState == State::DEFROST && yActive && !isDefrostExitingActive()) {
+            // Leaving defrost with Y still active — turn FAN back on
+            setOutput(OutputId::FAN, true, "defrost complete, Y active");
         }
     }
 }
@@ -597,7 +1188,11 @@ GoodmanHP::State GoodmanHP::getState() {
 }
 
 const char* GoodmanHP::getStateString() {
-    switch (_state) {
+    return getStateName(_state);
+}
+
+const char* GoodmanHP::getStateName(State state) {
+    switch (state) {
         case State::OFF: return "OFF";
         case State::COOL: return "COOL";
         case State::HEAT: return "HEAT";
@@ -608,25 +1203,10 @@ const char* GoodmanHP::getStateString() {
     }
 }
 
-bool GoodmanHP::isYActive() {
-    InputPin* y = getInput("Y");
-    return y != nullptr && y->isActive();
-}
-
-bool GoodmanHP::isOActive() {
-    InputPin* o = getInput("O");
-    return o != nullptr && o->isActive();
-}
-
-bool GoodmanHP::isLPSActive() {
-    InputPin* lps = getInput("LPS");
-    return lps != nullptr && lps->isActive();
-}
-
-bool GoodmanHP::isDFTActive() {
-    InputPin* dft = getInput("DFT");
-    return dft != nullptr && dft->isActive();
-}
+bool GoodmanHP::isYActive() { return isInputActive(InputId::Y); }
+bool GoodmanHP::isOActive() { return isInputActive(InputId::O); }
+bool GoodmanHP::isLPSActive() { return isInputActive(InputId::LPS); }
+bool GoodmanHP::isDFTActive() { return isInputActive(InputId::DFT); }
 
 uint32_t GoodmanHP::getYActiveTime() {
     if (_yWasActive) {
@@ -641,6 +1221,7 @@ uint32_t GoodmanHP::getHeatRuntimeMs() const {
 
 void GoodmanHP::setHeatRuntimeMs(uint32_t ms) {
     _heatRuntimeMs = ms;
+    Trace.record(TraceEvent::CONFIG, (uint8_t)TraceConfig::HEAT_RUNTIME_MS, ms);
     Log.info("HP", "Heat runtime restored: %lu ms (%lu min)", ms, ms / 60000UL);
 }
 
@@ -650,23 +1231,27 @@ void GoodmanHP::resetHeatRuntime() {
 }
 
 bool GoodmanHP::isSoftwareDefrostActive() const {
-    return _softwareDefrost;
+    return inDefrost(DefrostPhase::ANY_REQUESTED);
 }
 
 bool GoodmanHP::isLPSFaultActive() const {
-    return _lpsFault;
+    return isTripped(ProtectionId::LPS_FAULT);
 }
 
 bool GoodmanHP::isLowTempActive() const {
-    return _lowTemp;
+    return isTripped(ProtectionId::LOW_AMBIENT);
 }
 
 bool GoodmanHP::isCompressorOverTempActive() const {
-    return _compressorOverTemp;
+    return isTripped(ProtectionId::COMPRESSOR_OVERTEMP);
 }
 
 bool GoodmanHP::isSuctionLowTempActive() const {
-    return _suctionLowTemp;
+    return isTripped(ProtectionId::SUCTION_LOW_TEMP);
+}
+
+bool GoodmanHP::isProtectionActive(ProtectionId id) const {
+    return isTripped(id);
 }
 
 bool GoodmanHP::isRvFailActive() const {
@@ -674,41 +1259,47 @@ bool GoodmanHP::isRvFailActive() const {
 }
 
 bool GoodmanHP::isHighSuctionTempActive() const {
-    return _highSuctionTemp;
+    return isTripped(ProtectionId::HIGH_SUCTION_TEMP);
 }
 
 bool GoodmanHP::isDefrostTransitionActive() const {
-    return _defrostTransition;
+    return _defrostPhase == DefrostPhase::ENTRY_EQUALIZE || _defrostPhase == DefrostPhase::EXIT_EQUALIZE;
+}
+
+String GoodmanHP::clearRvFail() {
+    return queueCommand({TraceCommand::CLEAR_RV_FAIL, false, 0});
 }
 
-void GoodmanHP::clearRvFail() {
+void GoodmanHP::applyClearRvFail() {
     _rvFail = false;
-    _highSuctionTemp = false;
+    _faultMask &= ~protectionBit(ProtectionId::HIGH_SUCTION_TEMP);
     // Turn off W that was enabled for auxiliary heat during RV fail
-    OutPin* w = getOutput("W");
-    if (w != nullptr && w->isOn()) {
-        w->turnOff();
-        Log.info("HP", "W turned OFF (RV fail cleared)");
-    }
+    if (isOutputOn(OutputId::W)) setOutput(OutputId::W, false, "RV fail cleared");
     Log.info("HP", "RV fail cleared");
 }
 
 void GoodmanHP::setRvFail() {
     _rvFail = true;
+    Trace.record(TraceEvent::CONFIG, (uint8_t)TraceConfig::RV_FAIL, 1);
     Log.warn("HP", "RV fail state restored from config");
 }
 
 void GoodmanHP::setHighSuctionTempThreshold(float f) {
-    _highSuctionTempThreshold = f;
+    _highSuctionTemp = toDeciF(f);
+    Trace.recordFloat(TraceEvent::CONFIG, (uint8_t)TraceConfig::HIGH_SUCTION_TEMP_F, f);
     Log.info("HP", "High suction temp threshold set to %.1fF", f);
 }
 
 float GoodmanHP::getHighSuctionTempThreshold() const {
-    return _highSuctionTempThreshold;
+    return fromDeciF(_highSuctionTemp);
 }
 
 void GoodmanHP::setRvShortCycleMs(uint32_t ms) {
+    if (DEFROST_NODES[(uint8_t)_defrostPhase].settleMs == &GoodmanHP::_rvShortCycleMs) {
+        retimeTimer(TimerId::DEFROST_SETTLE, _rvShortCycleMs, ms);
+    }
     _rvShortCycleMs = ms;
+    Trace.record(TraceEvent::CONFIG, (uint8_t)TraceConfig::RV_SHORT_CYCLE_MS, ms);
     Log.info("HP", "RV short cycle set to %lu ms", ms);
 }
 
@@ -717,7 +1308,15 @@ uint32_t GoodmanHP::getRvShortCycleMs() const {
 }
 
 void GoodmanHP::setCntShortCycleMs(uint32_t ms) {
+    retimeTimer(TimerId::Y_SHORT_CYCLE, _cntShortCycleMs, ms);
+    if (DEFROST_NODES[(uint8_t)_defrostPhase].settleMs == &GoodmanHP::_cntShortCycleMs) {
+        retimeTimer(TimerId::DEFROST_SETTLE, _cntShortCycleMs, ms);
+    }
     _cntShortCycleMs = ms;
+    // The pin's minimum off lives on the output timer wheel; update() retimes it
+    _cntMinOffStale = true;
+    requestUpdateFromISR();
+    Trace.record(TraceEvent::CONFIG, (uint8_t)TraceConfig::CNT_SHORT_CYCLE_MS, ms);
     Log.info("HP", "CNT short cycle set to %lu ms", ms);
 }
 
@@ -726,29 +1325,29 @@ uint32_t GoodmanHP::getCntShortCycleMs() const {
 }
 
 uint32_t GoodmanHP::getDefrostTransitionRemainingMs() const {
-    if (!_defrostTransition) return 0;
-    uint32_t elapsed = millis() - _defrostTransitionStart;
-    if (elapsed >= _rvShortCycleMs) return 0;
-    return _rvShortCycleMs - elapsed;
+    return isDefrostTransitionActive() ? timerRemainingMs(TimerId::DEFROST_SETTLE) : 0;
 }
 
 bool GoodmanHP::isDefrostCntPendingActive() const {
-    return _defrostCntPending;
+    return _defrostPhase == DefrostPhase::ENTRY_CNT_WAIT || _defrostPhase == DefrostPhase::EXIT_CNT_WAIT;
 }
 
 bool GoodmanHP::isDefrostExitingActive() const {
-    return _defrostExiting;
+    return inDefrost(DefrostPhase::ANY_EXIT);
 }
 
 uint32_t GoodmanHP::getDefrostCntPendingRemainingMs() const {
-    if (!_defrostCntPending) return 0;
-    uint32_t elapsed = millis() - _defrostCntPendingStart;
-    if (elapsed >= _cntShortCycleMs) return 0;
-    return _cntShortCycleMs - elapsed;
+    return isDefrostCntPendingActive() ? timerRemainingMs(TimerId::DEFROST_SETTLE) : 0;
+}
+
+const char* GoodmanHP::getDefrostPhaseName(DefrostPhase phase) {
+    return phase < DefrostPhase::NODE_COUNT ? DEFROST_NODES[(uint8_t)phase].name : "";
 }
 
 void GoodmanHP::setDefrostMinRuntimeMs(uint32_t ms) {
+    retimeTimer(TimerId::DEFROST_MIN_RUNTIME, _defrostMinRuntimeMs, ms);
     _defrostMinRuntimeMs = ms;
+    Trace.record(TraceEvent::CONFIG, (uint8_t)TraceConfig::DEFROST_MIN_RUNTIME_MS, ms);
     Log.info("HP", "Defrost min runtime set to %lu ms", ms);
 }
 
@@ -757,16 +1356,18 @@ uint32_t GoodmanHP::getDefrostMinRuntimeMs() const {
 }
 
 void GoodmanHP::setDefrostExitTempF(float f) {
-    _defrostExitTempF = f;
+    _defrostExit = toDeciF(f);
+    Trace.recordFloat(TraceEvent::CONFIG, (uint8_t)TraceConfig::DEFROST_EXIT_F, f);
     Log.info("HP", "Defrost exit temp set to %.1fF", f);
 }
 
 float GoodmanHP::getDefrostExitTempF() const {
-    return _defrostExitTempF;
+    return fromDeciF(_defrostExit);
 }
 
 void GoodmanHP::setHeatRuntimeThresholdMs(uint32_t ms) {
     _heatRuntimeThresholdMs = ms;
+    Trace.record(TraceEvent::CONFIG, (uint8_t)TraceConfig::HEAT_RUNTIME_THRESHOLD_MS, ms);
     Log.info("HP", "Heat runtime threshold set to %lu ms (%lu min)", ms, ms / 60000UL);
 }
 
@@ -774,68 +1375,17 @@ uint32_t GoodmanHP::getHeatRuntimeThresholdMs() const {
     return _heatRuntimeThresholdMs;
 }
 
-void GoodmanHP::checkHighSuctionTemp() {
-    // Only check during active defrost (after both transition phases)
-    if (!_softwareDefrost || _defrostTransition || _defrostCntPending) return;
-
-    TempSensor* suction = getTempSensor("SUCTION_TEMP");
-    if (suction == nullptr || !suction->isValid()) return;
-
-    float temp = suction->getValue();
-
-    if (temp >= _highSuctionTempThreshold && !_highSuctionTemp) {
-        _highSuctionTemp = true;
-        _rvFail = true;
-        Log.error("HP", "HIGH SUCTION TEMP: %.1fF >= %.1fF during defrost — RV FAIL detected",
-                  temp, _highSuctionTempThreshold);
-        Log.error("HP", "RV fail latched — CNT blocked until cleared via config page");
-
-        // Stop CNT immediately, keep FAN on
-        OutPin* cnt = getOutput("CNT");
-        if (cnt != nullptr && cnt->isOn()) {
-            cnt->turnOff();
-            _cntActivated = false;
-        }
-
-        // Keep FAN on to dissipate heat
-        OutPin* fan = getOutput("FAN");
-        if (fan != nullptr && !fan->isOn()) {
-            fan->turnOn();
-            Log.info("HP", "FAN turned ON (RV fail — dissipate heat)");
-        }
-
-        // Turn on W for auxiliary heat if in HEAT mode (Y active, O not active)
-        OutPin* w = getOutput("W");
-        if (w != nullptr && isYActive() && !isOActive()) {
-            w->turnOn();
-            Log.info("HP", "W turned ON for RV fail (auxiliary heat)");
-        }
-
-        // Stop defrost
-        OutPin* rv = getOutput("RV");
-        if (rv != nullptr) rv->turnOff();
-        _softwareDefrost = false;
-        resetHeatRuntime();
-
-        if (_stateChangeCb) _stateChangeCb(_state, _state);
-    }
-}
-
 bool GoodmanHP::isStartupLockoutActive() const {
     return _startupLockout;
 }
 
 uint32_t GoodmanHP::getStartupLockoutRemainingMs() const {
-    if (!_startupLockout) return 0;
-    uint32_t elapsed = millis() - _startupTick;
-    if (elapsed >= STARTUP_LOCKOUT_MS) return 0;
-    return STARTUP_LOCKOUT_MS - elapsed;
+    return _startupLockout ? timerRemainingMs(TimerId::STARTUP_LOCKOUT) : 0;
 }
 
 bool GoodmanHP::isShortCycleProtectionActive() const {
-    auto it = _outputMap.find("CNT");
-    if (it == _outputMap.end() || it->second == nullptr) return false;
-    OutPin* cnt = it->second;
+    OutPin* cnt = getOutput(OutputId::CNT);
+    if (cnt == nullptr) return false;
     // Short cycle protection is active when CNT is off, has been off before,
     // and less than 5 minutes have elapsed since it turned off
     if (cnt->isPinOn() || cnt->getOffTick() == 0) return false;
@@ -844,16 +1394,18 @@ bool GoodmanHP::isShortCycleProtectionActive() const {
 }
 
 void GoodmanHP::setLowTempThreshold(float threshold) {
-    _lowTempThreshold = threshold;
+    _lowTemp = toDeciF(threshold);
+    Trace.recordFloat(TraceEvent::CONFIG, (uint8_t)TraceConfig::LOW_TEMP_F, threshold);
     Log.info("HP", "Low temp threshold set to %.1fF", threshold);
 }
 
 float GoodmanHP::getLowTempThreshold() const {
-    return _lowTempThreshold;
+    return fromDeciF(_lowTemp);
 }
 
 void GoodmanHP::restoreSoftwareDefrost() {
-    _softwareDefrost = true;
+    dispatchDefrost(DefrostTrigger::RESTORE, millis());
+    Trace.record(TraceEvent::CONFIG, (uint8_t)TraceConfig::SOFTWARE_DEFROST, 1);
     Log.warn("HP", "Software defrost state restored from config");
 }
 
@@ -865,6 +1417,10 @@ void GoodmanHP::setLPSFaultCallback(LPSFaultCallback cb) {
     _lpsFaultCb = cb;
 }
 
+void GoodmanHP::setOutputChangeCallback(OutputChangeCallback cb) {
+    _outputChangeCb = cb;
+}
+
 void GoodmanHP::accumulateHeatRuntime() {
     uint32_t now = millis();
 
@@ -879,7 +1435,7 @@ void GoodmanHP::accumulateHeatRuntime() {
     }
 
     // DFT off means temps > 32°F — no ice on coils, clear runtime
-    if (!isDFTActive() && _heatRuntimeMs > 0 && !_softwareDefrost) {
+    if (!isDFTActive() && _heatRuntimeMs > 0 && !isSoftwareDefrostActive()) {
         Log.info("HP", "DFT off (temps > 32F), resetting heat runtime (%lu min accumulated)", _heatRuntimeMs / 60000UL);
         resetHeatRuntime();
         _heatRuntimeLastTick = now;
@@ -888,8 +1444,7 @@ void GoodmanHP::accumulateHeatRuntime() {
 
     // Only accumulate in HEAT mode when CNT is on, DFT is active (closed at 32°F),
     // and not currently in software defrost
-    OutPin* cnt = getOutput("CNT");
-    if (_state == State::HEAT && cnt != nullptr && cnt->isOn() && !_softwareDefrost && isDFTActive()) {
+    if (_state == State::HEAT && isOutputOn(OutputId::CNT) && !isSoftwareDefrostActive() && isDFTActive()) {
         uint32_t delta = now - _heatRuntimeLastTick;
         _heatRuntimeMs += delta;
 
@@ -904,219 +1459,241 @@ void GoodmanHP::accumulateHeatRuntime() {
     _heatRuntimeLastTick = now;
 }
 
-void GoodmanHP::checkDefrostNeeded() {
-    uint32_t now = millis();
-
-    // Safety: abort any defrost/exit sequence if Y is not active
-    InputPin* yPin = getInput("Y");
-    bool yActive = (yPin != nullptr && yPin->isActive());
-    if (!yActive && (_defrostExiting || _defrostTransition || _defrostCntPending)) {
-        if (_defrostExiting || _defrostTransition || _defrostCntPending) {
-            OutPin* rv = getOutput("RV");
-            OutPin* w = getOutput("W");
-            OutPin* cnt = getOutput("CNT");
-            OutPin* fan = getOutput("FAN");
-            if (rv != nullptr) rv->turnOff();
-            if (w != nullptr) w->turnOff();
-            if (cnt != nullptr) { cnt->turnOff(); _cntActivated = false; }
-            if (fan != nullptr) fan->turnOff();
-            Log.warn("HP", "Y inactive during defrost/exit sequence, all outputs OFF");
+// --- Defrost state machine ---
+//
+// Leaf phases and their superstates:
+//   NONE
+//   ANY_REQUESTED
+//     PENDING                 Requested, waiting for Y in HEAT (restored or Y dropped)
+//     ANY_ENTRY
+//       ENTRY_EQUALIZE        All off, RV short cycle
+//       ENTRY_CNT_WAIT        RV+W on, CNT short cycle
+//     ANY_RUNNING             Timeout and condenser checks run here
+//       ACTIVE                CNT+RV+W on
+//       SUSPENDED             Y dropped after CNT engaged; timers keep running
+//   ANY_EXIT
+//     EXIT_EQUALIZE           CNT+FAN off, RV+W still on
+//     EXIT_CNT_WAIT           RV+W off, CNT short cycle
+
+void GoodmanHP::updateDefrost() {
+    dispatchDefrost(DefrostTrigger::TICK, millis());
+}
+
+bool GoodmanHP::dispatchDefrost(DefrostTrigger trigger, uint32_t now) {
+    static_assert(sizeof(DEFROST_NODES) / sizeof(DEFROST_NODES[0]) == (size_t)DefrostPhase::NODE_COUNT,
+                  "DEFROST_NODES must have one entry per DefrostPhase node");
+    static_assert(sizeof(DEFROST_ROW_START) / sizeof(DEFROST_ROW_START[0]) == (size_t)DefrostPhase::NODE_COUNT + 1,
+                  "DEFROST_ROW_START must have one entry per node plus the end");
+    static_assert(sizeof(DEFROST_ANCESTRY) / sizeof(DEFROST_ANCESTRY[0]) == (size_t)DefrostPhase::COUNT,
+                  "DEFROST_ANCESTRY must have one entry per leaf phase");
+    static_assert((size_t)DefrostPhase::NODE_COUNT <= 16, "DEFROST_ANCESTRY bitmask is 16 bits");
+    static_assert(defrostRowsValid(), "DEFROST_TRANSITIONS must be sorted by source, target leaf phases "
+                                      "and use known, non-contradictory guards");
+    static_assert(defrostNodesValid(), "DEFROST_NODES parents must be later superstates and every leaf "
+                                       "but NONE must have an outgoing transition");
+
+    uint8_t node = (uint8_t)_defrostPhase;
+    while (node < (uint8_t)DefrostPhase::NODE_COUNT) {
+        const DefrostNode& n = DEFROST_NODES[node];
+        if (trigger == DefrostTrigger::TICK && n.during != nullptr) (this->*n.during)(now);
+        for (uint8_t r = DEFROST_ROW_START[node]; r < DEFROST_ROW_START[node + 1]; r++) {
+            const DefrostTransition& t = DEFROST_TRANSITIONS[r];
+            if (t.trigger != trigger || !defrostGuardsHold(t.guards, now)) continue;
+            if (t.action != nullptr) (this->*t.action)(now);
+            if (t.to != _defrostPhase) {
+                Log.debug("HP", "Defrost phase %s -> %s", getDefrostPhaseName(_defrostPhase),
+                          getDefrostPhaseName(t.to));
+            }
+            _defrostPhase = t.to;
+            uint32_t GoodmanHP::* settle = DEFROST_NODES[(uint8_t)t.to].settleMs;
+            if (settle != nullptr) {
+                armTimer(TimerId::DEFROST_SETTLE, now, this->*settle);
+            } else {
+                cancelTimer(TimerId::DEFROST_SETTLE);
+            }
+            if (!inDefrost(DefrostPhase::ANY_RUNNING)) {
+                cancelTimer(TimerId::DEFROST_MIN_RUNTIME);
+                cancelTimer(TimerId::DEFROST_TIMEOUT);
+                cancelTimer(TimerId::DEFROST_COND_CHECK);
+            }
+            return true;
         }
-        _defrostExiting = false;
-        _defrostTransition = false;
-        _defrostCntPending = false;
-        // _softwareDefrost stays set for resume on next Y in HEAT mode
-        return;
+        node = (uint8_t)n.parent;
     }
+    return false;
+}
 
-    // Exit Phase 1: Pressure equalization after defrost (CNT off, RV+W still on)
-    if (_defrostTransition && _defrostExiting) {
-        if (now - _defrostTransitionStart >= _rvShortCycleMs) {
-            _defrostTransition = false;
-            Log.info("HP", "Exit Phase 1 complete, RV+W off, waiting %lu s CNT short cycle",
-                     _cntShortCycleMs / 1000UL);
-            OutPin* rv = getOutput("RV");
-            OutPin* w = getOutput("W");
-            if (rv != nullptr) rv->turnOff();
-            if (w != nullptr) w->turnOff();
-            _defrostCntPending = true;
-            _defrostCntPendingStart = now;
-        }
-        return;
+// Guards are only evaluated for the bits a row sets
+bool GoodmanHP::defrostGuardsHold(uint8_t guards, uint32_t now) {
+    if (guards & (COND_Y_ACTIVE | COND_Y_INACTIVE)) {
+        bool y = isYActive();
+        if ((guards & COND_Y_ACTIVE) && !y) return false;
+        if ((guards & COND_Y_INACTIVE) && y) return false;
     }
+    if ((guards & COND_SETTLED) && isTimerArmed(TimerId::DEFROST_SETTLE)) return false;
+    if ((guards & COND_CNT_FREE) && isCntHeldOff()) return false;
+    if ((guards & COND_HEAT_DUE) && _heatRuntimeMs < _heatRuntimeThresholdMs) return false;
+    if ((guards & COND_DONE) && !_defrostDone) return false;
+    if ((guards & COND_HAS_OUTPUTS) &&
+        (getOutput(OutputId::CNT) == nullptr || getOutput(OutputId::RV) == nullptr)) return false;
+    return true;
+}
 
-    // Exit Phase 2: RV switched back to heat, waiting CNT short cycle
-    if (_defrostCntPending && _defrostExiting) {
-        if (now - _defrostCntPendingStart >= _cntShortCycleMs) {
-            _defrostCntPending = false;
-            _defrostExiting = false;
-            Log.info("HP", "Exit Phase 2 complete, CNT+FAN on — back in HEAT mode");
-            OutPin* cnt = getOutput("CNT");
-            OutPin* fan = getOutput("FAN");
-            if (cnt != nullptr) {
-                cnt->turnOn();
-                _cntActivated = true;
-            }
-            if (fan != nullptr) fan->turnOn();
-        }
-        return;
-    }
+// --- Defrost actions (run before the phase changes) ---
 
-    // Phase 1: Pressure equalization (all off, waiting for RV short cycle)
-    if (_defrostTransition) {
-        if (now - _defrostTransitionStart >= _rvShortCycleMs) {
-            _defrostTransition = false;
-            Log.info("HP", "Phase 1 complete, engaging RV+W, waiting %lu s CNT short cycle",
-                     _cntShortCycleMs / 1000UL);
+void GoodmanHP::startDefrost(uint32_t now) {
+    Log.info("HP", "Starting defrost transition (%lu s RV short cycle)", _rvShortCycleMs / 1000UL);
 
-            OutPin* rv = getOutput("RV");
-            OutPin* w = getOutput("W");
-            if (rv != nullptr) rv->turnOn();
-            if (w != nullptr) w->turnOn();
+    // Turn off CNT and FAN during pressure equalization — RV and CNT come later
+    setOutput(OutputId::CNT, false, "defrost start");
+    _cntActivated = false;
+    setOutput(OutputId::FAN, false, "defrost start");
+}
 
-            // Enter Phase 2: CNT short cycle pending
-            _defrostCntPending = true;
-            _defrostCntPendingStart = now;
-        }
-        return;  // Don't check exit conditions during Phase 1
-    }
+void GoodmanHP::startDefrostOnRuntime(uint32_t now) {
+    Log.info("HP", "Heat runtime %lu min >= %lu min threshold, starting defrost",
+             _heatRuntimeMs / 60000UL, _heatRuntimeThresholdMs / 60000UL);
+    startDefrost(now);
+}
 
-    // Phase 2: CNT short cycle (RV+W on, waiting for CNT activation)
-    if (_defrostCntPending) {
-        if (now - _defrostCntPendingStart >= _cntShortCycleMs) {
-            _defrostCntPending = false;
-            Log.info("HP", "Phase 2 complete, engaging CNT — defrost fully active");
+void GoodmanHP::engageDefrostValves(uint32_t now) {
+    Log.info("HP", "Phase 1 complete, engaging RV+W, waiting %lu s CNT short cycle",
+             _cntShortCycleMs / 1000UL);
+    setOutput(OutputId::RV, true, "defrost Phase 1 complete");
+    setOutput(OutputId::W, true, "defrost Phase 1 complete");
+}
 
-            OutPin* cnt = getOutput("CNT");
-            if (cnt != nullptr) {
-                cnt->turnOn();
-                _cntActivated = true;
-            }
-            _defrostStartTick = now;
-            _defrostLastCondCheckTick = now;
-        }
-        return;  // Don't check exit conditions during Phase 2
+void GoodmanHP::engageDefrostCompressor(uint32_t now) {
+    Log.info("HP", "Phase 2 complete, engaging CNT — defrost fully active");
+    if (getOutput(OutputId::CNT) != nullptr) {
+        _cntActivated = true;
+        setOutput(OutputId::CNT, true, "defrost Phase 2 complete");
     }
+    _defrostStartTick = now;
+    armTimer(TimerId::DEFROST_MIN_RUNTIME, now, _defrostMinRuntimeMs);
+    armTimer(TimerId::DEFROST_TIMEOUT, now, DEFROST_TIMEOUT_MS);
+    armTimer(TimerId::DEFROST_COND_CHECK, now, DEFROST_COND_CHECK_MS);
+    _defrostDone = false;
+}
 
-    // If software defrost is active, check exit conditions
-    if (_softwareDefrost) {
-        // Guard: _defrostStartTick is only set when Phase 3 begins.
-        // If still 0, defrost never reached active phase (Y dropped during Phase 1/2).
-        // Don't check timeout — defrost will resume from Phase 1 when Y reactivates.
-        if (_defrostStartTick == 0) {
-            return;
-        }
-
-        uint32_t elapsed = now - _defrostStartTick;
-
-        // Enforce minimum runtime
-        if (elapsed < _defrostMinRuntimeMs) {
-            return;
-        }
-
-        // Safety timeout
-        if (elapsed >= DEFROST_TIMEOUT_MS) {
-            Log.error("HP", "Defrost timeout (%lu min), forcing stop", DEFROST_TIMEOUT_MS / 60000UL);
-            stopSoftwareDefrost();
-            return;
-        }
+// ANY_RUNNING activity: after the minimum runtime, finish on timeout or once
+// the condenser is warm. The transition out is taken by the superstate rows.
+void GoodmanHP::monitorDefrost(uint32_t now) {
+    if (_defrostDone || isTimerArmed(TimerId::DEFROST_MIN_RUNTIME)) return;
 
-        // Check condenser temp every 1 minute
-        if (now - _defrostLastCondCheckTick >= DEFROST_COND_CHECK_MS) {
-            _defrostLastCondCheckTick = now;
-            TempSensor* condenser = getTempSensor("CONDENSER_TEMP");
-            if (condenser != nullptr && condenser->isValid()) {
-                float condTemp = condenser->getValue();
-                Log.info("HP", "Defrost condenser check: %.1fF (target > %.1fF, elapsed %lu sec)",
-                         condTemp, _defrostExitTempF, elapsed / 1000UL);
-                if (condTemp >= _defrostExitTempF) {
-                    Log.info("HP", "Defrost complete: condenser %.1fF >= %.1fF",
-                             condTemp, _defrostExitTempF);
-                    stopSoftwareDefrost();
-                    return;
-                }
-            }
-        }
+    if (!isTimerArmed(TimerId::DEFROST_TIMEOUT)) {
+        Log.error("HP", "Defrost timeout (%lu min), forcing stop", DEFROST_TIMEOUT_MS / 60000UL);
+        _defrostDone = true;
         return;
     }
 
-    // Check if heat runtime threshold reached
-    if (_heatRuntimeMs >= _heatRuntimeThresholdMs) {
-        Log.info("HP", "Heat runtime %lu min >= %lu min threshold, starting defrost",
-                 _heatRuntimeMs / 60000UL, _heatRuntimeThresholdMs / 60000UL);
-        startSoftwareDefrost();
+    // Check condenser temp every 1 minute
+    if (isTimerArmed(TimerId::DEFROST_COND_CHECK)) return;
+    armTimer(TimerId::DEFROST_COND_CHECK, now, DEFROST_COND_CHECK_MS);
+    uint32_t elapsed = now - _defrostStartTick;
+    TempSensor* condenser = getTempSensor(SensorId::CONDENSER);
+    if (condenser == nullptr || !condenser->isValid()) return;
+    DeciF condTemp = condenser->getDeciF();
+    Log.info("HP", "Defrost condenser check: %.1fF (target > %.1fF, elapsed %lu sec)",
+             fromDeciF(condTemp), fromDeciF(_defrostExit), elapsed / 1000UL);
+    if (condTemp >= _defrostExit) {
+        Log.info("HP", "Defrost complete: condenser %.1fF >= %.1fF", fromDeciF(condTemp), fromDeciF(_defrostExit));
+        _defrostDone = true;
     }
 }
 
-void GoodmanHP::startSoftwareDefrost() {
-    if (_softwareDefrost) return;
-
-    OutPin* cnt = getOutput("CNT");
-    OutPin* rv = getOutput("RV");
-    OutPin* fan = getOutput("FAN");
+void GoodmanHP::beginDefrostExit(uint32_t now) {
+    Log.info("HP", "Defrost complete, starting exit transition (%lu s pressure equalization)",
+             _rvShortCycleMs / 1000UL);
 
-    if (cnt == nullptr || rv == nullptr) {
-        Log.error("HP", "Cannot start software defrost: CNT or RV output not found");
-        return;
-    }
+    // Turn off CNT and FAN only — RV and W stay on during exit Phase 1
+    setOutput(OutputId::CNT, false, "defrost exit");
+    _cntActivated = false;
+    setOutput(OutputId::FAN, false, "defrost exit");
 
-    Log.info("HP", "Starting defrost transition (%lu s RV short cycle)", _rvShortCycleMs / 1000UL);
+    // Leaving ANY_REQUESTED moves the outer state DEFROST → HEAT
+    _faultMask &= ~protectionBit(ProtectionId::HIGH_SUCTION_TEMP);
+    resetHeatRuntime();
+}
 
-    // Turn off CNT and FAN during pressure equalization
-    cnt->turnOff();
+void GoodmanHP::endDefrost(uint32_t now) {
+    Log.info("HP", "Defrost stopped (Y inactive), no exit transition");
+    setOutput(OutputId::CNT, false, "defrost stopped");
     _cntActivated = false;
-    if (fan != nullptr) fan->turnOff();
-
-    // Enter transition phase — do NOT turn on RV or CNT yet
-    _defrostTransition = true;
-    _defrostTransitionStart = millis();
-    _softwareDefrost = true;
-}
-
-void GoodmanHP::stopSoftwareDefrost() {
-    OutPin* cnt = getOutput("CNT");
-    OutPin* fan = getOutput("FAN");
-
-    // Safety: if Y is not active, just clean up — no exit transition
-    InputPin* y = getInput("Y");
-    if (y == nullptr || !y->isActive()) {
-        Log.info("HP", "Defrost stopped (Y inactive), no exit transition");
-        if (cnt != nullptr) { cnt->turnOff(); _cntActivated = false; }
-        if (fan != nullptr) fan->turnOff();
-        OutPin* rv = getOutput("RV");
-        OutPin* w = getOutput("W");
-        if (rv != nullptr) rv->turnOff();
-        if (w != nullptr) w->turnOff();
-        _softwareDefrost = false;
-        _defrostExiting = false;
-        _defrostTransition = false;
-        _defrostCntPending = false;
-        _highSuctionTemp = false;
-        _defrostStartTick = 0;
-        resetHeatRuntime();
-        return;
+    setOutput(OutputId::FAN, false, "defrost stopped");
+    setOutput(OutputId::RV, false, "defrost stopped");
+    setOutput(OutputId::W, false, "defrost stopped");
+    _faultMask &= ~protectionBit(ProtectionId::HIGH_SUCTION_TEMP);
+    resetHeatRuntime();
+}
+
+void GoodmanHP::releaseDefrostValves(uint32_t now) {
+    Log.info("HP", "Exit Phase 1 complete, RV+W off, waiting %lu s CNT short cycle",
+             _cntShortCycleMs / 1000UL);
+    setOutput(OutputId::RV, false, "defrost exit Phase 1 complete");
+    setOutput(OutputId::W, false, "defrost exit Phase 1 complete");
+}
+
+void GoodmanHP::finishDefrostExit(uint32_t now) {
+    Log.info("HP", "Exit Phase 2 complete, CNT+FAN on — back in HEAT mode");
+    if (getOutput(OutputId::CNT) != nullptr) {
+        _cntActivated = true;
+        setOutput(OutputId::CNT, true, "defrost exit complete");
     }
+    setOutput(OutputId::FAN, true, "defrost exit complete");
+}
 
-    Log.info("HP", "Defrost complete, starting exit transition (%lu s pressure equalization)",
+void GoodmanHP::restartDefrostEntry(uint32_t now) {
+    Log.info("HP", "Defrost resuming, restarting transition from Phase 1 (%lu s RV short cycle)",
              _rvShortCycleMs / 1000UL);
+    setOutput(OutputId::CNT, false, "defrost resuming");
+    _cntActivated = false;
+    setOutput(OutputId::FAN, false, "defrost resuming");
+}
 
-    // Turn off CNT and FAN only — RV and W stay on during exit Phase 1
-    if (cnt != nullptr) {
-        cnt->turnOff();
-        _cntActivated = false;
-    }
-    if (fan != nullptr) fan->turnOff();
+// The request survives so defrost resumes on the next Y in HEAT mode
+void GoodmanHP::shutdownForYDrop(uint32_t now) {
+    setOutput(OutputId::RV, false, "Y dropped during defrost");
+    setOutput(OutputId::W, false, "Y dropped during defrost");
+    Log.info("HP", "Y dropped during defrost, system shutdown (defrost pending)");
+}
 
-    // Start exit transition (reuses _defrostTransition / _defrostCntPending flags)
-    _defrostExiting = true;
-    _defrostTransition = true;
-    _defrostTransitionStart = millis();
-    _defrostCntPending = false;
+void GoodmanHP::cancelDefrostExit(uint32_t now) {
+    setOutput(OutputId::RV, false, "Y dropped during defrost exit");
+    setOutput(OutputId::W, false, "Y dropped during defrost exit");
+    Log.info("HP", "Y dropped during defrost exit, exit cancelled");
+}
 
-    // Clear defrost so state machine transitions DEFROST → HEAT
-    _softwareDefrost = false;
-    _highSuctionTemp = false;
-    _defrostStartTick = 0;
+void GoodmanHP::shutdownForYLost(uint32_t now) {
+    setOutput(OutputId::RV, false, "Y inactive during defrost");
+    setOutput(OutputId::W, false, "Y inactive during defrost");
+    setOutput(OutputId::CNT, false, "Y inactive during defrost");
+    _cntActivated = false;
+    setOutput(OutputId::FAN, false, "Y inactive during defrost");
+    Log.warn("HP", "Y inactive during defrost/exit sequence, all outputs OFF");
+}
+
+void GoodmanHP::cancelDefrostForCool(uint32_t now) {
+    Log.info("HP", "COOL mode requested during defrost, cancelling defrost and clearing heat runtime");
+    setOutput(OutputId::CNT, false, "defrost cancelled for COOL");
+    _cntActivated = false;
+    setOutput(OutputId::RV, false, "defrost cancelled for COOL");
+    setOutput(OutputId::W, false, "defrost cancelled for COOL");
+    resetHeatRuntime();
+}
+
+void GoodmanHP::dropDefrostRequest(uint32_t now) {
+    resetHeatRuntime();
+}
+
+void GoodmanHP::abortDefrost(uint32_t now) {
+    Log.warn("HP", "Defrost aborted (manual override)");
+    setOutput(OutputId::CNT, false, "defrost aborted");
+    _cntActivated = false;
+    setOutput(OutputId::FAN, false, "defrost aborted");
+    setOutput(OutputId::RV, false, "defrost aborted");
+    setOutput(OutputId::W, false, "defrost aborted");
+    _faultMask &= ~protectionBit(ProtectionId::HIGH_SUCTION_TEMP);
     resetHeatRuntime();
 }
 
@@ -1125,109 +1702,169 @@ bool GoodmanHP::isManualOverrideActive() const {
 }
 
 uint32_t GoodmanHP::getManualOverrideRemainingMs() const {
-    if (!_manualOverride) return 0;
-    uint32_t elapsed = millis() - _manualOverrideStart;
-    if (elapsed >= MANUAL_OVERRIDE_TIMEOUT_MS) return 0;
-    return MANUAL_OVERRIDE_TIMEOUT_MS - elapsed;
+    return _manualOverride ? timerRemainingMs(TimerId::MANUAL_OVERRIDE) : 0;
 }
 
-void GoodmanHP::setManualOverride(bool on) {
+String GoodmanHP::setManualOverride(bool on) {
+    return queueCommand({TraceCommand::MANUAL_OVERRIDE, on, 0});
+}
+
+String GoodmanHP::setManualOutput(const String& name, bool on) {
+    int slot = slotIndex(OUTPUT_NAMES, name);
+    if (slot < 0) return "Output not found: " + name;
+    return queueCommand({TraceCommand::MANUAL_OUTPUT, on, (uint8_t)slot});
+}
+
+String GoodmanHP::forceDefrost() {
+    return queueCommand({TraceCommand::FORCE_DEFROST, false, 0});
+}
+
+// Web tasks: reject against the published snapshot so the caller gets the
+// error now; runCommand() checks again against the live controller
+String GoodmanHP::queueCommand(const Command& cmd) {
+    Snapshot snap;
+    readSnapshot(snap);
+    CommandView view = {snap.state, snap.faultMask, snap.defrostPhase, snap.manualOverride,
+                        snap.rvFail, snap.outputPresent, snap.remainingMs(snap.cntShortCycleRemainMs)};
+    String err = commandError(view, cmd);
+    if (err.length() > 0) return err;
+
+    portENTER_CRITICAL_SAFE(&_commandMux);
+    bool queued = _commandCount < COMMAND_QUEUE_LEN;
+    if (queued) {
+        _commands[(_commandHead + _commandCount) % COMMAND_QUEUE_LEN] = cmd;
+        _commandCount++;
+    }
+    portEXIT_CRITICAL_SAFE(&_commandMux);
+    if (!queued) return "Controller busy, try again";
+    requestUpdateFromISR();
+    return "";
+}
+
+void GoodmanHP::serviceCommands() {
+    for (;;) {
+        Command cmd;
+        portENTER_CRITICAL_SAFE(&_commandMux);
+        bool pending = _commandCount > 0;
+        if (pending) {
+            cmd = _commands[_commandHead];
+            _commandHead = (_commandHead + 1) % COMMAND_QUEUE_LEN;
+            _commandCount--;
+        }
+        portEXIT_CRITICAL_SAFE(&_commandMux);
+        if (!pending) return;
+        String err = runCommand(cmd.id, cmd.on, cmd.slot);
+        if (err.length() > 0) Log.warn("HP", "Web command dropped: %s", err.c_str());
+    }
+}
+
+String GoodmanHP::runCommand(TraceCommand id, bool on, uint8_t slot) {
+    Trace.record(TraceEvent::COMMAND, (uint8_t)id, on, slot);
+    CommandView view = {_state, _faultMask, _defrostPhase, _manualOverride,
+                        _rvFail, 0, cntShortCycleRemainingMs()};
+    for (uint8_t i = 0; i < (uint8_t)OutputId::COUNT; i++) {
+        if (_outputs[i] != nullptr) view.outputPresent |= 1 << i;
+    }
+    String err = commandError(view, {id, on, slot});
+    if (err.length() > 0) return err;
+
+    switch (id) {
+        case TraceCommand::MANUAL_OVERRIDE: applyManualOverride(on); break;
+        case TraceCommand::MANUAL_OUTPUT: applyManualOutput((OutputId)slot, on); break;
+        case TraceCommand::FORCE_DEFROST: return applyForceDefrost();
+        case TraceCommand::CLEAR_RV_FAIL: applyClearRvFail(); break;
+    }
+    return "";
+}
+
+String GoodmanHP::commandError(const CommandView& view, const Command& cmd) {
+    uint8_t faults = view.faultMask;
+    switch (cmd.id) {
+        case TraceCommand::MANUAL_OUTPUT:
+            if (!view.manualOverride) return "Manual override not active";
+            if (cmd.slot >= (uint8_t)OutputId::COUNT || !(view.outputPresent & (1 << cmd.slot))) {
+                return "Output not found: " + String(getOutputName((OutputId)cmd.slot));
+            }
+            // Same short cycle guard commitOutputs() enforces; checked here to report it
+            if (cmd.on && (OutputId)cmd.slot == OutputId::CNT && view.cntShortCycleRemainMs > 0) {
+                return "Short cycle protection: " + String((view.cntShortCycleRemainMs + 999) / 1000) + "s remaining";
+            }
+            return "";
+        case TraceCommand::FORCE_DEFROST:
+            if (view.manualOverride) return "Disable manual override first";
+            if (phaseIn(view.defrostPhase, DefrostPhase::ANY_REQUESTED)) return "Defrost already active";
+            if (phaseIn(view.defrostPhase, DefrostPhase::ANY_EXIT)) return "Defrost exit transition active";
+            if (view.state != State::HEAT) return "Must be in HEAT mode (current: " + String(getStateName(view.state)) + ")";
+            if (faults & protectionBit(ProtectionId::LPS_FAULT)) return "LPS fault active";
+            if (faults & protectionBit(ProtectionId::COMPRESSOR_OVERTEMP)) return "Compressor over-temp active";
+            if (faults & protectionBit(ProtectionId::LOW_AMBIENT)) return "Low temp protection active";
+            if (view.rvFail) return "RV fail active";
+            return "";
+        default:
+            return "";
+    }
+}
+
+void GoodmanHP::applyManualOverride(bool on) {
     if (on && !_manualOverride) {
         _manualOverride = true;
-        _manualOverrideStart = millis();
+        armTimer(TimerId::MANUAL_OVERRIDE, millis(), MANUAL_OVERRIDE_TIMEOUT_MS);
         Log.warn("HP", "MANUAL OVERRIDE enabled (30 min timeout)");
-        // Stop any active defrost or exit transition
-        if (_softwareDefrost) {
-            stopSoftwareDefrost();
+        // Abort any requested defrost or exit transition
+        if (_defrostPhase != DefrostPhase::NONE) {
+            beginOutputs();
+            dispatchDefrost(DefrostTrigger::ABORT, millis());
+            commitOutputs();
         }
-        _defrostExiting = false;
     } else if (!on && _manualOverride) {
         _manualOverride = false;
+        cancelTimer(TimerId::MANUAL_OVERRIDE);
         // Turn all outputs off and let state machine resume
-        for (auto& pair : _outputMap) {
-            if (pair.second != nullptr) {
-                pair.second->turnOff();
-            }
+        beginOutputs();
+        for (uint8_t i = 0; i < (uint8_t)OutputId::COUNT; i++) {
+            setOutput((OutputId)i, false, "manual override off");
         }
+        commitOutputs();
         _cntActivated = false;
         Log.warn("HP", "MANUAL OVERRIDE disabled, all outputs OFF");
     }
 }
 
-String GoodmanHP::setManualOutput(const String& name, bool on) {
-    if (!_manualOverride) return "Manual override not active";
-
-    OutPin* pin = getOutput(name);
-    if (pin == nullptr) return "Output not found: " + name;
-
-    if (on && name == "CNT") {
-        // Apply same short cycle protection as normal mode
-        if (pin->getOffTick() > 0) {
-            uint32_t offElapsed = millis() - pin->getOffTick();
-            if (offElapsed < 5UL * 60 * 1000 && offElapsed < _cntShortCycleMs) {
-                uint32_t remainSec = (_cntShortCycleMs - offElapsed + 999) / 1000;
-                return "Short cycle protection: " + String(remainSec) + "s remaining";
-            }
-        }
-    }
-
-    if (on) {
-        pin->turnOn();
-    } else {
-        pin->turnOff();
-    }
-
-    if (name == "CNT") _cntActivated = on;
-
-    Log.info("HP", "Manual override: %s %s", name.c_str(), on ? "ON" : "OFF");
-    return "";
+void GoodmanHP::applyManualOutput(OutputId id, bool on) {
+    if (id == OutputId::CNT) _cntActivated = on;
+    setOutput(id, on, "manual override");
+    Log.info("HP", "Manual override: %s %s", getOutputName(id), on ? "ON" : "OFF");
 }
 
-String GoodmanHP::forceDefrost() {
-    if (_manualOverride) return "Disable manual override first";
-    if (_softwareDefrost) return "Defrost already active";
-    if (_defrostExiting) return "Defrost exit transition active";
-    if (_state != State::HEAT) return "Must be in HEAT mode (current: " + String(getStateString()) + ")";
-    if (_lpsFault) return "LPS fault active";
-    if (_compressorOverTemp) return "Compressor over-temp active";
-    if (_lowTemp) return "Low temp protection active";
-    if (_rvFail) return "RV fail active";
-
+String GoodmanHP::applyForceDefrost() {
     Log.warn("HP", "FORCE DEFROST initiated from web interface");
-    startSoftwareDefrost();
+    beginOutputs();
+    bool started = dispatchDefrost(DefrostTrigger::START, millis());
+    commitOutputs();
+    if (!started) return "Cannot start defrost: CNT or RV output not found";
     return "";
 }
 
-// Static callback delegates to instance method
-bool GoodmanHP::outPinRuntimeCallback(OutPin* pin, uint32_t onDuration) {
-    if (_instance != nullptr) {
-        return _instance->handleOutPinRuntime(pin, onDuration);
-    }
-    return false;  // No instance, stop the callback
-}
-
 // Instance method handles specific OutPin runtime events
 bool GoodmanHP::handleOutPinRuntime(OutPin* pin, uint32_t onDuration) {
     if (pin == nullptr) {
         return false;
     }
 
-    String pinName = pin->getName();
-
-    // Handle specific OutPins based on their name
-    if (pinName == "CNT") {
+    // Handle specific OutPins by slot (pointer compare, no String temporaries)
+    if (pin == getOutput(OutputId::CNT)) {
         // Contactor runtime monitoring
         Log.debug("HP", "CNT runtime: %lu ms", onDuration);
         return true;  // Continue monitoring
-    } else if (pinName == "FAN") {
+    } else if (pin == getOutput(OutputId::FAN)) {
         // Fan runtime monitoring
         Log.debug("HP", "FAN runtime: %lu ms", onDuration);
         return true;  // Continue monitoring
-    } else if (pinName == "W") {
+    } else if (pin == getOutput(OutputId::W)) {
         // Heating relay runtime monitoring
         Log.debug("HP", "W runtime: %lu ms", onDuration);
         return true;  // Continue monitoring
-    } else if (pinName == "RV") {
+    } else if (pin == getOutput(OutputId::RV)) {
         // Reversing valve runtime monitoring
         Log.debug("HP", "RV runtime: %lu ms", onDuration);
         return true;  // Continue monitoring
@@ -14,11 +14,13 @@
 #include "OtaUtils.h"
 #include "Config.h"
 #include "GoodmanHP.h"
+#include "I2CBus.h"
 #include "TempHistory.h"
 #include "Logger.h"
 
 extern uint8_t getCpuLoadCore0();
 extern uint8_t getCpuLoadCore1();
+extern uint32_t getInputEventOverflows();
 extern bool _apModeActive;
 extern const char compile_date[];
 
@@ -367,8 +369,7 @@ static esp_err_t configPostHandler(httpd_req_t* req) {
 
     // Clear RV Fail
     bool clearRvFail = data["clearRvFail"] | false;
-    if (clearRvFail) {
-        ctx->hpController->clearRvFail();
+    if (clearRvFail && ctx->hpController->clearRvFail().length() == 0) {
         proj->rvFail = false;
     }
 
@@ -398,7 +399,7 @@ static esp_err_t configPostHandler(httpd_req_t* req) {
     }
 
     // Save to SD card
-    TempSensorMap& tempSensors = ctx->hpController->getTempSensorMap();
+    const TempSensorMap& tempSensors = ctx->hpController->getTempSensorMap();
     bool saved = ctx->config->updateConfig("/config.txt", tempSensors, *proj);
 
     JsonDocument respDoc;
@@ -595,9 +596,35 @@ static esp_err_t tempsGetHandler(httpd_req_t* req) {
             json += "{";
             json += "\"description\":\"" + m.second->getDescription() + "\"";
             json += ",\"devid\":\"" + TempSensor::addressToString(m.second->getDeviceAddress()) + "\"";
-            json += ",\"value\":" + String(m.second->getValue());
-            json += ",\"previous\":" + String(m.second->getPrevious());
-            json += ",\"valid\":\"" + String(m.second->isValid() ? "true" : "false") + "\"";
+            TempSensor::Reading reading = m.second->getReading();
+            const SensorAcquisition& acq = ctx->hpController->getSensorAcquisition();
+            SensorAcquisition::Timing timing = {};
+            SensorAcquisition::Schedule schedule = {};
+            SensorAcquisition::Health health = {};
+            acq.getSensorTiming(m.second, timing);
+            acq.getSensorSchedule(m.second, schedule);
+            acq.getSensorHealth(m.second, health);
+            json += ",\"value\":" + String(fromDeciF(reading.deciF));
+            json += ",\"previous\":" + String(fromDeciF(reading.previousDeciF));
+            json += ",\"valid\":\"" + String(reading.valid ? "true" : "false") + "\"";
+            json += ",\"readUs\":" + String(timing.lastUs);
+            json += ",\"readMaxUs\":" + String(timing.maxUs);
+            json += ",\"readAvgUs\":" + String(timing.avgUs());
+            json += ",\"tier\":\"" + String(SensorAcquisition::getTierName(schedule.tier)) + "\"";
+            json += ",\"intervalMs\":" + String(schedule.intervalMs);
+            json += ",\"resolution\":" + String(schedule.resolution);
+            json += ",\"marginF\":" + (!isfinite(schedule.marginF) ? String("null") : String(schedule.marginF));
+            json += ",\"rateFps\":" + String(schedule.rateFps, 3);
+            json += ",\"crcErrors\":" + String(health.crcErrors);
+            json += ",\"disconnects\":" + String(health.disconnects);
+            json += ",\"timeouts\":" + String(health.timeouts);
+            json += ",\"retries\":" + String(health.retries);
+            json += ",\"powerOnResets\":" + String(health.powerOnResets);
+            json += ",\"implausible\":" + String(health.implausible);
+            json += ",\"failedReads\":" + String(health.failedReads);
+            json += ",\"busBusy\":" + String(health.busBusy);
+            json += ",\"alerts\":" + String(health.alerts);
+            json += ",\"filterSuppressed\":" + String(m.second->getFilter().getSuppressedCount());
             json += "}";
         }
         firstTime = false;
@@ -679,7 +706,9 @@ static esp_err_t tempsHistoryAllGetHandler(httpd_req_t* req) {
             chunk += "[";
             chunk += String(buf[i].epoch);
             chunk += ",";
-            chunk += String(buf[i].temp, 1);
+            char temp[8];
+            formatDeciF(temp, sizeof(temp), buf[i].temp);
+            chunk += temp;
             chunk += "]";
             first = false;
             pointsInChunk++;
@@ -823,6 +852,7 @@ static esp_err_t tempsHistoryGetHandler(httpd_req_t* req) {
 // --- Heap handler ---
 
 static esp_err_t heapGetHandler(httpd_req_t* req) {
+    HttpsContext* ctx = (HttpsContext*)req->user_ctx;
     static constexpr float MB = 1.0f / (1024.0f * 1024.0f);
     String json = "{";
     json += "\"free heap\":" + String(ESP.getFreeHeap());
@@ -830,6 +860,25 @@ static esp_err_t heapGetHandler(httpd_req_t* req) {
     json += ",\"used psram MB\":" + String((ESP.getPsramSize() - ESP.getFreePsram()) * MB);
     json += ",\"cpuLoad0\":" + String(getCpuLoadCore0());
     json += ",\"cpuLoad1\":" + String(getCpuLoadCore1());
+    json += ",\"inputEventOverflows\":" + String(getInputEventOverflows());
+    const SensorAcquisition& acq = ctx->hpController->getSensorAcquisition();
+    const SensorAcquisition::Timing& oneWire = acq.getBusTiming(SensorAcquisition::Bus::ONE_WIRE);
+    const SensorAcquisition::Timing& i2c = acq.getBusTiming(SensorAcquisition::Bus::I2C);
+    json += ",\"oneWireSweepUs\":" + String(oneWire.lastUs);
+    json += ",\"oneWireSweepMaxUs\":" + String(oneWire.maxUs);
+    json += ",\"oneWireSweepAvgUs\":" + String(oneWire.avgUs());
+    json += ",\"oneWireConversionMs\":" + String(acq.getConversionMs());
+    json += ",\"i2cSweepUs\":" + String(i2c.lastUs);
+    json += ",\"i2cSweepMaxUs\":" + String(i2c.maxUs);
+    json += ",\"i2cSweepAvgUs\":" + String(i2c.avgUs());
+    SensorAcquisition::Occupancy oneWireLoad = acq.getBusOccupancy(SensorAcquisition::Bus::ONE_WIRE);
+    SensorAcquisition::Occupancy i2cLoad = acq.getBusOccupancy(SensorAcquisition::Bus::I2C);
+    json += ",\"oneWireOccupancyPermille\":" + String(oneWireLoad.permille);
+    json += ",\"oneWireReadsPerMin\":" + String(oneWireLoad.readsPerMin);
+    json += ",\"i2cOccupancyPermille\":" + String(i2cLoad.permille);
+    json += ",\"i2cReadsPerMin\":" + String(i2cLoad.readsPerMin);
+    json += ",\"sensorResolutionWrites\":" + String(acq.getResolutionWrites());
+    json += ",\"i2cContentions\":" + String(I2cBus.getContentionCount());
     json += "}";
     httpd_resp_set_type(req, "application/json");
     httpd_resp_send(req, json.c_str(), json.length());
@@ -840,39 +889,78 @@ static esp_err_t heapGetHandler(httpd_req_t* req) {
 
 static esp_err_t stateGetHandler(httpd_req_t* req) {
     HttpsContext* ctx = (HttpsContext*)req->user_ctx;
+    GoodmanHP::Snapshot snap;
+    ctx->hpController->readSnapshot(snap);
     JsonDocument doc;
-    doc["state"] = ctx->hpController->getStateString();
+    doc["state"] = GoodmanHP::getStateName(snap.state);
 
     JsonObject inputs = doc["inputs"].to<JsonObject>();
-    for (auto& pair : ctx->hpController->getInputMap()) {
-        if (pair.second != nullptr)
-            inputs[pair.first] = pair.second->isActive();
+    for (uint8_t i = 0; i < (uint8_t)GoodmanHP::InputId::COUNT; i++) {
+        if (snap.inputPresent & (1 << i))
+            inputs[GoodmanHP::getInputName((GoodmanHP::InputId)i)] = (bool)(snap.inputActive & (1 << i));
+    }
+    doc["inputGeneration"] = snap.inputGeneration;
+
+    JsonObject inputStats = doc["inputStats"].to<JsonObject>();
+    for (uint8_t i = 0; i < (uint8_t)GoodmanHP::InputId::COUNT; i++) {
+        if (!(snap.inputPresent & (1 << i))) continue;
+        InputPinStats st;
+        snap.getInputStats((GoodmanHP::InputId)i, st);
+        JsonObject o = inputStats[GoodmanHP::getInputName((GoodmanHP::InputId)i)].to<JsonObject>();
+        o["edges"] = st.edges;
+        o["rawEdges"] = st.rawEdges;
+        o["minPulseUs"] = st.minPulseUs;
+        o["activeMs"] = st.activeMs;
+        o["inactiveMs"] = st.inactiveMs;
+        JsonArray bounceHist = o["bounceHist"].to<JsonArray>();
+        for (uint8_t b = 0; b < InputPinStats::BUCKETS; b++) bounceHist.add(st.bounceHist[b]);
     }
 
     JsonObject outputs = doc["outputs"].to<JsonObject>();
-    for (auto& pair : ctx->hpController->getOutputMap()) {
-        if (pair.second != nullptr)
-            outputs[pair.first] = pair.second->isPinOn();
-    }
-
-    doc["heatRuntimeMin"] = ctx->hpController->getHeatRuntimeMs() / 60000UL;
-    doc["defrost"] = ctx->hpController->isSoftwareDefrostActive();
-    doc["lpsFault"] = ctx->hpController->isLPSFaultActive();
-    doc["lowTemp"] = ctx->hpController->isLowTempActive();
-    doc["compressorOverTemp"] = ctx->hpController->isCompressorOverTempActive();
-    doc["suctionLowTemp"] = ctx->hpController->isSuctionLowTempActive();
-    doc["startupLockout"] = ctx->hpController->isStartupLockoutActive();
-    doc["startupLockoutRemainSec"] = ctx->hpController->getStartupLockoutRemainingMs() / 1000;
-    doc["shortCycleProtection"] = ctx->hpController->isShortCycleProtectionActive();
-    doc["rvFail"] = ctx->hpController->isRvFailActive();
-    doc["highSuctionTemp"] = ctx->hpController->isHighSuctionTempActive();
-    doc["defrostTransition"] = ctx->hpController->isDefrostTransitionActive();
-    doc["defrostTransitionRemainSec"] = ctx->hpController->getDefrostTransitionRemainingMs() / 1000;
-    doc["defrostCntPending"] = ctx->hpController->isDefrostCntPendingActive();
-    doc["defrostCntPendingRemainSec"] = ctx->hpController->getDefrostCntPendingRemainingMs() / 1000;
-    doc["defrostExiting"] = ctx->hpController->isDefrostExitingActive();
-    doc["manualOverride"] = ctx->hpController->isManualOverrideActive();
-    doc["manualOverrideRemainSec"] = ctx->hpController->getManualOverrideRemainingMs() / 1000;
+    for (uint8_t i = 0; i < (uint8_t)GoodmanHP::OutputId::COUNT; i++) {
+        if (snap.outputPresent & (1 << i))
+            outputs[GoodmanHP::getOutputName((GoodmanHP::OutputId)i)] = (bool)(snap.outputOn & (1 << i));
+    }
+
+    JsonObject outputStats = doc["outputStats"].to<JsonObject>();
+    for (uint8_t i = 0; i < (uint8_t)GoodmanHP::OutputId::COUNT; i++) {
+        if (!(snap.outputPresent & (1 << i))) continue;
+        OutPinStats st;
+        snap.getOutputStats((GoodmanHP::OutputId)i, st);
+        JsonObject o = outputStats[GoodmanHP::getOutputName((GoodmanHP::OutputId)i)].to<JsonObject>();
+        o["onMs"] = st.onMs;
+        o["trackedMs"] = st.trackedMs;
+        o["dutyPct"] = st.trackedMs > 0 ? (float)((double)st.onMs * 100.0 / (double)st.trackedMs) : 0.0f;
+        o["cycles"] = st.cycles;
+        o["cyclesLastHour"] = snap.cyclesLastHour[i];
+        o["shortestOffMs"] = st.shortestOffMs;
+        JsonArray onHist = o["onHist"].to<JsonArray>();
+        JsonArray offHist = o["offHist"].to<JsonArray>();
+        for (uint8_t b = 0; b < OutPinStats::BUCKETS; b++) {
+            onHist.add(st.onHist[b]);
+            offHist.add(st.offHist[b]);
+        }
+    }
+
+    doc["heatRuntimeMin"] = snap.heatRuntimeMs / 60000UL;
+    doc["defrost"] = snap.softwareDefrost;
+    doc["lpsFault"] = snap.isProtectionActive(GoodmanHP::ProtectionId::LPS_FAULT);
+    doc["lowTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::LOW_AMBIENT);
+    doc["compressorOverTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::COMPRESSOR_OVERTEMP);
+    doc["suctionLowTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::SUCTION_LOW_TEMP);
+    doc["startupLockout"] = snap.startupLockout;
+    doc["startupLockoutRemainSec"] = snap.remainingMs(snap.startupLockoutRemainMs) / 1000;
+    doc["shortCycleProtection"] = snap.shortCycleProtection;
+    doc["rvFail"] = snap.rvFail;
+    doc["highSuctionTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::HIGH_SUCTION_TEMP);
+    doc["defrostTransition"] = snap.defrostTransition;
+    doc["defrostTransitionRemainSec"] = snap.remainingMs(snap.defrostTransitionRemainMs) / 1000;
+    doc["defrostCntPending"] = snap.defrostCntPending;
+    doc["defrostCntPendingRemainSec"] = snap.remainingMs(snap.defrostCntPendingRemainMs) / 1000;
+    doc["defrostExiting"] = snap.defrostExiting;
+    doc["defrostPhase"] = GoodmanHP::getDefrostPhaseName(snap.defrostPhase);
+    doc["manualOverride"] = snap.manualOverride;
+    doc["manualOverrideRemainSec"] = snap.remainingMs(snap.manualOverrideRemainMs) / 1000;
     doc["cpuLoad0"] = getCpuLoadCore0();
     doc["cpuLoad1"] = getCpuLoadCore1();
     doc["freeHeap"] = ESP.getFreeHeap();
@@ -889,9 +977,8 @@ static esp_err_t stateGetHandler(httpd_req_t* req) {
     }
 
     JsonObject temps = doc["temps"].to<JsonObject>();
-    for (const auto& m : ctx->hpController->getTempSensorMap()) {
-        if (m.second != nullptr && m.second->isValid())
-            temps[m.first] = m.second->getValue();
+    for (uint8_t i = 0; i < snap.tempCount; i++) {
+        temps[snap.temps[i].name] = fromDeciF(snap.temps[i].deciF);
     }
 
     String json;
@@ -922,40 +1009,47 @@ static esp_err_t pinsGetHandler(httpd_req_t* req) {
     }
 
     if (wantJson) {
+        GoodmanHP::Snapshot snap;
+        ctx->hpController->readSnapshot(snap);
         JsonDocument doc;
-        doc["manualOverride"] = ctx->hpController->isManualOverrideActive();
-        doc["manualOverrideRemainSec"] = ctx->hpController->getManualOverrideRemainingMs() / 1000;
-        doc["shortCycleActive"] = ctx->hpController->isShortCycleProtectionActive();
-        doc["state"] = ctx->hpController->getStateString();
-        doc["defrost"] = ctx->hpController->isSoftwareDefrostActive();
-        doc["defrostTransition"] = ctx->hpController->isDefrostTransitionActive();
-        doc["defrostCntPending"] = ctx->hpController->isDefrostCntPendingActive();
-        doc["defrostExiting"] = ctx->hpController->isDefrostExitingActive();
+        doc["manualOverride"] = snap.manualOverride;
+        doc["manualOverrideRemainSec"] = snap.remainingMs(snap.manualOverrideRemainMs) / 1000;
+        doc["shortCycleActive"] = snap.shortCycleProtection;
+        doc["state"] = GoodmanHP::getStateName(snap.state);
+        doc["defrost"] = snap.softwareDefrost;
+        doc["defrostTransition"] = snap.defrostTransition;
+        doc["defrostCntPending"] = snap.defrostCntPending;
+        doc["defrostExiting"] = snap.defrostExiting;
+        doc["defrostPhase"] = GoodmanHP::getDefrostPhaseName(snap.defrostPhase);
 
         JsonArray inputs = doc["inputs"].to<JsonArray>();
-        for (auto& pair : ctx->hpController->getInputMap()) {
-            if (pair.second != nullptr) {
+        for (uint8_t i = 0; i < (uint8_t)GoodmanHP::InputId::COUNT; i++) {
+            if (snap.inputPresent & (1 << i)) {
                 JsonObject inp = inputs.add<JsonObject>();
-                inp["pin"] = pair.second->getPin();
-                inp["name"] = pair.first;
-                inp["active"] = pair.second->isActive();
+                inp["pin"] = snap.inputPin[i];
+                inp["name"] = GoodmanHP::getInputName((GoodmanHP::InputId)i);
+                inp["active"] = (bool)(snap.inputActive & (1 << i));
+                InputPinStats st;
+                snap.getInputStats((GoodmanHP::InputId)i, st);
+                inp["edges"] = st.edges;
+                inp["rawEdges"] = st.rawEdges;
+                inp["minPulseUs"] = st.minPulseUs;
             }
         }
 
         JsonArray outputs = doc["outputs"].to<JsonArray>();
-        for (auto& pair : ctx->hpController->getOutputMap()) {
-            if (pair.second != nullptr) {
+        for (uint8_t i = 0; i < (uint8_t)GoodmanHP::OutputId::COUNT; i++) {
+            if (snap.outputPresent & (1 << i)) {
                 JsonObject out = outputs.add<JsonObject>();
-                out["pin"] = pair.second->getPin();
-                out["name"] = pair.first;
-                out["on"] = pair.second->isPinOn();
+                out["pin"] = snap.outputPin[i];
+                out["name"] = GoodmanHP::getOutputName((GoodmanHP::OutputId)i);
+                out["on"] = (bool)(snap.outputOn & (1 << i));
             }
         }
 
         JsonObject temps = doc["temps"].to<JsonObject>();
-        for (const auto& m : ctx->hpController->getTempSensorMap()) {
-            if (m.second != nullptr && m.second->isValid())
-                temps[m.first] = m.second->getValue();
+        for (uint8_t i = 0; i < snap.tempCount; i++) {
+            temps[snap.temps[i].name] = fromDeciF(snap.temps[i].deciF);
         }
 
         String json;
@@ -1008,11 +1102,15 @@ static esp_err_t pinsPostHandler(httpd_req_t* req) {
     // Toggle manual override
     if (data["manualOverride"].is<bool>()) {
         bool on = data["manualOverride"] | false;
-        ctx->hpController->setManualOverride(on);
+        String err = ctx->hpController->setManualOverride(on);
         JsonDocument resp;
-        resp["status"] = "ok";
-        resp["manualOverride"] = ctx->hpController->isManualOverrideActive();
-        resp["message"] = on ? "Manual override enabled (30 min timeout)" : "Manual override disabled, all outputs OFF";
+        if (err.length() > 0) {
+            resp["error"] = err;
+        } else {
+            resp["status"] = "ok";
+            resp["manualOverride"] = on;  // Applied on the next loop pass
+            resp["message"] = on ? "Manual override enabled (30 min timeout)" : "Manual override disabled, all outputs OFF";
+        }
         String json;
         serializeJson(resp, json);
         httpd_resp_send(req, json.c_str(), json.length());
@@ -1180,7 +1278,7 @@ static esp_err_t wifiTestPostHandler(httpd_req_t* req) {
                 String newIP = WiFi.localIP().toString();
                 ctx->config->setWifiSSID(*ctx->wifiTestNewSSID);
                 ctx->config->setWifiPassword(*ctx->wifiTestNewPassword);
-                TempSensorMap& tempSensors = ctx->hpController->getTempSensorMap();
+                const TempSensorMap& tempSensors = ctx->hpController->getTempSensorMap();
                 ProjectInfo* proj = ctx->config->getProjectInfo();
                 ctx->config->updateConfig("/config.txt", tempSensors, *proj);
                 *ctx->wifiTestState = "success";
@@ -1419,7 +1517,7 @@ static esp_err_t adminSetupPostHandler(httpd_req_t* req) {
 
     ctx->config->setAdminPassword(pw);
     if (ctx->ftpDisableCb) ctx->ftpDisableCb();
-    TempSensorMap& tempSensors = ctx->hpController->getTempSensorMap();
+    const TempSensorMap& tempSensors = ctx->hpController->getTempSensorMap();
     ProjectInfo* proj = ctx->config->getProjectInfo();
     ctx->config->updateConfig("/config.txt", tempSensors, *proj);
     Log.info("AUTH", "Admin password set via setup page (HTTPS)");
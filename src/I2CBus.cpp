@@ -0,0 +1,48 @@
+#include "I2CBus.h"
+
+I2CBus I2cBus;
+
+I2CBus::I2CBus()
+    : _contentions(0)
+#ifdef NATIVE_SIM
+    , _held(false)
+#else
+    , _mutex(nullptr)
+#endif
+{
+}
+
+bool I2CBus::begin() {
+#ifndef NATIVE_SIM
+    if (_mutex == nullptr) _mutex = xSemaphoreCreateMutex();
+    return _mutex != nullptr;
+#else
+    return true;
+#endif
+}
+
+bool I2CBus::take(uint32_t waitMs) {
+#ifdef NATIVE_SIM
+    (void)waitMs;
+    if (_held) {
+        __atomic_fetch_add(&_contentions, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    _held = true;
+    return true;
+#else
+    // Before begin() only setup() runs, so there is nobody to arbitrate with
+    if (_mutex == nullptr) return true;
+    if (xSemaphoreTake(_mutex, pdMS_TO_TICKS(waitMs)) == pdTRUE) return true;
+    __atomic_fetch_add(&_contentions, 1, __ATOMIC_RELAXED);
+    return false;
+#endif
+}
+
+void I2CBus::give() {
+#ifdef NATIVE_SIM
+    _held = false;
+#else
+    if (_mutex != nullptr) xSemaphoreGive(_mutex);
+#endif
+}
@@ -0,0 +1,135 @@
+#include "InputDebouncer.h"
+#include "Logger.h"
+#include "TraceRecorder.h"
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+
+InputDebouncer::InputDebouncer(Scheduler* ts)
+    : _pins()
+    , _firstTick()
+    , _count(0)
+    , _mask(0)
+    , _stable(0)
+    , _counter()
+    , _window()
+    , _isrSampleRequest(false)
+    , _edgeClbk(nullptr)
+{
+    _tsk = new Task(IDLE_SAMPLE_MS, TASK_FOREVER, [this]() {
+        this->sample();
+    }, ts, false);
+}
+
+bool InputDebouncer::addInput(InputPin* pin) {
+    uint8_t gpio = pin->getPin();
+    if (_count >= MAX_INPUTS || gpio >= 64) {
+        Log.error("INPUT", "Cannot debounce %s (GPIO %u)", pin->getName().c_str(), gpio);
+        return false;
+    }
+    uint32_t windowMs = pin->getDebounceMs();
+    if (windowMs > MAX_WINDOW_MS) {
+        Log.warn("INPUT", "%s debounce %lu ms clamped to %lu ms", pin->getName().c_str(), windowMs, MAX_WINDOW_MS);
+        windowMs = MAX_WINDOW_MS;
+    }
+    uint32_t samples = (windowMs + SAMPLE_MS - 1) / SAMPLE_MS;
+    if (samples == 0) samples = 1;
+
+    uint64_t bit = 1ULL << gpio;
+    for (uint8_t p = 0; p < PLANES; p++) {
+        if (samples & (1UL << p)) _window[p] |= bit;
+    }
+    _mask |= bit;
+    if (pin->getValue()) _stable |= bit;
+    pin->setDebounced(true);
+    _pins[_count++] = pin;
+    return true;
+}
+
+void InputDebouncer::begin() {
+    _tsk->setInterval(IDLE_SAMPLE_MS);
+    _tsk->enable();
+}
+
+void InputDebouncer::setSamplingEnabled(bool enabled) {
+    if (enabled) {
+        _tsk->enableIfNot();
+    } else {
+        _tsk->disable();
+    }
+}
+
+void InputDebouncer::seed() {
+    _stable = readInputs();
+    for (uint8_t p = 0; p < PLANES; p++) _counter[p] = 0;
+    for (uint8_t i = 0; i < _count; i++) _pins[i]->setValue();
+}
+
+void IRAM_ATTR InputDebouncer::requestSampleFromISR() {
+    _isrSampleRequest = true;
+}
+
+void InputDebouncer::serviceSampleRequests() {
+    if (!_isrSampleRequest) return;
+    _isrSampleRequest = false;
+    if (!_tsk->isEnabled()) return;
+    // Already sampling fast: the edge is picked up by the running window
+    if (_tsk->getInterval() == SAMPLE_MS) return;
+    _tsk->setInterval(SAMPLE_MS);
+    _tsk->restartDelayed(SAMPLE_MS);
+}
+
+uint64_t InputDebouncer::readInputs() const {
+    uint64_t levels = REG_READ(GPIO_IN_REG);
+    if (_mask >> 32) levels |= (uint64_t)REG_READ(GPIO_IN1_REG) << 32;
+    return levels & _mask;
+}
+
+void InputDebouncer::sample() {
+    uint32_t now = millis();
+    uint64_t diff = readInputs() ^ _stable;
+
+    // Agreeing inputs restart their window; a disagreeing input whose
+    // counter was zero starts one at this sample
+    uint64_t running = 0;
+    for (uint8_t p = 0; p < PLANES; p++) {
+        _counter[p] &= diff;
+        running |= _counter[p];
+    }
+    uint64_t started = diff & ~running;
+
+    // Ripple-carry increment of every disagreeing counter
+    uint64_t carry = diff;
+    for (uint8_t p = 0; p < PLANES && carry; p++) {
+        uint64_t next = _counter[p] & carry;
+        _counter[p] ^= carry;
+        carry = next;
+    }
+
+    // Counters that have reached their window flip the stable level
+    uint64_t done = diff;
+    for (uint8_t p = 0; p < PLANES; p++) done &= ~(_counter[p] ^ _window[p]);
+
+    if (started) {
+        for (uint8_t i = 0; i < _count; i++) {
+            uint64_t bit = 1ULL << _pins[i]->getPin();
+            if (started & bit) _firstTick[i] = now;
+        }
+    }
+    if (done) {
+        _stable ^= done;
+        for (uint8_t p = 0; p < PLANES; p++) _counter[p] &= ~done;
+        for (uint8_t i = 0; i < _count; i++) {
+            InputPin* pin = _pins[i];
+            uint64_t bit = 1ULL << pin->getPin();
+            if ((done & bit) == 0) continue;
+            uint8_t level = (_stable & bit) ? HIGH : LOW;
+            Trace.record(TraceEvent::INPUT_DEBOUNCED, pin->getPin(), level, _firstTick[i]);
+            pin->debouncedEdge(level, _firstTick[i]);
+            if (_edgeClbk) _edgeClbk(pin, _firstTick[i]);
+        }
+    }
+
+    // Sample fast only while a window is open
+    uint32_t interval = (diff & ~done) ? SAMPLE_MS : IDLE_SAMPLE_MS;
+    if (_tsk->getInterval() != interval) _tsk->setInterval(interval);
+}
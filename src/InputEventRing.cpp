@@ -0,0 +1,40 @@
+#include "InputEventRing.h"
+
+InputEventRing::InputEventRing()
+    : _events()
+    , _head(0)
+    , _tail(0)
+    , _overflows(0)
+    , _highWater(0)
+{
+}
+
+bool IRAM_ATTR InputEventRing::push(uint8_t index, uint8_t level) {
+    uint16_t head = _head;
+    uint16_t used = head - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+    if (used >= CAPACITY) {
+        _overflows = _overflows + 1;
+        return false;
+    }
+    InputEdgeEvent& ev = _events[head & (CAPACITY - 1)];
+    ev.cycles = ESP.getCycleCount();
+    ev.index = index;
+    ev.level = level;
+    if (used + 1 > _highWater) _highWater = used + 1;
+    // Publish the slot before the consumer can see the new head
+    __atomic_store_n(&_head, (uint16_t)(head + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+bool InputEventRing::pop(InputEdgeEvent& out) {
+    uint16_t tail = _tail;
+    if (tail == __atomic_load_n(&_head, __ATOMIC_ACQUIRE)) return false;
+    out = _events[tail & (CAPACITY - 1)];
+    // Hand the slot back only after it has been copied out
+    __atomic_store_n(&_tail, (uint16_t)(tail + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t InputEventRing::ageUs(const InputEdgeEvent& ev) {
+    return (ESP.getCycleCount() - ev.cycles) / ESP.getCpuFreqMHz();
+}
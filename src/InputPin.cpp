@@ -1,26 +1,31 @@
 #include "InputPin.h"
 
-float InputPin::mapFloat(float x, float in_min, float in_max, float out_min, float out_max) {
-  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+const uint8_t InputPinStats::BUCKET_LIMIT[BUCKETS - 1] = { 1, 2, 4, 8, 16 };
+const char* const InputPinStats::BUCKET_LABELS[BUCKETS] = { "1", "2", "3-4", "5-8", "9-16", ">16" };
+
+uint8_t InputPinStats::bucketFor(uint32_t rawEdges) {
+  uint8_t i = 0;
+  while (i < BUCKETS - 1 && rawEdges > BUCKET_LIMIT[i]) i++;
+  return i;
 }
 
-void InputPin::Callback(){
-  _verifiedAtTick = millis();
-  if(_clbk){
-    _clbk(this);
-  }
+// Levels held this long are not bounces, and their microsecond width may have wrapped
+static const uint32_t MAX_PULSE_MS = 60000UL;
+
+float InputPin::mapFloat(float x, float in_min, float in_max, float out_min, float out_max) {
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
 }
 
-InputPin::InputPin(Scheduler *ts, uint32_t delay, InputResistorType pullup, InputPinType it, int8_t pin, String name, String boardPin, InputPinCallback clbk){
+InputPin::InputPin(uint32_t debounceMs, InputResistorType pullup, InputPinType it, int8_t pin, String name, String boardPin, InputPinCallback clbk){
   _it = it;
+  _debounceMs = debounceMs;
+  _debounced = false;
+  _sampled = false;
   _pullupType = pullup;
   _pin = pin;
   _name = name;
   _boardPin = boardPin;
   _clbk = clbk;
-  _tsk = new Task (delay, TASK_ONCE, [this]() {
-    Callback();
-  }, ts, false);
   //initPin();
 }
 
@@ -38,22 +43,24 @@ void InputPin::initPin(){
   setPrevValue();
   setValue();
   changedNow();
+  _statsChangeTick = millis();
 }
 
 uint8_t InputPin::getPin() { return _pin; }
 String InputPin::getName() { return _name; }
-Task * InputPin::getTask(){ return _tsk; }
+uint32_t InputPin::getDebounceMs() { return _debounceMs; }
+InputPinType InputPin::getType() { return _it; }
 
 float InputPin::getPinState(float in_min, float in_max, float out_min, float out_max){
   if(_it == InputPinType::IT_ANALOG){
-    return mapFloat(analogRead(_pin), in_min, in_max, out_min, out_max);
+    return mapFloat(getPinState(), in_min, in_max, out_min, out_max);
   }
   return 0.0;
 }
 
 uint16_t InputPin::getPinState(){
   if(_it == InputPinType::IT_ANALOG){
-    return analogRead(_pin);
+    return _sampled ? _value : analogRead(_pin);
   }
   return digitalRead(_pin);
 }
@@ -74,10 +81,48 @@ uint32_t InputPin::lastActiveAt() { return _lastActiveTick; }
 uint32_t InputPin::lastInactiveAt() { return _lastInactiveTick; }
 
 bool InputPin::isActive() {
+  if(_debounced) return _value > 0;
   return setValue() > 0;
 }
 
+void InputPin::setDebounced(bool debounced) { _debounced = debounced; }
+void InputPin::setSampledValue(uint16_t value) { _value = value; _sampled = true; }
+
 void InputPin::changedNow() { _changedAtTick = millis(); }
+void InputPin::recordEdge(uint16_t level, uint32_t tick, uint32_t tickUs) {
+  _preValue = level;
+  _changedAtTick = tick;
+  _stats.rawEdges++;
+  if (_rawSinceChange < UINT16_MAX) _rawSinceChange++;
+  if (_rawSeen && tick - _lastRawMs < MAX_PULSE_MS) {
+    uint32_t width = tickUs - _lastRawUs;
+    if (_stats.minPulseUs == 0 || width < _stats.minPulseUs) _stats.minPulseUs = width;
+  }
+  _rawSeen = true;
+  _lastRawMs = tick;
+  _lastRawUs = tickUs;
+  _statsVersion++;
+}
+void InputPin::debouncedEdge(uint16_t level, uint32_t firstTick) {
+  uint32_t held = firstTick - _statsChangeTick;
+  if (_value) _stats.activeMs += held; else _stats.inactiveMs += held;
+  _stats.edges++;
+  _stats.bounceHist[InputPinStats::bucketFor(_rawSinceChange)]++;
+  _rawSinceChange = 0;
+  _statsChangeTick = firstTick;
+  _statsVersion++;
+  _value = level;
+  _changedAtTick = firstTick;
+  verifiedNow();
+  if(level) activeNow(); else inactiveNow();
+  fireCallback();
+}
+void InputPin::getStats(InputPinStats& out) const {
+  out = _stats;
+  uint32_t running = millis() - _statsChangeTick;
+  if (_value) out.activeMs += running; else out.inactiveMs += running;
+}
+
 void InputPin::verifiedNow() { _verifiedAtTick = millis(); }
 void InputPin::activeNow() {_lastActiveTick = millis(); }
 void InputPin::inactiveNow() {_lastInactiveTick = millis();}
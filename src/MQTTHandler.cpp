@@ -62,10 +62,12 @@ void MQTTHandler::setController(GoodmanHP* controller) {
 void MQTTHandler::publishTemps() {
     if (!_client.connected() || _controller == nullptr) return;
 
+    // Called from the sensor change callback on the loop task, ahead of the
+    // update() that republishes the snapshot, so read the sensors directly
     JsonDocument doc;
     for (auto& pair : _controller->getTempSensorMap()) {
         if (pair.second != nullptr && pair.second->isValid()) {
-            doc[pair.first] = pair.second->getValue();
+            doc[pair.first] = pair.second->getTempF();
         }
     }
 
@@ -77,38 +79,125 @@ void MQTTHandler::publishTemps() {
 void MQTTHandler::publishState() {
     if (!_client.connected() || _controller == nullptr) return;
 
+    GoodmanHP::Snapshot snap;
+    _controller->readSnapshot(snap);
     JsonDocument doc;
-    doc["state"] = _controller->getStateString();
+    doc["state"] = GoodmanHP::getStateName(snap.state);
 
     JsonObject inputs = doc["inputs"].to<JsonObject>();
-    for (auto& pair : _controller->getInputMap()) {
-        if (pair.second != nullptr) {
-            inputs[pair.first] = pair.second->isActive();
+    for (uint8_t i = 0; i < (uint8_t)GoodmanHP::InputId::COUNT; i++) {
+        if (snap.inputPresent & (1 << i)) {
+            inputs[GoodmanHP::getInputName((GoodmanHP::InputId)i)] = (bool)(snap.inputActive & (1 << i));
         }
     }
 
     JsonObject outputs = doc["outputs"].to<JsonObject>();
-    for (auto& pair : _controller->getOutputMap()) {
-        if (pair.second != nullptr) {
-            outputs[pair.first] = pair.second->isPinOn();
+    for (uint8_t i = 0; i < (uint8_t)GoodmanHP::OutputId::COUNT; i++) {
+        if (snap.outputPresent & (1 << i)) {
+            outputs[GoodmanHP::getOutputName((GoodmanHP::OutputId)i)] = (bool)(snap.outputOn & (1 << i));
         }
     }
 
-    doc["heatRuntimeMin"] = _controller->getHeatRuntimeMs() / 60000UL;
-    doc["defrost"] = _controller->isSoftwareDefrostActive();
-    doc["lpsFault"] = _controller->isLPSFaultActive();
-    doc["lowTemp"] = _controller->isLowTempActive();
-    doc["compressorOverTemp"] = _controller->isCompressorOverTempActive();
-    doc["suctionLowTemp"] = _controller->isSuctionLowTempActive();
-    doc["rvFail"] = _controller->isRvFailActive();
-    doc["highSuctionTemp"] = _controller->isHighSuctionTempActive();
-    doc["manualOverride"] = _controller->isManualOverrideActive();
+    doc["heatRuntimeMin"] = snap.heatRuntimeMs / 60000UL;
+    doc["defrost"] = snap.softwareDefrost;
+    doc["lpsFault"] = snap.isProtectionActive(GoodmanHP::ProtectionId::LPS_FAULT);
+    doc["lowTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::LOW_AMBIENT);
+    doc["compressorOverTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::COMPRESSOR_OVERTEMP);
+    doc["suctionLowTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::SUCTION_LOW_TEMP);
+    doc["rvFail"] = snap.rvFail;
+    doc["highSuctionTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::HIGH_SUCTION_TEMP);
+    doc["manualOverride"] = snap.manualOverride;
 
     char buf[512];
     size_t len = serializeJson(doc, buf, sizeof(buf));
     _client.publish("goodman/state", 0, false, buf, len);
 }
 
+// Per-output accounting totals, published with each runtime save (5 min)
+void MQTTHandler::publishRuntime() {
+    if (!_client.connected() || _controller == nullptr) return;
+
+    GoodmanHP::Snapshot snap;
+    _controller->readSnapshot(snap);
+    JsonDocument doc;
+    for (uint8_t i = 0; i < (uint8_t)GoodmanHP::OutputId::COUNT; i++) {
+        if (!(snap.outputPresent & (1 << i))) continue;
+        OutPinStats st;
+        snap.getOutputStats((GoodmanHP::OutputId)i, st);
+        JsonObject o = doc[GoodmanHP::getOutputName((GoodmanHP::OutputId)i)].to<JsonObject>();
+        o["onMin"] = (uint32_t)(st.onMs / 60000ULL);
+        o["cycles"] = st.cycles;
+        o["cyclesLastHour"] = snap.cyclesLastHour[i];
+        o["dutyPct"] = st.trackedMs > 0 ? (float)((double)st.onMs * 100.0 / (double)st.trackedMs) : 0.0f;
+        o["shortestOffSec"] = st.shortestOffMs / 1000;
+        JsonArray onHist = o["onHist"].to<JsonArray>();
+        JsonArray offHist = o["offHist"].to<JsonArray>();
+        for (uint8_t b = 0; b < OutPinStats::BUCKETS; b++) {
+            onHist.add(st.onHist[b]);
+            offHist.add(st.offHist[b]);
+        }
+    }
+
+    char buf[1536];
+    size_t len = serializeJson(doc, buf, sizeof(buf));
+    _client.publish("goodman/runtime", 0, false, buf, len);
+}
+
+// Per-input contact health, published with each runtime save (5 min)
+void MQTTHandler::publishInputStats() {
+    if (!_client.connected() || _controller == nullptr) return;
+
+    GoodmanHP::Snapshot snap;
+    _controller->readSnapshot(snap);
+    JsonDocument doc;
+    for (uint8_t i = 0; i < (uint8_t)GoodmanHP::InputId::COUNT; i++) {
+        if (!(snap.inputPresent & (1 << i))) continue;
+        InputPinStats st;
+        snap.getInputStats((GoodmanHP::InputId)i, st);
+        JsonObject o = doc[GoodmanHP::getInputName((GoodmanHP::InputId)i)].to<JsonObject>();
+        o["edges"] = st.edges;
+        o["rawEdges"] = st.rawEdges;
+        o["minPulseUs"] = st.minPulseUs;
+        o["activeMin"] = (uint32_t)(st.activeMs / 60000ULL);
+        o["inactiveMin"] = (uint32_t)(st.inactiveMs / 60000ULL);
+        JsonArray bounceHist = o["bounceHist"].to<JsonArray>();
+        for (uint8_t b = 0; b < InputPinStats::BUCKETS; b++) bounceHist.add(st.bounceHist[b]);
+    }
+
+    char buf[1024];
+    size_t len = serializeJson(doc, buf, sizeof(buf));
+    _client.publish("goodman/inputs", 0, false, buf, len);
+}
+
+// Per-sensor read errors and dropped readings, published with each runtime save (5 min)
+void MQTTHandler::publishSensorHealth() {
+    if (!_client.connected() || _controller == nullptr) return;
+
+    const SensorAcquisition& acq = _controller->getSensorAcquisition();
+    JsonDocument doc;
+    for (auto& pair : _controller->getTempSensorMap()) {
+        SensorAcquisition::Health health;
+        if (pair.second == nullptr || !acq.getSensorHealth(pair.second, health)) continue;
+        JsonObject o = doc[pair.first].to<JsonObject>();
+        o["valid"] = pair.second->isValid();
+        o["crcErrors"] = health.crcErrors;
+        o["disconnects"] = health.disconnects;
+        o["timeouts"] = health.timeouts;
+        o["retries"] = health.retries;
+        o["powerOnResets"] = health.powerOnResets;
+        o["implausible"] = health.implausible;
+        o["failedReads"] = health.failedReads;
+        o["busBusy"] = health.busBusy;
+        o["alerts"] = health.alerts;
+        o["filterSuppressed"] = pair.second->getFilter().getSuppressedCount();
+    }
+
+    // Ten counters per sensor grow without bound; size the payload to fit
+    String json;
+    serializeJson(doc, json);
+    _client.publish("goodman/sensors", 0, false, json.c_str(), json.length());
+}
+
 void MQTTHandler::publishFault(const char* fault, const char* message, bool active) {
     if (!_client.connected()) return;
 
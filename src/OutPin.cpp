@@ -1,5 +1,10 @@
 #include "OutPin.h"
 #include "Logger.h"
+#include "TraceRecorder.h"
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+
+uint8_t OutPin::_nextLedcChannel = 0;
 
 uint8_t OutPin::percent_to_byte_float(float percent) {
   // Ensure the input is within the valid range [0.0, 100.0]
@@ -15,6 +20,95 @@ uint8_t OutPin::percent_to_byte_float(float percent) {
   return (uint8_t)value;
 }
 
+const uint32_t OutPinStats::BUCKET_LIMIT_MS[BUCKETS - 1] = {
+  30000UL, 60000UL, 3 * 60000UL, 5 * 60000UL, 10 * 60000UL, 30 * 60000UL, 60 * 60000UL
+};
+const char* const OutPinStats::BUCKET_LABELS[BUCKETS] = {
+  "<30s", "<1m", "<3m", "<5m", "<10m", "<30m", "<1h", ">=1h"
+};
+
+uint8_t OutPinStats::bucketFor(uint32_t ms) {
+  uint8_t i = 0;
+  while (i < BUCKETS - 1 && ms >= BUCKET_LIMIT_MS[i]) i++;
+  return i;
+}
+
+static const uint32_t CYCLE_WINDOW_MS = 60UL * 60 * 1000;
+
+// Called with the level being driven; repeated writes of the same level are no-ops
+void OutPin::accountLevel(bool on){
+  if (on == _statsOn) return;
+  uint32_t now = millis();
+  uint32_t elapsed = now - _statsChangeTick;
+  _stats.trackedMs += elapsed;
+  if (_statsOn) {
+    _stats.onMs += elapsed;
+    _stats.onHist[OutPinStats::bucketFor(elapsed)]++;
+    _statsOffValid = true;
+  } else {
+    if (_statsOffValid) {
+      _stats.offHist[OutPinStats::bucketFor(elapsed)]++;
+      if (_stats.shortestOffMs == 0 || elapsed < _stats.shortestOffMs) _stats.shortestOffMs = elapsed;
+    }
+    _stats.cycles++;
+    rollCycleWindow(now);
+    if (_cyclesThisHour < UINT16_MAX) _cyclesThisHour++;
+  }
+  _statsOn = on;
+  _statsChangeTick = now;
+  _statsVersion++;
+}
+
+void OutPin::rollCycleWindow(uint32_t now){
+  uint32_t elapsed = now - _cycleWindowStart;
+  if (elapsed < CYCLE_WINDOW_MS) return;
+  _cyclesLastHour = (elapsed < 2 * CYCLE_WINDOW_MS) ? _cyclesThisHour : 0;
+  _cyclesThisHour = 0;
+  _cycleWindowStart = now - elapsed % CYCLE_WINDOW_MS;
+}
+
+uint16_t OutPin::getCyclesLastHour(){
+  rollCycleWindow(millis());
+  return _cyclesLastHour;
+}
+
+void OutPin::getStats(OutPinStats& out) const {
+  out = _stats;
+  uint32_t running = millis() - _statsChangeTick;
+  out.trackedMs += running;
+  if (_statsOn) out.onMs += running;
+}
+
+// Totals carry over from config; the running period and hour window restart now
+void OutPin::restoreStats(const OutPinStats& stats){
+  _stats = stats;
+  _statsChangeTick = millis();
+  _statsVersion++;
+}
+
+// Single write point for digital outputs so level changes land in the trace
+void OutPin::writePin(uint8_t level){
+  traceLevel(level);
+  digitalWrite(_pin, level);
+}
+
+void OutPin::writeDuty(uint8_t duty){
+  if (_ledcChannel < 0) return;
+  _pwmDuty = duty;
+  ledcWrite(_ledcChannel, duty);
+}
+
+bool OutPin::readOutputLatch(){
+  uint32_t levels = _pin < 32 ? REG_READ(GPIO_OUT_REG) : REG_READ(GPIO_OUT1_REG);
+  return (levels >> (_pin & 31)) & 1;
+}
+
+void OutPin::traceLevel(uint8_t level){
+  if (Trace.isEnabled() && readOutputLatch() != (level == HIGH)) {
+    Trace.record(TraceEvent::OUTPUT_LEVEL, _pin, level);
+  }
+}
+
 void OutPin::turnOnPercent(float percent){
   float origPercent = _percentOn;
   _percentOn = percent;
@@ -26,15 +120,16 @@ void OutPin::turnOnPercent(float percent){
     }
   }
   _changeOnTick = millis();
+  accountLevel(percent > 0.0);
 
   if(!_pwm){
     if(percent > 0.0){
-      digitalWrite(_pin, _inverse ? LOW : HIGH);
+      writePin(_inverse ? LOW : HIGH);
     }else{
-      digitalWrite(_pin, _inverse ? HIGH : LOW);
+      writePin(_inverse ? HIGH : LOW);
     }
   }else{
-    analogWrite(_pin, percent_to_byte_float(percent));
+    writeDuty(percent_to_byte_float(percent));
   }
   _transitioning = false;
 }
@@ -50,14 +145,7 @@ OutPin::OutPin(Scheduler *ts, uint32_t delay, int8_t pin, String name, String bo
   _pwmFreq = 1000;
   _clbk = clbk;
   _percentOn = 0.0;
-
-  _tsk = new Task(delay, TASK_ONCE, [this]() {
-      this->Callback();
-  }, ts, false);
-
-  _tskRuntime = new Task(_runtimeInterval, TASK_FOREVER, [this]() {
-      this->runtimeCallback();
-  }, ts, false);
+  _onDelayMs = delay;
 }
 
 OutPin::OutPin(Scheduler *ts, uint32_t delay, int8_t pin, String name, String boardPin, float percentOn, OutputPinCallback clbk){
@@ -71,14 +159,7 @@ OutPin::OutPin(Scheduler *ts, uint32_t delay, int8_t pin, String name, String bo
   _pwmFreq = 1000;
   _clbk = clbk;
   _percentOn = percentOn;
-
-  _tsk = new Task(delay, TASK_ONCE, [this]() {
-      this->Callback();
-  }, ts, false);
-
-  _tskRuntime = new Task(_runtimeInterval, TASK_FOREVER, [this]() {
-      this->runtimeCallback();
-  }, ts, false);
+  _onDelayMs = delay;
 }
 
 OutPin::OutPin(Scheduler *ts, uint32_t delay, int8_t pin, String name, String boardPin, bool pwm, OutputPinCallback clbk){
@@ -92,14 +173,7 @@ OutPin::OutPin(Scheduler *ts, uint32_t delay, int8_t pin, String name, String bo
   _pwmFreq = 1000;
   _clbk = clbk;
   _percentOn = 0.0;
-
-  _tsk = new Task(delay, TASK_ONCE, [this]() {
-      this->Callback();
-  }, ts, false);
-
-  _tskRuntime = new Task(_runtimeInterval, TASK_FOREVER, [this]() {
-      this->runtimeCallback();
-  }, ts, false);
+  _onDelayMs = delay;
 }
 
 OutPin::OutPin(Scheduler *ts, uint32_t delay, int8_t pin, String name, String boardPin, bool inverse, bool openDrain, bool pwm, float percentOn, uint32_t freq, OutputPinCallback clbk){
@@ -113,17 +187,7 @@ OutPin::OutPin(Scheduler *ts, uint32_t delay, int8_t pin, String name, String bo
   _pwmFreq = freq;
   _clbk = clbk;
   _percentOn = percentOn;
-  if(pwm){
-      analogWriteFrequency(_pwmFreq);
-  }
-
-  _tsk = new Task(delay, TASK_ONCE, [this]() {
-      this->Callback();
-  }, ts, false);
-
-  _tskRuntime = new Task(_runtimeInterval, TASK_FOREVER, [this]() {
-      this->runtimeCallback();
-  }, ts, false);
+  _onDelayMs = delay;
 }
 
 void OutPin::Callback(){
@@ -136,7 +200,7 @@ String OutPin::getBoardPin() {return _boardPin;}
 int8_t OutPin::getPin(){ return _pin;}
 
 void OutPin::updateDelay(u_int32_t delay){
-  _tsk->setInterval(delay);
+  _onDelayMs = delay;
 }
 
 bool OutPin::getChanged() {return _changed;}
@@ -147,7 +211,67 @@ uint32_t OutPin::getOffTick() { return _changeOffTick; }
 uint32_t OutPin::getOnCount() { return _onCount; }
 void OutPin::resetOnCount() { _onCount = 0; }
 float OutPin::getOnPercent() {return _percentOn;}
-Task * OutPin::getTask() {return _tsk;}
+
+void OutPin::attachTimers(OutputTimerWheel *timers){
+  _timers = timers;
+  _timerOwner = timers != nullptr ? timers->attach(this) : -1;
+  if (timers != nullptr && _timerOwner < 0) {
+    Log.error("OutPin", "%s: output timer wheel full, no on-delay or runtime timers", _name.c_str());
+  }
+}
+
+void OutPin::armTimer(OutputTimerWheel::Kind kind, uint32_t delayMs){
+  if (_timerOwner >= 0) _timers->arm(_timerOwner, kind, millis(), delayMs);
+}
+
+void OutPin::cancelTimer(OutputTimerWheel::Kind kind){
+  if (_timerOwner >= 0) _timers->cancel(_timerOwner, kind);
+}
+
+void OutPin::onTimer(OutputTimerWheel::Kind kind){
+  switch (kind) {
+    case OutputTimerWheel::Kind::ON_DELAY:
+      Callback();
+      break;
+    case OutputTimerWheel::Kind::RUNTIME:
+      runtimeCallback();
+      break;
+    case OutputTimerWheel::Kind::MIN_OFF:
+      if (_minOffClbk) _minOffClbk(this);
+      break;
+    default:
+      break;
+  }
+}
+
+// Takes effect at once: a running minimum off is re-timed from the last turn-off
+void OutPin::setMinOffMs(uint32_t ms){
+  _minOffMs = ms;
+  if (_timerOwner < 0 || !_timers->isArmed(_timerOwner, OutputTimerWheel::Kind::MIN_OFF)) return;
+  uint32_t offElapsed = millis() - _changeOffTick;
+  if (offElapsed < ms) {
+    armTimer(OutputTimerWheel::Kind::MIN_OFF, ms - offElapsed);
+  } else {
+    cancelTimer(OutputTimerWheel::Kind::MIN_OFF);
+  }
+}
+
+uint32_t OutPin::minOffRemainingMs() const {
+  if (_timerOwner < 0) return 0;
+  return _timers->remainingMs(_timerOwner, OutputTimerWheel::Kind::MIN_OFF, millis());
+}
+
+void OutPin::startOnTimers(){
+  armTimer(OutputTimerWheel::Kind::ON_DELAY, _onDelayMs);
+  if(_runtimeClbk != nullptr) armRuntimeCheckpoint();
+}
+
+// Checkpoints land on whole intervals of millis(), so every running output
+// with the same interval is served by one wheel pass
+void OutPin::armRuntimeCheckpoint(){
+  if(_runtimeInterval == 0) return;
+  armTimer(OutputTimerWheel::Kind::RUNTIME, _runtimeInterval - millis() % _runtimeInterval);
+}
 bool OutPin::isOn() {
   bool softwareOn = _percentOn > 0.0;
   if (_transitioning) return softwareOn;
@@ -161,16 +285,42 @@ bool OutPin::isOn() {
   return softwareOn;
 }
 bool OutPin::isPinOn() {
-  bool pinHigh;
-  if (!_pwm) {
-    pinHigh = digitalRead(_pin);
+  if (_ledcChannel >= 0) return ledcRead(_ledcChannel) > 0;
+  bool pinHigh = readOutputLatch();
+  return _inverse ? !pinHigh : pinHigh;
+}
+
+// Spread PWM_VERIFY_SAMPLES pad reads over one PWM period and compare the
+// high fraction with the duty the LEDC channel is running
+void OutPin::verifyPwm(){
+  if (_ledcChannel < 0) return;
+  uint32_t spacingUs = 1000000UL / _pwmFreq / PWM_VERIFY_SAMPLES;
+  if (spacingUs == 0) spacingUs = 1;
+  uint32_t reg = _pin < 32 ? GPIO_IN_REG : GPIO_IN1_REG;
+  uint32_t bit = 1UL << (_pin & 31);
+  uint8_t high = 0;
+  for (uint8_t i = 0; i < PWM_VERIFY_SAMPLES; i++) {
+    if (REG_READ(reg) & bit) high++;
+    delayMicroseconds(spacingUs);
+  }
+  int32_t sampled = (int32_t)high * 255 / PWM_VERIFY_SAMPLES;
+  int32_t commanded = ledcRead(_ledcChannel);
+  if (abs(sampled - commanded) > PWM_VERIFY_TOLERANCE) {
+    _pwmVerifyMismatches++;
+    Log.warn("OutPin", "%s PWM readback mismatch: commanded duty %ld/255, pad sampled %ld/255",
+             _name.c_str(), commanded, sampled);
+  }
+}
+
+void OutPin::setPwmVerifyInterval(uint32_t intervalMs){
+  _pwmVerifyMs = intervalMs;
+  if (_tskVerify == nullptr) return;
+  if (intervalMs == 0) {
+    _tskVerify->disable();
   } else {
-    // ESP32 ADC: 0-4095. Hysteresis: must reach 800 to go high, must drop below 400 to go low.
-    int reading = analogRead(_pin);
-    pinHigh = _lastPwmHigh ? (reading >= 400) : (reading >= 800);
-    _lastPwmHigh = pinHigh;
+    _tskVerify->setInterval(intervalMs);
+    _tskVerify->enableIfNot();
   }
-  return _inverse ? !pinHigh : pinHigh;
 }
 
 void OutPin::initPin(){
@@ -180,49 +330,88 @@ void OutPin::initPin(){
     pinMode(_pin, OUTPUT_OPEN_DRAIN);
   }
   // Immediately drive pin to known OFF state before any callback logic
-  digitalWrite(_pin, _inverse ? HIGH : LOW);
+  writePin(_inverse ? HIGH : LOW);
   _percentOn = 0.0;
   _changeOffTick = millis();
-}
-
-void OutPin::turnOff(){
-  float origPercent = _percentOn;
-  _percentOn = 0.0;
-  _transitioning = true;
-  if(_clbk != nullptr){
-    if(!_clbk(this, isOn(), false, _percentOn, origPercent)){
-      _transitioning = false;
+  _statsOn = false;
+  _statsChangeTick = _changeOffTick;
+  _cycleWindowStart = _changeOffTick;
+  // Power-up counts as a turn-off for the minimum off time
+  if(_minOffMs > 0) armTimer(OutputTimerWheel::Kind::MIN_OFF, _minOffMs);
+  if(_pwm && _ledcChannel < 0){
+    if(_nextLedcChannel >= PWM_CHANNELS){
+      Log.error("OutPin", "%s: no free LEDC channel, driving as a digital output", _name.c_str());
+      _pwm = false;
       return;
     }
+    _ledcChannel = _nextLedcChannel++;
+    ledcSetup(_ledcChannel, _pwmFreq, PWM_RESOLUTION_BITS);
+    ledcAttachPin(_pin, _ledcChannel);
+    writeDuty(0);
+    _tskVerify = new Task(_pwmVerifyMs, TASK_FOREVER, [this]() {
+        this->verifyPwm();
+    }, _ts, false);
+    if(_pwmVerifyMs > 0) _tskVerify->enable();
   }
-  _changeOffTick = millis();
-  _tsk->disable();
-  _tskRuntime->disable();
-  digitalWrite(_pin, _inverse ? HIGH : LOW);
-  _transitioning = false;
+}
+
+void OutPin::turnOff(){
+  if(!prepareLevel(false)) return;
+  writeLevel(false);
+  finishLevel();
 }
 
 void OutPin::turnOn(){
+  if(!prepareLevel(true)) return;
+  writeLevel(true);
+  finishLevel();
+}
+
+bool OutPin::prepareLevel(bool on){
+  if(on && !_statsOn){
+    uint32_t remainMs = minOffRemainingMs();
+    if(remainMs > 0){
+      Log.warn("OutPin", "%s turn-on refused: minimum off time, %lu ms remaining", _name.c_str(), remainMs);
+      return false;
+    }
+  }
   float origPercent = _percentOn;
-  _percentOn = 100.0;
+  _percentOn = on ? 100.0 : 0.0;
   _transitioning = true;
   if(_clbk != nullptr){
     if(!_clbk(this, isOn(), false, _percentOn, origPercent)){
       _transitioning = false;
-      return;
+      return false;
     }
   }
-  _tsk->enableIfNot();
-  _tsk->restartDelayed();
-  if(_runtimeClbk != nullptr){
-    _tskRuntime->enableIfNot();
-    _tskRuntime->restartDelayed();
+  if(on){
+    startOnTimers();
+  }else{
+    _changeOffTick = millis();
+    cancelTimer(OutputTimerWheel::Kind::ON_DELAY);
+    cancelTimer(OutputTimerWheel::Kind::RUNTIME);
+    if(_minOffMs > 0) armTimer(OutputTimerWheel::Kind::MIN_OFF, _minOffMs);
   }
-  digitalWrite(_pin, _inverse ? LOW : HIGH);
+  accountLevel(on);
+  // Traced before the caller writes, while the old level is still readable
+  traceLevel(levelFor(on));
+  return true;
+}
+
+void OutPin::finishLevel(){
   _transitioning = false;
 }
 
+void OutPin::writeLevel(bool on){
+  if(_ledcChannel >= 0){
+    writeDuty(on ? 255 : 0);
+  }else{
+    digitalWrite(_pin, levelFor(on));
+  }
+}
+
 void OutPin::turnOn(float percent){
+  if(percent > 0.0 && !_statsOn && minOffRemainingMs() > 0) return;
   float origPercent = _percentOn;
   _percentOn = percent;
   _transitioning = true;
@@ -232,29 +421,19 @@ void OutPin::turnOn(float percent){
       return;
     }
   }
-  _tsk->enableIfNot();
-  _tsk->restartDelayed();
-  if(_runtimeClbk != nullptr){
-    _tskRuntime->enableIfNot();
-    _tskRuntime->restartDelayed();
-  }
+  startOnTimers();
   _transitioning = false;
 }
 
 void OutPin::setRuntimeCallback(RuntimeCallback clbk, uint32_t intervalMs){
   _runtimeClbk = clbk;
   _runtimeInterval = intervalMs;
-  _tskRuntime->setInterval(_runtimeInterval);
 }
 
 void OutPin::runtimeCallback(){
   if(_runtimeClbk == nullptr || !isOn()){
-    _tskRuntime->disable();
     return;
   }
   uint32_t onDuration = millis() - _changeOnTick;
-  bool shouldContinue = _runtimeClbk(this, onDuration);
-  if(!shouldContinue){
-    _tskRuntime->disable();
-  }
+  if(_runtimeClbk(this, onDuration)) armRuntimeCheckpoint();
 }
@@ -0,0 +1,142 @@
+#include "OutputTimerWheel.h"
+#include "OutPin.h"
+
+static const uint32_t TICK_MASK = ~(OutputTimerWheel::TICK_MS - 1);
+
+// Start of the newest tick that has fully elapsed at now
+static uint32_t lastElapsedTick(uint32_t now) {
+    return ((now + 1) & TICK_MASK) - OutputTimerWheel::TICK_MS;
+}
+
+OutputTimerWheel::OutputTimerWheel(Scheduler* ts)
+    : _owners()
+    , _ownerCount(0)
+    , _occupied(0)
+    , _sweptMs(0)
+    , _armed(0)
+{
+    for (uint8_t i = 0; i < TIMERS; i++) {
+        _timers[i].deadline = 0;
+        _timers[i].slot = NONE;
+        _timers[i].prev = NONE;
+        _timers[i].next = NONE;
+    }
+    for (uint8_t s = 0; s < SLOTS; s++) _head[s] = NONE;
+    _tsk = new Task(TICK_MS, TASK_FOREVER, [this]() {
+        this->advance();
+    }, ts, false);
+}
+
+int8_t OutputTimerWheel::attach(OutPin* pin) {
+    for (uint8_t i = 0; i < _ownerCount; i++) {
+        if (_owners[i] == pin) return i;
+    }
+    if (_ownerCount >= MAX_OUTPUTS) return -1;
+    _owners[_ownerCount] = pin;
+    return _ownerCount++;
+}
+
+void OutputTimerWheel::link(uint8_t id, uint8_t slot) {
+    Timer& t = _timers[id];
+    t.slot = slot;
+    t.prev = NONE;
+    t.next = _head[slot];
+    if (t.next != NONE) _timers[t.next].prev = id;
+    _head[slot] = id;
+    _occupied |= 1ULL << slot;
+    _armed++;
+}
+
+void OutputTimerWheel::unlink(uint8_t id) {
+    Timer& t = _timers[id];
+    if (t.prev != NONE) {
+        _timers[t.prev].next = t.next;
+    } else {
+        _head[t.slot] = t.next;
+        if (t.next == NONE) _occupied &= ~(1ULL << t.slot);
+    }
+    if (t.next != NONE) _timers[t.next].prev = t.prev;
+    t.slot = NONE;
+    _armed--;
+}
+
+void OutputTimerWheel::arm(uint8_t owner, Kind kind, uint32_t now, uint32_t delayMs) {
+    uint8_t id = timerId(owner, kind);
+    uint32_t deadline = now + delayMs;
+    if (_timers[id].slot != NONE) unlink(id);
+    // An idle wheel has not been swept; restart the sweep from now
+    if (_armed == 0) _sweptMs = lastElapsedTick(now);
+    // A deadline in an already swept tick goes in the next slot to be swept
+    uint32_t tick = deadline & TICK_MASK;
+    if ((int32_t)(tick - _sweptMs) <= 0) tick = _sweptMs + TICK_MS;
+    _timers[id].deadline = deadline;
+    link(id, (tick >> TICK_SHIFT) & (SLOTS - 1));
+    reschedule(now);
+}
+
+void OutputTimerWheel::cancel(uint8_t owner, Kind kind) {
+    uint8_t id = timerId(owner, kind);
+    if (_timers[id].slot != NONE) unlink(id);
+    // Otherwise the task may wake for a slot that is now empty, which is harmless
+    if (_armed == 0) _tsk->disable();
+}
+
+bool OutputTimerWheel::isArmed(uint8_t owner, Kind kind) const {
+    return _timers[timerId(owner, kind)].slot != NONE;
+}
+
+uint32_t OutputTimerWheel::remainingMs(uint8_t owner, Kind kind, uint32_t now) const {
+    const Timer& t = _timers[timerId(owner, kind)];
+    if (t.slot == NONE || reached(now, t.deadline)) return 0;
+    return t.deadline - now;
+}
+
+void OutputTimerWheel::advance() {
+    uint32_t now = millis();
+    uint32_t last = lastElapsedTick(now);
+    uint32_t due = 0;
+    int32_t steps = (int32_t)(last - _sweptMs) >> TICK_SHIFT;
+    if (steps > SLOTS) steps = SLOTS;           // One revolution visits every slot
+    for (int32_t s = 1; s <= steps; s++) {
+        uint8_t slot = ((_sweptMs >> TICK_SHIFT) + s) & (SLOTS - 1);
+        uint8_t id = _head[slot];
+        while (id != NONE) {
+            uint8_t next = _timers[id].next;
+            if (reached(now, _timers[id].deadline)) {
+                unlink(id);
+                due |= 1UL << id;
+            }
+            id = next;
+        }
+    }
+    if (steps > 0) _sweptMs = last;
+
+    // Callbacks run after the sweep: they re-arm and switch outputs
+    for (uint8_t id = 0; due != 0; id++, due >>= 1) {
+        if (due & 1) fire(id);
+    }
+    reschedule(millis());
+}
+
+// Sleep until the end of the next occupied slot's tick, when every deadline
+// in that tick has been reached
+void OutputTimerWheel::reschedule(uint32_t now) {
+    if (_occupied == 0) {
+        _tsk->disable();
+        return;
+    }
+    uint8_t from = ((_sweptMs >> TICK_SHIFT) + 1) & (SLOTS - 1);
+    uint64_t rotated = from ? (_occupied >> from) | (_occupied << (SLOTS - from)) : _occupied;
+    uint32_t tick = _sweptMs + (uint32_t)(__builtin_ctzll(rotated) + 1) * TICK_MS;
+    int32_t wait = (int32_t)(tick + TICK_MS - 1 - now);
+    if (wait <= 0) {
+        _tsk->restart();
+    } else {
+        _tsk->restartDelayed((uint32_t)wait);
+    }
+}
+
+void OutputTimerWheel::fire(uint8_t id) {
+    OutPin* pin = _owners[id / KINDS];
+    if (pin != nullptr) pin->onTimer((Kind)(id % KINDS));
+}
@@ -0,0 +1,543 @@
+#include "SensorAcquisition.h"
+#include "I2CBus.h"
+#include "Logger.h"
+#include "TraceRecorder.h"
+#include <math.h>
+
+// Leaving a tier for a slower one needs this much more margin and horizon
+static const float TIER_HYSTERESIS = 1.25f;
+// Weight of the newest rate sample in the smoothed rate
+static const float RATE_SMOOTHING = 0.5f;
+// DS18B20 measurement range and the value its scratchpad holds after power-on reset
+static const DeciF DS18B20_MIN = toDeciF(-67.0f);
+static const DeciF DS18B20_MAX = toDeciF(257.0f);
+static const int32_t POWER_ON_RESET_RAW = 85 * 128;
+static const DeciF POWER_ON_RESET = toDeciF(185.0f);
+
+const SensorAcquisition::TierPolicy SensorAcquisition::TIERS[(uint8_t)Tier::COUNT] = {
+    { Tier::CRITICAL,  2.0f,   30,  1000, 12 },
+    { Tier::NEAR,     10.0f,  300,  2000, 12 },
+    { Tier::NORMAL,   30.0f, 1800, 10000, 12 },
+    { Tier::FAR,    INFINITY, UINT32_MAX, 30000, 10 },
+};
+
+SensorAcquisition::SensorAcquisition(Scheduler* ts)
+    : _bus(nullptr)
+    , _entries()
+    , _count(0)
+    , _oneWireCount(0)
+    , _running(false)
+    , _phase(Phase::IDLE)
+    , _sweepMask(0)
+    , _sweepBuses(0)
+    , _readIndex(0)
+    , _sweepStartMs(0)
+    , _sweepChanges(0)
+    , _pendingChanges(0)
+    , _replanMask(0)
+    , _sweepTimedOut(false)
+    , _sweepRetryUs(0)
+    , _sweepBusUs()
+    , _busTiming()
+    , _windowStartMs(0)
+    , _windowBusUs()
+    , _windowReads()
+    , _occupancy()
+    , _conversionMs(0)
+    , _sweeps(0)
+    , _resolutionWrites(0)
+    , _alertSensor(nullptr)
+    , _alertPin(0)
+    , _alertIndex(-1)
+    , _alertPending(false)
+    , _mux(portMUX_INITIALIZER_UNLOCKED)
+{
+#ifdef NATIVE_SIM
+    _tsk = new Task(TIERS[(uint8_t)Tier::NORMAL].intervalMs, TASK_FOREVER, [this]() {
+        uint32_t wait = this->step();
+        if (wait == 0) {
+            _tsk->forceNextIteration();
+        } else {
+            _tsk->delay(wait);
+        }
+    }, ts, false);
+#else
+    (void)ts;
+    _task = nullptr;
+#endif
+}
+
+void SensorAcquisition::setDallasTemperature(DallasTemperature* sensors) {
+    _bus = sensors;
+    // The sweep waits for the conversion itself, asleep between polls
+    if (_bus != nullptr) _bus->setWaitForConversion(false);
+}
+
+bool SensorAcquisition::addSensor(TempSensor* sensor, uint8_t traceId) {
+    if (sensor == nullptr) return false;
+    if (_running || _count >= MAX_SENSORS) {
+        Log.error("SENSORS", "Cannot acquire %s: acquisition full or already running",
+                  sensor->getDescription().c_str());
+        return false;
+    }
+    Entry& entry = _entries[_count++];
+    entry = Entry();
+    entry.sensor = sensor;
+    entry.traceId = traceId;
+    entry.bus = sensor->getMCP9600() != nullptr ? Bus::I2C : Bus::ONE_WIRE;
+    const TierPolicy& normal = TIERS[(uint8_t)Tier::NORMAL];
+    entry.schedule = { Tier::NORMAL, normal.intervalMs, 0, INFINITY, 0.0f };
+    if (entry.bus == Bus::ONE_WIRE) {
+        _oneWireCount++;
+        // Boot-time bus access, before the task owns the bus
+        entry.resolution = _bus != nullptr ? _bus->getResolution(sensor->getDeviceAddress()) : 0;
+        entry.schedule.resolution = entry.resolution;
+    }
+    return true;
+}
+
+void SensorAcquisition::setAlertPin(const TempSensor* sensor, uint8_t gpio) {
+    _alertSensor = sensor;
+    _alertPin = gpio;
+}
+
+bool SensorAcquisition::begin() {
+    if (_running) return true;
+    uint32_t now = millis();
+    _windowStartMs = now;
+    for (uint8_t i = 0; i < _count; i++) {
+        _entries[i].dueMs = now;
+        _entries[i].resolutionSetMs = now;
+        if (_entries[i].sensor == _alertSensor && _entries[i].bus == Bus::I2C) _alertIndex = i;
+    }
+    if (_alertIndex >= 0) {
+        // Armed by the first read; until then the MCP9600's alerts are off
+        pinMode(_alertPin, INPUT_PULLUP);
+        attachInterruptArg(_alertPin, onAlertISR, this, FALLING);
+        Log.info("SENSORS", "%s alerts on GPIO %u", _alertSensor->getDescription().c_str(), _alertPin);
+    }
+#ifdef NATIVE_SIM
+    _tsk->enable();
+#else
+    if (xTaskCreatePinnedToCore(taskMain, "sensors", TASK_STACK_BYTES, this,
+                                TASK_PRIORITY, &_task, TASK_CORE) != pdPASS) {
+        Log.error("SENSORS", "Failed to start acquisition task");
+        return false;
+    }
+#endif
+    _running = true;
+    Log.info("SENSORS", "Acquiring %u sensors (%u on 1-Wire)", _count, _oneWireCount);
+    return true;
+}
+
+#ifndef NATIVE_SIM
+void SensorAcquisition::taskMain(void* arg) {
+    SensorAcquisition* self = (SensorAcquisition*)arg;
+    for (;;) {
+        uint32_t wait = self->step();
+        // Sleep at least a tick between steps so equal-priority tasks on this core
+        // run; an MCP9600 alert ends the sleep early
+        ulTaskNotifyTake(pdTRUE, wait > 0 ? pdMS_TO_TICKS(wait) : 1);
+    }
+}
+#endif
+
+void IRAM_ATTR SensorAcquisition::onAlertISR(void* arg) {
+    static_cast<SensorAcquisition*>(arg)->requestReadFromISR();
+}
+
+void IRAM_ATTR SensorAcquisition::requestReadFromISR() {
+    _alertPending = true;
+#ifdef NATIVE_SIM
+    _tsk->forceNextIteration();
+#else
+    if (_task == nullptr) return;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(_task, &woken);
+    if (woken) portYIELD_FROM_ISR();
+#endif
+}
+
+void SensorAcquisition::setThresholds(const TempSensor* sensor, const DeciF* thresholds, uint8_t count) {
+    if (count > MAX_THRESHOLDS) count = MAX_THRESHOLDS;
+    for (uint8_t i = 0; i < _count; i++) {
+        Entry& entry = _entries[i];
+        if (entry.sensor != sensor) continue;
+        portENTER_CRITICAL_SAFE(&_mux);
+        for (uint8_t t = 0; t < count; t++) entry.thresholds[t] = thresholds[t];
+        entry.thresholdCount = count;
+        portEXIT_CRITICAL_SAFE(&_mux);
+        __atomic_fetch_or(&_replanMask, 1UL << i, __ATOMIC_RELEASE);
+        return;
+    }
+}
+
+// IDLE starts a sweep once any sensor is due, CONVERTING polls until the due
+// DS18B20s report done, and READING reads one due sensor per step
+uint32_t SensorAcquisition::step() {
+    uint32_t now = millis();
+    if (_phase == Phase::IDLE) {
+        if (_alertPending) {
+            _alertPending = false;
+            if (_alertIndex >= 0) {
+                _entries[_alertIndex].dueMs = now;
+                _entries[_alertIndex].health.alerts++;
+            }
+        }
+        if (_replanMask != 0) {
+            uint32_t replan = __atomic_exchange_n(&_replanMask, 0, __ATOMIC_ACQUIRE);
+            for (uint8_t i = 0; i < _count; i++) {
+                if (replan & (1UL << i)) plan(_entries[i], now);
+            }
+        }
+        uint32_t wait = startSweep(now);
+        if (_phase == Phase::IDLE || _phase == Phase::CONVERTING) return wait;
+    }
+
+    if (_phase == Phase::CONVERTING) {
+        uint32_t start = micros();
+        bool done = _bus->isConversionComplete();
+        _sweepBusUs[(uint8_t)Bus::ONE_WIRE] += micros() - start;
+        // Parasite-powered sensors never report done; the timeout reads them anyway
+        if (!done && now - _sweepStartMs < CONVERSION_TIMEOUT_MS) return CONVERSION_POLL_MS;
+        _sweepTimedOut = !done;
+        _conversionMs = now - _sweepStartMs;
+        _phase = Phase::READING;
+    }
+
+    for (; _readIndex < _count; _readIndex++) {
+        if (!(_sweepMask & (1UL << _readIndex))) continue;
+        readSensor(_entries[_readIndex++], now);
+        return 0;
+    }
+
+    endSweep(now);
+    return msUntilDue(millis());
+}
+
+// Collects the due sensors and starts their conversions. Leaves _phase IDLE
+// and returns the wait when nothing is due yet.
+uint32_t SensorAcquisition::startSweep(uint32_t now) {
+    _sweepMask = 0;
+    _sweepBuses = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (!reached(now, _entries[i].dueMs)) continue;
+        _sweepMask |= 1UL << i;
+        _sweepBuses |= 1 << (uint8_t)_entries[i].bus;
+    }
+    if (_sweepMask == 0) return msUntilDue(now);
+
+    _sweepStartMs = now;
+    _readIndex = 0;
+    _sweepChanges = 0;
+    _sweepTimedOut = false;
+    _sweepRetryUs = 0;
+    for (uint32_t& us : _sweepBusUs) us = 0;
+    _phase = Phase::READING;
+    if (_bus == nullptr) return 0;
+
+    uint32_t start = micros();
+    uint16_t waitMs = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        Entry& entry = _entries[i];
+        if (!(_sweepMask & (1UL << i)) || entry.bus != Bus::ONE_WIRE) continue;
+        uint8_t* address = entry.sensor->getDeviceAddress();
+        uint8_t want = entry.schedule.resolution;
+        if (want != 0 && want != entry.resolution) {
+            _bus->setResolution(address, want, true);
+            entry.resolution = want;
+            entry.resolutionSetMs = now;
+            _resolutionWrites++;
+        }
+        _bus->requestTemperaturesByAddress(address);
+        uint16_t ms = _bus->millisToWaitForConversion(entry.resolution);
+        if (ms > waitMs) waitMs = ms;
+        _phase = Phase::CONVERTING;
+    }
+    _sweepBusUs[(uint8_t)Bus::ONE_WIRE] += micros() - start;
+    return waitMs;
+}
+
+void SensorAcquisition::readSensor(Entry& entry, uint32_t now) {
+    if (entry.bus == Bus::ONE_WIRE && _bus == nullptr) {
+        // No bus (trace replay): readings arrive through setDeciF() instead
+        entry.dueMs = _sweepStartMs + entry.schedule.intervalMs;
+        return;
+    }
+    Health& health = entry.health;
+    uint32_t start = micros();
+    DeciF value = DECIF_DISCONNECTED;
+    bool ok;
+    if (entry.bus == Bus::ONE_WIRE) {
+        ok = readOneWire(entry, value);
+        if (_sweepTimedOut) health.timeouts++;
+    } else {
+        I2CBus::Lock lock(I2cBus, I2CBus::SENSOR_WAIT_MS);
+        if (!lock.locked()) {
+            // Another task holds Wire: keep the cached reading, try again soon
+            health.busBusy++;
+            entry.dueMs = _sweepStartMs + TIERS[(uint8_t)Tier::CRITICAL].intervalMs;
+            return;
+        }
+        // The driver reports float °C; the reading becomes fixed point here
+        float tempC = entry.sensor->getMCP9600()->readThermocouple();
+        ok = !isnan(tempC);
+        if (ok) value = toDeciF(tempC * 9.0f / 5.0f + 32.0f);
+        else health.disconnects++;
+        if (ok && &entry - _entries == _alertIndex) armAlerts(entry, value);
+    }
+    uint32_t us = micros() - start;
+    addTiming(entry.timing, us);
+    _sweepBusUs[(uint8_t)entry.bus] += us;
+    _windowReads[(uint8_t)entry.bus]++;
+    if (ok) ok = plausible(entry, value, now);
+
+    bool changed = false;
+    if (ok) {
+        health.consecutiveFailures = 0;
+        changed = entry.sensor->updateValue(value, now);
+        float dtSec = (now - entry.lastReadMs) / 1000.0f;
+        if (entry.primed && dtSec > 0.0f) {
+            float rate = fromDeciF(abs(value - entry.lastValue)) / dtSec;
+            entry.schedule.rateFps += RATE_SMOOTHING * (rate - entry.schedule.rateFps);
+        }
+        entry.lastValue = value;
+        entry.lastReadMs = now;
+        entry.primed = true;
+    } else {
+        health.failedReads++;
+        if (health.consecutiveFailures < UINT8_MAX) health.consecutiveFailures++;
+        // The last good value stands until the sensor has failed repeatedly
+        if (health.consecutiveFailures >= FAILURES_TO_INVALIDATE && entry.sensor->isValid()) {
+            entry.sensor->setDeciF(DECIF_DISCONNECTED);
+            changed = true;
+        }
+    }
+    plan(entry, now);
+    // Check a dropped reading again soon; one already invalid keeps its tier's cadence
+    bool recheck = !ok && health.consecutiveFailures < FAILURES_TO_INVALIDATE;
+    entry.dueMs = _sweepStartMs + (recheck ? TIERS[(uint8_t)Tier::CRITICAL].intervalMs : entry.schedule.intervalMs);
+
+    if (!changed) return;
+    _sweepChanges |= 1UL << (&entry - _entries);
+    if (entry.traceId != NO_TRACE_ID) {
+        TempSensor::Reading reading = entry.sensor->getReading();
+        Trace.recordDeciF(TraceEvent::TEMP_SAMPLE, entry.traceId, reading.deciF, reading.valid);
+    }
+}
+
+// Reads the scratchpad, retrying bus errors within the attempt and sweep
+// budgets. False when no usable reading came back.
+bool SensorAcquisition::readOneWire(Entry& entry, DeciF& value) {
+    Health& health = entry.health;
+    for (uint8_t attempt = 1; ; attempt++) {
+        uint32_t start = micros();
+        int32_t raw = DEVICE_DISCONNECTED_RAW;
+        TempSensor::ReadStatus status = entry.sensor->readRaw(_bus, raw);
+        uint32_t us = micros() - start;
+        if (attempt > 1) _sweepRetryUs += us;
+
+        if (status == TempSensor::ReadStatus::OK) {
+            // A sensor that browned out reports 85 °C until its next conversion
+            bool atResetValue = entry.primed && abs(entry.lastValue - POWER_ON_RESET) <= STEP_ALLOWANCE;
+            if (raw == POWER_ON_RESET_RAW && !atResetValue) {
+                health.powerOnResets++;
+                return false;
+            }
+            value = rawToDeciF(raw);
+            return true;
+        }
+        if (status == TempSensor::ReadStatus::CRC_ERROR) {
+            health.crcErrors++;
+        } else {
+            health.disconnects++;
+        }
+        // Stop before a retry would overrun the sweep's budget
+        if (attempt >= MAX_READ_ATTEMPTS || _sweepRetryUs + us > RETRY_BUDGET_US) return false;
+        health.retries++;
+    }
+}
+
+// Drops readings the sensor cannot produce or the plant cannot reach from
+// the last accepted one. A dropped step is confirmed by the next read
+// landing near it, so a real jump is late by one read, not lost.
+bool SensorAcquisition::plausible(Entry& entry, DeciF value, uint32_t now) {
+    if (entry.bus == Bus::ONE_WIRE && (value < DS18B20_MIN || value > DS18B20_MAX)) {
+        entry.health.implausible++;
+        return false;
+    }
+    if (!entry.primed) return true;
+    int32_t allowed = STEP_ALLOWANCE + (int32_t)((uint64_t)MAX_SLEW_PER_SEC * (now - entry.lastReadMs) / 1000);
+    bool confirms = false;
+    if (entry.suspect) {
+        int32_t sinceSuspect = STEP_ALLOWANCE + (int32_t)((uint64_t)MAX_SLEW_PER_SEC * (now - entry.suspectMs) / 1000);
+        confirms = abs(value - entry.suspectValue) <= sinceSuspect;
+    }
+    if (abs(value - entry.lastValue) <= allowed || confirms) {
+        entry.suspect = false;
+        return true;
+    }
+    entry.suspect = true;
+    entry.suspectValue = value;
+    entry.suspectMs = now;
+    entry.health.implausible++;
+    return false;
+}
+
+// Picks the entry's tier from its last reading; the new interval counts from
+// its last read
+void SensorAcquisition::plan(Entry& entry, uint32_t now) {
+    Schedule& sched = entry.schedule;
+    float margin = INFINITY;
+    portENTER_CRITICAL_SAFE(&_mux);
+    for (uint8_t t = 0; t < entry.thresholdCount; t++) {
+        float d = fromDeciF(abs(entry.lastValue - entry.thresholds[t]));
+        if (d < margin) margin = d;
+    }
+    portEXIT_CRITICAL_SAFE(&_mux);
+    // No reading yet, or the last one was invalid: keep the default cadence
+    if (!entry.primed || !entry.sensor->isValid()) margin = NAN;
+    sched.marginF = margin;
+
+    Tier tier = Tier::NORMAL;
+    if (!isnan(margin)) {
+        float horizon = sched.rateFps > 0.0f ? margin / sched.rateFps : INFINITY;
+        for (const TierPolicy& policy : TIERS) {
+            // Hysteresis only applies to tiers slower than the current one
+            float scale = policy.tier > sched.tier ? TIER_HYSTERESIS : 1.0f;
+            if (margin * scale <= policy.marginF || horizon * scale <= policy.horizonSec) {
+                tier = policy.tier;
+                break;
+            }
+        }
+    }
+    const TierPolicy& policy = TIERS[(uint8_t)tier];
+    sched.tier = tier;
+    sched.intervalMs = policy.intervalMs;
+    if (entry.bus == Bus::ONE_WIRE) {
+        // More resolution right away; less only once the last change has aged
+        bool hold = policy.resolution < entry.resolution && now - entry.resolutionSetMs < RESOLUTION_HOLD_MS;
+        sched.resolution = hold ? entry.resolution : policy.resolution;
+    }
+    uint32_t due = entry.lastReadMs + sched.intervalMs;
+    if (entry.primed && (int32_t)(due - entry.dueMs) < 0) entry.dueMs = due;
+}
+
+void SensorAcquisition::endSweep(uint32_t now) {
+    _phase = Phase::IDLE;
+    _sweeps++;
+    for (uint8_t b = 0; b < (uint8_t)Bus::COUNT; b++) {
+        if (!(_sweepBuses & (1 << b))) continue;
+        addTiming(_busTiming[b], _sweepBusUs[b]);
+        _windowBusUs[b] += _sweepBusUs[b];
+    }
+    uint32_t windowMs = now - _windowStartMs;
+    if (windowMs >= OCCUPANCY_WINDOW_MS) {
+        for (uint8_t b = 0; b < (uint8_t)Bus::COUNT; b++) {
+            // Microseconds busy per millisecond of wall time is per mille
+            _occupancy[b].permille = (uint16_t)(_windowBusUs[b] / windowMs);
+            _occupancy[b].readsPerMin = (uint16_t)((uint64_t)_windowReads[b] * 60000 / windowMs);
+            _windowBusUs[b] = 0;
+            _windowReads[b] = 0;
+        }
+        _windowStartMs = now;
+    }
+    // One notification per sweep, however many sensors changed
+    if (_sweepChanges != 0) __atomic_fetch_or(&_pendingChanges, _sweepChanges, __ATOMIC_RELEASE);
+}
+
+uint32_t SensorAcquisition::msUntilDue(uint32_t now) const {
+    uint32_t wait = UINT32_MAX;
+    for (uint8_t i = 0; i < _count; i++) {
+        int32_t remain = (int32_t)(_entries[i].dueMs - now);
+        uint32_t ms = remain > 0 ? (uint32_t)remain : 1;
+        if (ms < wait) wait = ms;
+    }
+    return wait == UINT32_MAX ? TIERS[(uint8_t)Tier::NORMAL].intervalMs : wait;
+}
+
+bool SensorAcquisition::serviceChanges() {
+    if (_pendingChanges == 0) return false;
+    uint32_t changes = __atomic_exchange_n(&_pendingChanges, 0, __ATOMIC_ACQUIRE);
+    for (uint8_t i = 0; i < _count; i++) {
+        if (changes & (1UL << i)) _entries[i].sensor->fireChangeCallback();
+    }
+    return changes != 0;
+}
+
+bool SensorAcquisition::getSensorTiming(const TempSensor* sensor, Timing& out) const {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_entries[i].sensor != sensor) continue;
+        out = _entries[i].timing;
+        return true;
+    }
+    return false;
+}
+
+bool SensorAcquisition::getSensorSchedule(const TempSensor* sensor, Schedule& out) const {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_entries[i].sensor != sensor) continue;
+        out = _entries[i].schedule;
+        return true;
+    }
+    return false;
+}
+
+// Sets ALERT1 (rising) and ALERT2 (falling) around value at the nearest
+// thresholds. Comparator mode: an output stays asserted while its limit is
+// passed, until the read it triggers moves the limits. Caller holds I2cBus.
+void SensorAcquisition::armAlerts(Entry& entry, DeciF value) {
+    int32_t high = value + ALERT_BAND;
+    int32_t low = value - ALERT_BAND;
+    portENTER_CRITICAL_SAFE(&_mux);
+    for (uint8_t t = 0; t < entry.thresholdCount; t++) {
+        DeciF limit = entry.thresholds[t];
+        if (limit > value && limit < high) high = limit;
+        if (limit < value && limit > low) low = limit;
+    }
+    portEXIT_CRITICAL_SAFE(&_mux);
+    if (high < value + ALERT_MIN) high = value + ALERT_MIN;
+    if (low > value - ALERT_MIN) low = value - ALERT_MIN;
+    if (entry.alertArmed && abs(high - entry.alertHigh) < ALERT_STEP &&
+        abs(low - entry.alertLow) < ALERT_STEP) {
+        return;
+    }
+
+    Adafruit_MCP9600* mcp = entry.sensor->getMCP9600();
+    // The MCP9600 compares the hot junction in °C
+    mcp->setAlertTemperature(1, (fromDeciF((DeciF)high) - 32.0f) * 5.0f / 9.0f);
+    mcp->setAlertTemperature(2, (fromDeciF((DeciF)low) - 32.0f) * 5.0f / 9.0f);
+    if (!entry.alertArmed) {
+        mcp->configureAlert(1, true, true);
+        mcp->configureAlert(2, true, false);
+    }
+    entry.alertArmed = true;
+    entry.alertHigh = (DeciF)high;
+    entry.alertLow = (DeciF)low;
+}
+
+bool SensorAcquisition::getSensorHealth(const TempSensor* sensor, Health& out) const {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_entries[i].sensor != sensor) continue;
+        out = _entries[i].health;
+        return true;
+    }
+    return false;
+}
+
+const char* SensorAcquisition::getTierName(Tier tier) {
+    switch (tier) {
+        case Tier::CRITICAL: return "critical";
+        case Tier::NEAR: return "near";
+        case Tier::NORMAL: return "normal";
+        case Tier::FAR: return "far";
+        default: return "";
+    }
+}
+
+void SensorAcquisition::addTiming(Timing& timing, uint32_t us) {
+    timing.lastUs = us;
+    if (us > timing.maxUs) timing.maxUs = us;
+    timing.count++;
+    timing.totalUs += us;
+}
@@ -0,0 +1,93 @@
+#include "TempFilter.h"
+
+const TempFilter::Config TempFilter::DEFAULTS = {1, 0.0f, 0.0f, 0.33f};
+
+TempFilter::TempFilter()
+    : _config(DEFAULTS)
+    , _tauMs(0.0f)
+    , _slewPerMs(0.0f)
+    , _deadband(toDeciF(DEFAULTS.deadbandF))
+    , _window{}
+    , _windowCount(0)
+    , _windowHead(0)
+    , _primed(false)
+    , _ema(0.0f)
+    , _out(0.0f)
+    , _published(0)
+    , _lastMs(0)
+    , _suppressed(0)
+{
+}
+
+void TempFilter::configure(const Config& config) {
+    _config = config;
+    if (_config.median < 1) _config.median = 1;
+    if (_config.median > MAX_MEDIAN) _config.median = MAX_MEDIAN;
+    if ((_config.median & 1) == 0) _config.median--;    // An even window has no middle reading
+    if (!(_config.emaTauSec > 0.0f)) _config.emaTauSec = 0.0f;
+    if (!(_config.slewFPerSec > 0.0f)) _config.slewFPerSec = 0.0f;
+    if (!(_config.deadbandF > 0.0f)) _config.deadbandF = 0.0f;
+    _tauMs = _config.emaTauSec * 1000.0f;
+    _slewPerMs = _config.slewFPerSec / 100.0f;      // °F/s to tenths/ms
+    _deadband = toDeciF(_config.deadbandF);
+    reset();
+}
+
+void TempFilter::reset() {
+    _windowCount = 0;
+    _windowHead = 0;
+    _primed = false;
+}
+
+// Median of the readings in the window, sorted on the stack. While the
+// window fills, the middle of what it holds so far.
+DeciF TempFilter::median(DeciF raw) {
+    _window[_windowHead] = raw;
+    _windowHead = (_windowHead + 1) % _config.median;
+    if (_windowCount < _config.median) _windowCount++;
+
+    DeciF sorted[MAX_MEDIAN];
+    for (uint8_t i = 0; i < _windowCount; i++) {
+        DeciF v = _window[i];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+    }
+    return sorted[_windowCount / 2];
+}
+
+bool TempFilter::apply(DeciF raw, uint32_t nowMs, DeciF& out) {
+    DeciF m = _config.median > 1 ? median(raw) : raw;
+    if (!_primed) {
+        _primed = true;
+        _ema = m;
+        _out = m;
+        _published = m;
+        _lastMs = nowMs;
+        out = m;
+        return true;
+    }
+    uint32_t dtMs = nowMs - _lastMs;
+    _lastMs = nowMs;
+
+    float x = m;
+    if (_tauMs > 0.0f) {
+        _ema += (1.0f - expf(-(float)dtMs / _tauMs)) * (x - _ema);
+        x = _ema;
+    }
+    if (_slewPerMs > 0.0f) {
+        float step = _slewPerMs * dtMs;
+        if (x > _out + step) x = _out + step;
+        else if (x < _out - step) x = _out - step;
+    }
+    _out = x;
+
+    DeciF filtered = (DeciF)lroundf(x);
+    if (abs(filtered - _published) > _deadband) {
+        _published = filtered;
+        out = filtered;
+        return true;
+    }
+    if (abs(raw - _published) > _deadband) _suppressed++;
+    return false;
+}
@@ -0,0 +1,33 @@
+#include "TempFixed.h"
+#include <stdio.h>
+
+int formatDeciF(char* buf, size_t len, DeciF d) {
+    int32_t v = d;
+    const char* sign = v < 0 ? "-" : "";
+    if (v < 0) v = -v;
+    return snprintf(buf, len, "%s%ld.%ld", sign, (long)(v / 10), (long)(v % 10));
+}
+
+bool parseDeciF(const char*& p, DeciF& out) {
+    const char* s = p;
+    bool negative = *s == '-';
+    if (negative || *s == '+') s++;
+    if (*s < '0' || *s > '9') return false;
+
+    int32_t tenths = 0;
+    while (*s >= '0' && *s <= '9') {
+        tenths = tenths * 10 + (*s++ - '0');
+        if (tenths > INT16_MAX) return false;
+    }
+    tenths *= 10;
+    if (*s == '.') {
+        s++;
+        if (*s >= '0' && *s <= '9') tenths += *s++ - '0';
+        if (*s >= '5' && *s <= '9') tenths++;   // Round on the hundredths digit
+        while (*s >= '0' && *s <= '9') s++;
+    }
+    if (tenths > INT16_MAX) return false;
+    out = (DeciF)(negative ? -tenths : tenths);
+    p = s;
+    return true;
+}
@@ -13,27 +13,32 @@ const char* TempHistory::sensorKeys[MAX_SENSORS] = {
 
 void TempHistory::begin() {
     for (int i = 0; i < MAX_SENSORS; i++) {
-        _buffers[i] = (TempSample*)ps_malloc(MAX_SAMPLES * sizeof(TempSample));
-        if (!_buffers[i]) {
+        _epochs[i] = (uint32_t*)ps_malloc(MAX_SAMPLES * sizeof(uint32_t));
+        _temps[i] = (DeciF*)ps_malloc(MAX_SAMPLES * sizeof(DeciF));
+        if (!_epochs[i] || !_temps[i]) {
             Log.error("THIST", "Failed to allocate PSRAM for sensor %d", i);
+            free(_epochs[i]);
+            free(_temps[i]);
+            _epochs[i] = nullptr;
+            _temps[i] = nullptr;
         }
         _head[i] = 0;
         _count[i] = 0;
     }
     Log.info("THIST", "Allocated %d bytes PSRAM for temp history",
-             MAX_SENSORS * MAX_SAMPLES * (int)sizeof(TempSample));
+             MAX_SENSORS * MAX_SAMPLES * (int)(sizeof(uint32_t) + sizeof(DeciF)));
 }
 
-void TempHistory::addSample(int sensorIdx, uint32_t epoch, float temp) {
-    if (sensorIdx < 0 || sensorIdx >= MAX_SENSORS || !_buffers[sensorIdx]) return;
-    _buffers[sensorIdx][_head[sensorIdx]].epoch = epoch;
-    _buffers[sensorIdx][_head[sensorIdx]].temp = temp;
+void TempHistory::addSample(int sensorIdx, uint32_t epoch, DeciF temp) {
+    if (sensorIdx < 0 || sensorIdx >= MAX_SENSORS || !_epochs[sensorIdx]) return;
+    _epochs[sensorIdx][_head[sensorIdx]] = epoch;
+    _temps[sensorIdx][_head[sensorIdx]] = temp;
     _head[sensorIdx] = (_head[sensorIdx] + 1) % MAX_SAMPLES;
     if (_count[sensorIdx] < MAX_SAMPLES) _count[sensorIdx]++;
 }
 
 int TempHistory::getSamples(int sensorIdx, uint32_t sinceEpoch, TempSample* out, int maxOut) {
-    if (sensorIdx < 0 || sensorIdx >= MAX_SENSORS || !_buffers[sensorIdx] || !out) return 0;
+    if (sensorIdx < 0 || sensorIdx >= MAX_SENSORS || !_epochs[sensorIdx] || !out) return 0;
 
     int count = _count[sensorIdx];
     int head = _head[sensorIdx];
@@ -43,8 +48,8 @@ int TempHistory::getSamples(int sensorIdx, uint32_t sinceEpoch, TempSample* out,
     int written = 0;
     for (int i = 0; i < count && written < maxOut; i++) {
         int idx = (start + i) % MAX_SAMPLES;
-        if (_buffers[sensorIdx][idx].epoch >= sinceEpoch) {
-            out[written++] = _buffers[sensorIdx][idx];
+        if (_epochs[sensorIdx][idx] >= sinceEpoch) {
+            out[written++] = {_epochs[sensorIdx][idx], _temps[sensorIdx][idx]};
         }
     }
     return written;
@@ -65,7 +70,7 @@ void TempHistory::backfillFromSD() {
     time_t cutoff = now - (7 * 86400);  // 7 days back
 
     for (int s = 0; s < MAX_SENSORS; s++) {
-        if (!_buffers[s]) continue;
+        if (!_epochs[s]) continue;
 
         char dirPath[32];
         snprintf(dirPath, sizeof(dirPath), "/temps/%s", sensorDirs[s]);
@@ -133,13 +138,15 @@ void TempHistory::backfillFromSD() {
                 line[len] = '\0';
                 if (len == 0) continue;
 
-                long epoch = 0;
-                float temp = 0;
-                if (sscanf(line, "%ld,%f", &epoch, &temp) == 2) {
-                    if ((time_t)epoch >= cutoff) {
-                        addSample(s, (uint32_t)epoch, temp);
-                        totalRows++;
-                    }
+                // "epoch,temp" - parsed by hand, no float conversion
+                char* p = line;
+                unsigned long epoch = strtoul(line, &p, 10);
+                if (p == line || *p != ',') continue;
+                const char* t = p + 1;
+                DeciF temp;
+                if (parseDeciF(t, temp) && (time_t)epoch >= cutoff) {
+                    addSample(s, (uint32_t)epoch, temp);
+                    totalRows++;
                 }
             }
             f.close();
@@ -3,10 +3,8 @@
 TempSensor::TempSensor()
     : _description("")
     , _deviceAddress(nullptr)
-    , _value(0.0f)
-    , _previous(0.0f)
-    , _valid(false)
-    , _onUpdate(nullptr)
+    , _reading{0, 0, false}
+    , _seq(0)
     , _onChange(nullptr)
     , _mcp9600(nullptr)
 {
@@ -17,10 +15,8 @@ TempSensor::TempSensor()
 TempSensor::TempSensor(const String& description)
     : _description(description)
     , _deviceAddress(nullptr)
-    , _value(0.0f)
-    , _previous(0.0f)
-    , _valid(false)
-    , _onUpdate(nullptr)
+    , _reading{0, 0, false}
+    , _seq(0)
     , _onChange(nullptr)
     , _mcp9600(nullptr)
 {
@@ -41,53 +37,71 @@ void TempSensor::setDeviceAddress(uint8_t* address) {
     }
 }
 
-void TempSensor::setValue(float value) {
-    _previous = _value;
-    _value = value;
-    _valid = (value != DEVICE_DISCONNECTED_F);
-}
-
-void TempSensor::update(DallasTemperature* sensors, float threshold) {
-    // MCP9600 I2C thermocouple path
-    if (_mcp9600 != nullptr) {
-        float tempC = _mcp9600->readThermocouple();
-        float tempF = tempC * 9.0f / 5.0f + 32.0f;
-        updateValue(tempF, threshold);
-        return;
+// Seqlock reader: retries only while the acquisition task is inside publish()
+TempSensor::Reading TempSensor::getReading() const {
+    for (;;) {
+        uint32_t seq = _seq;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (seq & 1) continue;
+        Reading reading = {getDeciF(), getPreviousDeciF(), isValid()};
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (_seq == seq) return reading;
     }
+}
 
-    // OneWire DallasTemperature path
-    if (sensors == nullptr || _deviceAddress == nullptr) {
-        return;
-    }
+void TempSensor::publish(const Reading& reading) {
+    _seq = _seq + 1;  // Odd: write in progress
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    __atomic_store_n(&_reading.deciF, reading.deciF, __ATOMIC_RELAXED);
+    __atomic_store_n(&_reading.previousDeciF, reading.previousDeciF, __ATOMIC_RELAXED);
+    __atomic_store_n(&_reading.valid, reading.valid, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    _seq = _seq + 1;  // Even: stable
+}
 
-    float rawTemp = sensors->getTemp(_deviceAddress);
-    float tempF = DallasTemperature::rawToFahrenheit(rawTemp);
-    float delta = abs(_previous - tempF);
+void TempSensor::setDeciF(DeciF value) {
+    publish({value, _reading.deciF, value != DECIF_DISCONNECTED});
+}
 
-    if (delta > threshold) {
-        _previous = _value;
-        _value = tempF;
-        _valid = (_value != DEVICE_DISCONNECTED_F);
-        fireChangeCallback();
-    }
+void TempSensor::setPreviousDeciF(DeciF previous) {
+    publish({_reading.deciF, previous, _reading.valid});
 }
 
-void TempSensor::updateValue(float tempF, float threshold) {
-    float delta = abs(_previous - tempF);
+void TempSensor::setValid(bool valid) {
+    publish({_reading.deciF, _reading.previousDeciF, valid});
+}
 
-    if (delta > threshold) {
-        _previous = _value;
-        _value = tempF;
-        _valid = true;
-        fireChangeCallback();
+// Scratchpad layout (DS18B20 datasheet)
+static const uint8_t SCRATCHPAD_TEMP_LSB = 0;
+static const uint8_t SCRATCHPAD_TEMP_MSB = 1;
+static const uint8_t SCRATCHPAD_CRC = 8;
+
+// getTemp() folds a missing device and a failed CRC into one
+// DEVICE_DISCONNECTED_RAW; reading the scratchpad here keeps them apart
+TempSensor::ReadStatus TempSensor::readRaw(DallasTemperature* sensors, int32_t& raw) {
+    if (sensors == nullptr || _deviceAddress == nullptr) return ReadStatus::DISCONNECTED;
+    ScratchPad scratchPad;
+    if (!sensors->readScratchPad(_deviceAddress, scratchPad)) return ReadStatus::DISCONNECTED;
+    bool allZeros = true;
+    for (uint8_t i = 0; i < sizeof(ScratchPad); i++) {
+        if (scratchPad[i] != 0) allZeros = false;
     }
+    // A shorted bus reads all zeros, which passes the CRC
+    if (allZeros || OneWire::crc8(scratchPad, SCRATCHPAD_CRC) != scratchPad[SCRATCHPAD_CRC]) {
+        return ReadStatus::CRC_ERROR;
+    }
+    raw = ((int32_t)(int8_t)scratchPad[SCRATCHPAD_TEMP_MSB] << 11) | ((int32_t)scratchPad[SCRATCHPAD_TEMP_LSB] << 3);
+    return ReadStatus::OK;
 }
 
-void TempSensor::fireUpdateCallback() {
-    if (_onUpdate != nullptr) {
-        _onUpdate(this);
-    }
+bool TempSensor::updateValue(DeciF value, uint32_t nowMs) {
+    // A sensor coming back from invalid starts its filter over and
+    // publishes whatever it reads
+    if (!_reading.valid) _filter.reset();
+    DeciF filtered;
+    if (!_filter.apply(value, nowMs, filtered)) return false;
+    publish({filtered, _reading.deciF, true});
+    return true;
 }
 
 void TempSensor::fireChangeCallback() {
@@ -138,7 +152,6 @@ String TempSensor::getDefaultDescription(uint8_t index) {
 }
 
 void TempSensor::discoverSensors(DallasTemperature* sensors, TempSensorMap& tempMap,
-                                  TempSensorCallback updateCallback,
                                   TempSensorCallback changeCallback) {
     if (sensors == nullptr) {
         return;
@@ -158,9 +171,6 @@ void TempSensor::discoverSensors(DallasTemperature* sensors, TempSensorMap& temp
         if (changeCallback != nullptr) {
             sensor->setChangeCallback(changeCallback);
         }
-        if (updateCallback != nullptr) {
-            sensor->setUpdateCallback(updateCallback);
-        }
 
         if (tempMap.count(description) == 0) {
             tempMap[description] = sensor;
@@ -0,0 +1,140 @@
+#include "TraceRecorder.h"
+#include "Logger.h"
+#include <esp_timer.h>
+
+TraceRecorder Trace;
+
+TraceRecorder::TraceRecorder()
+    : _ring(nullptr)
+    , _capacity(0)
+    , _mask(0)
+    , _head(0)
+    , _mux(portMUX_INITIALIZER_UNLOCKED)
+{
+}
+
+bool TraceRecorder::begin(uint32_t capacity) {
+    if (_ring != nullptr) return true;
+    // Power of two so the ring index is a mask
+    uint32_t size = 1;
+    while (size * 2 <= capacity) size *= 2;
+    _ring = (TraceRecord*)ps_malloc(size * sizeof(TraceRecord));
+    if (_ring == nullptr) {
+        Log.error("TRACE", "Failed to allocate %u trace records", size);
+        return false;
+    }
+    memset(_ring, 0, size * sizeof(TraceRecord));
+    _capacity = size;
+    _mask = size - 1;
+    _head = 0;
+    Log.info("TRACE", "Trace ring: %u records (%u KB)", size, (size * sizeof(TraceRecord)) / 1024);
+    return true;
+}
+
+void TraceRecorder::clear() {
+    portENTER_CRITICAL_SAFE(&_mux);
+    _head = 0;
+    portEXIT_CRITICAL_SAFE(&_mux);
+}
+
+void TraceRecorder::record(TraceEvent type, uint8_t id, uint32_t value, uint32_t aux) {
+    recordAt(esp_timer_get_time(), type, id, value, aux);
+}
+
+void TraceRecorder::recordAt(uint64_t timeUs, TraceEvent type, uint8_t id, uint32_t value, uint32_t aux) {
+    if (_ring == nullptr) return;
+    portENTER_CRITICAL_SAFE(&_mux);
+    TraceRecord& r = _ring[_head & _mask];
+    r.ms = (uint32_t)(timeUs / 1000);
+    r.us = (uint16_t)(timeUs % 1000);
+    r.type = (uint8_t)type;
+    r.id = id;
+    r.value = value;
+    r.aux = aux;
+    _head = _head + 1;
+    portEXIT_CRITICAL_SAFE(&_mux);
+}
+
+void TraceRecorder::recordFloat(TraceEvent type, uint8_t id, float value, uint32_t aux) {
+    record(type, id, fromFloat(value), aux);
+}
+
+// Sign-extended, so a replayed value reads back with toDeciF()
+void TraceRecorder::recordDeciF(TraceEvent type, uint8_t id, DeciF value, uint32_t aux) {
+    record(type, id, (uint32_t)(int32_t)value, aux);
+}
+
+uint32_t TraceRecorder::getCount() const {
+    uint32_t head = _head;
+    return head < _capacity ? head : _capacity;
+}
+
+TraceRecorder::Export TraceRecorder::beginExport() const {
+    Export exp;
+    portENTER_CRITICAL_SAFE(&_mux);
+    uint32_t head = _head;
+    portEXIT_CRITICAL_SAFE(&_mux);
+    exp.count = head < _capacity ? head : _capacity;
+    exp.startSeq = head - exp.count;
+    exp.dropped = exp.startSeq;
+    return exp;
+}
+
+size_t TraceRecorder::exportSize(const Export& exp) const {
+    return sizeof(TraceFileHeader) + (size_t)exp.count * sizeof(TraceRecord);
+}
+
+bool TraceRecorder::readRecord(uint32_t seq, TraceRecord& out) const {
+    bool valid;
+    portENTER_CRITICAL_SAFE(&_mux);
+    // Still in the ring unless the writer has lapped it since the export began
+    valid = (_head - seq) <= _capacity;
+    if (valid) out = _ring[seq & _mask];
+    portEXIT_CRITICAL_SAFE(&_mux);
+    return valid;
+}
+
+size_t TraceRecorder::readExport(const Export& exp, size_t offset, uint8_t* buf, size_t maxLen) const {
+    size_t total = exportSize(exp);
+    if (offset >= total) return 0;
+    if (maxLen > total - offset) maxLen = total - offset;
+
+    size_t written = 0;
+    if (offset < sizeof(TraceFileHeader)) {
+        TraceFileHeader hdr;
+        memcpy(hdr.magic, "GHPT", 4);
+        hdr.version = VERSION;
+        hdr.recordSize = sizeof(TraceRecord);
+        hdr.count = exp.count;
+        hdr.dropped = exp.dropped;
+        size_t n = sizeof(hdr) - offset;
+        if (n > maxLen) n = maxLen;
+        memcpy(buf, (const uint8_t*)&hdr + offset, n);
+        written += n;
+    }
+
+    while (written < maxLen) {
+        size_t pos = offset + written - sizeof(TraceFileHeader);
+        uint32_t index = pos / sizeof(TraceRecord);
+        size_t within = pos % sizeof(TraceRecord);
+        TraceRecord r;
+        if (!readRecord(exp.startSeq + index, r)) memset(&r, 0, sizeof(r));
+        size_t n = sizeof(TraceRecord) - within;
+        if (n > maxLen - written) n = maxLen - written;
+        memcpy(buf + written, (const uint8_t*)&r + within, n);
+        written += n;
+    }
+    return written;
+}
+
+float TraceRecorder::toFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint32_t TraceRecorder::fromFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
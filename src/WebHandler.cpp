@@ -4,11 +4,14 @@
 #include "TempSensor.h"
 #include "TempHistory.h"
 #include "OtaUtils.h"
+#include "TraceRecorder.h"
+#include "I2CBus.h"
 
 extern const char compile_date[];
 
 extern uint8_t getCpuLoadCore0();
 extern uint8_t getCpuLoadCore1();
+extern uint32_t getInputEventOverflows();
 extern bool _apModeActive;
 
 WebHandler::WebHandler(uint16_t port, Scheduler* ts, GoodmanHP* hpController)
@@ -286,7 +289,9 @@ void WebHandler::setupRoutes() {
                 json += "[";
                 json += String(buf[i].epoch);
                 json += ",";
-                json += String(buf[i].temp, 1);
+                char temp[8];
+                formatDeciF(temp, sizeof(temp), buf[i].temp);
+                json += temp;
                 json += "]";
                 first = false;
             }
@@ -373,9 +378,35 @@ void WebHandler::setupRoutes() {
                 json += "{";
                 json += "\"description\":\"" + m.second->getDescription() + "\"";
                 json += ",\"devid\":\"" + TempSensor::addressToString(m.second->getDeviceAddress()) + "\"";
-                json += ",\"value\":" + String(m.second->getValue());
-                json += ",\"previous\":" + String(m.second->getPrevious());
-                json += ",\"valid\":\"" + String(m.second->isValid() ? "true" : "false") + "\"";
+                TempSensor::Reading reading = m.second->getReading();
+                const SensorAcquisition& acq = _hpController->getSensorAcquisition();
+                SensorAcquisition::Timing timing = {};
+                SensorAcquisition::Schedule schedule = {};
+                SensorAcquisition::Health health = {};
+                acq.getSensorTiming(m.second, timing);
+                acq.getSensorSchedule(m.second, schedule);
+                acq.getSensorHealth(m.second, health);
+                json += ",\"value\":" + String(fromDeciF(reading.deciF));
+                json += ",\"previous\":" + String(fromDeciF(reading.previousDeciF));
+                json += ",\"valid\":\"" + String(reading.valid ? "true" : "false") + "\"";
+                json += ",\"readUs\":" + String(timing.lastUs);
+                json += ",\"readMaxUs\":" + String(timing.maxUs);
+                json += ",\"readAvgUs\":" + String(timing.avgUs());
+                json += ",\"tier\":\"" + String(SensorAcquisition::getTierName(schedule.tier)) + "\"";
+                json += ",\"intervalMs\":" + String(schedule.intervalMs);
+                json += ",\"resolution\":" + String(schedule.resolution);
+                json += ",\"marginF\":" + (!isfinite(schedule.marginF) ? String("null") : String(schedule.marginF));
+                json += ",\"rateFps\":" + String(schedule.rateFps, 3);
+                json += ",\"crcErrors\":" + String(health.crcErrors);
+                json += ",\"disconnects\":" + String(health.disconnects);
+                json += ",\"timeouts\":" + String(health.timeouts);
+                json += ",\"retries\":" + String(health.retries);
+                json += ",\"powerOnResets\":" + String(health.powerOnResets);
+                json += ",\"implausible\":" + String(health.implausible);
+                json += ",\"failedReads\":" + String(health.failedReads);
+                json += ",\"busBusy\":" + String(health.busBusy);
+                json += ",\"alerts\":" + String(health.alerts);
+                json += ",\"filterSuppressed\":" + String(m.second->getFilter().getSuppressedCount());
                 json += "}";
             }
             firstTime = false;
@@ -384,17 +415,71 @@ void WebHandler::setupRoutes() {
         request->send(200, "application/json", json);
     });
 
-    _server.on("/heap", HTTP_GET, [](AsyncWebServerRequest *request) {
+    _server.on("/heap", HTTP_GET, [this](AsyncWebServerRequest *request) {
         String json = "{";
         json += "\"free heap\":" + String(ESP.getFreeHeap());
         json += ",\"free psram MB\":" + String(ESP.getFreePsram() * MB_MULTIPLIER);
         json += ",\"used psram MB\":" + String((ESP.getPsramSize() - ESP.getFreePsram()) * MB_MULTIPLIER);
         json += ",\"cpuLoad0\":" + String(getCpuLoadCore0());
         json += ",\"cpuLoad1\":" + String(getCpuLoadCore1());
+        json += ",\"inputEventOverflows\":" + String(getInputEventOverflows());
+        const SensorAcquisition& acq = _hpController->getSensorAcquisition();
+        const SensorAcquisition::Timing& oneWire = acq.getBusTiming(SensorAcquisition::Bus::ONE_WIRE);
+        const SensorAcquisition::Timing& i2c = acq.getBusTiming(SensorAcquisition::Bus::I2C);
+        json += ",\"oneWireSweepUs\":" + String(oneWire.lastUs);
+        json += ",\"oneWireSweepMaxUs\":" + String(oneWire.maxUs);
+        json += ",\"oneWireSweepAvgUs\":" + String(oneWire.avgUs());
+        json += ",\"oneWireConversionMs\":" + String(acq.getConversionMs());
+        json += ",\"i2cSweepUs\":" + String(i2c.lastUs);
+        json += ",\"i2cSweepMaxUs\":" + String(i2c.maxUs);
+        json += ",\"i2cSweepAvgUs\":" + String(i2c.avgUs());
+        SensorAcquisition::Occupancy oneWireLoad = acq.getBusOccupancy(SensorAcquisition::Bus::ONE_WIRE);
+        SensorAcquisition::Occupancy i2cLoad = acq.getBusOccupancy(SensorAcquisition::Bus::I2C);
+        json += ",\"oneWireOccupancyPermille\":" + String(oneWireLoad.permille);
+        json += ",\"oneWireReadsPerMin\":" + String(oneWireLoad.readsPerMin);
+        json += ",\"i2cOccupancyPermille\":" + String(i2cLoad.permille);
+        json += ",\"i2cReadsPerMin\":" + String(i2cLoad.readsPerMin);
+        json += ",\"sensorResolutionWrites\":" + String(acq.getResolutionWrites());
+        json += ",\"i2cContentions\":" + String(I2cBus.getContentionCount());
         json += "}";
         request->send(200, "application/json", json);
     });
 
+    // --- Binary event trace (see TraceRecorder.h) ---
+    // Sub-paths first: "/trace" also matches "/trace/..."
+    _server.on("/trace/info", HTTP_GET, [](AsyncWebServerRequest *request) {
+        String json = "{";
+        json += "\"enabled\":" + String(Trace.isEnabled() ? "true" : "false");
+        json += ",\"capacity\":" + String(Trace.getCapacity());
+        json += ",\"count\":" + String(Trace.getCount());
+        json += ",\"total\":" + String(Trace.getTotal());
+        json += "}";
+        request->send(200, "application/json", json);
+    });
+
+    _server.on("/trace/clear", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (!checkAuth(request)) return;
+        Trace.clear();
+        Log.info("HTTP", "Event trace cleared");
+        request->send(200, "application/json", "{\"status\":\"ok\"}");
+    });
+
+    _server.on("/trace", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        if (!checkAuth(request)) return;
+        if (!Trace.isEnabled()) {
+            request->send(503, "application/json", "{\"error\":\"Trace not available\"}");
+            return;
+        }
+        // Bounds are fixed now; records overwritten mid-download come out as NONE
+        TraceRecorder::Export exp = Trace.beginExport();
+        AsyncWebServerResponse *response = request->beginResponse("application/octet-stream",
+            Trace.exportSize(exp), [exp](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                return Trace.readExport(exp, index, buffer, maxLen);
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"trace.ghpt\"");
+        request->send(response);
+    });
+
     _server.on("/theme", HTTP_GET, [this](AsyncWebServerRequest *request) {
         String theme = "dark";
         if (_config && _config->getProjectInfo()) {
@@ -405,39 +490,78 @@ void WebHandler::setupRoutes() {
     });
 
     _server.on("/state", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        GoodmanHP::Snapshot snap;
+        _hpController->readSnapshot(snap);
         JsonDocument doc;
-        doc["state"] = _hpController->getStateString();
+        doc["state"] = GoodmanHP::getStateName(snap.state);
 
         JsonObject inputs = doc["inputs"].to<JsonObject>();
-        for (auto& pair : _hpController->getInputMap()) {
-            if (pair.second != nullptr)
-                inputs[pair.first] = pair.second->isActive();
+        for (uint8_t i = 0; i < (uint8_t)GoodmanHP::InputId::COUNT; i++) {
+            if (snap.inputPresent & (1 << i))
+                inputs[GoodmanHP::getInputName((GoodmanHP::InputId)i)] = (bool)(snap.inputActive & (1 << i));
+        }
+        doc["inputGeneration"] = snap.inputGeneration;
+
+        JsonObject inputStats = doc["inputStats"].to<JsonObject>();
+        for (uint8_t i = 0; i < (uint8_t)GoodmanHP::InputId::COUNT; i++) {
+            if (!(snap.inputPresent & (1 << i))) continue;
+            InputPinStats st;
+            snap.getInputStats((GoodmanHP::InputId)i, st);
+            JsonObject o = inputStats[GoodmanHP::getInputName((GoodmanHP::InputId)i)].to<JsonObject>();
+            o["edges"] = st.edges;
+            o["rawEdges"] = st.rawEdges;
+            o["minPulseUs"] = st.minPulseUs;
+            o["activeMs"] = st.activeMs;
+            o["inactiveMs"] = st.inactiveMs;
+            JsonArray bounceHist = o["bounceHist"].to<JsonArray>();
+            for (uint8_t b = 0; b < InputPinStats::BUCKETS; b++) bounceHist.add(st.bounceHist[b]);
         }
 
         JsonObject outputs = doc["outputs"].to<JsonObject>();
-        for (auto& pair : _hpController->getOutputMap()) {
-            if (pair.second != nullptr)
-                outputs[pair.first] = pair.second->isPinOn();
+        for (uint8_t i = 0; i < (uint8_t)GoodmanHP::OutputId::COUNT; i++) {
+            if (snap.outputPresent & (1 << i))
+                outputs[GoodmanHP::getOutputName((GoodmanHP::OutputId)i)] = (bool)(snap.outputOn & (1 << i));
         }
 
-        doc["heatRuntimeMin"] = _hpController->getHeatRuntimeMs() / 60000UL;
-        doc["defrost"] = _hpController->isSoftwareDefrostActive();
-        doc["lpsFault"] = _hpController->isLPSFaultActive();
-        doc["lowTemp"] = _hpController->isLowTempActive();
-        doc["compressorOverTemp"] = _hpController->isCompressorOverTempActive();
-        doc["suctionLowTemp"] = _hpController->isSuctionLowTempActive();
-        doc["startupLockout"] = _hpController->isStartupLockoutActive();
-        doc["startupLockoutRemainSec"] = _hpController->getStartupLockoutRemainingMs() / 1000;
-        doc["shortCycleProtection"] = _hpController->isShortCycleProtectionActive();
-        doc["rvFail"] = _hpController->isRvFailActive();
-        doc["highSuctionTemp"] = _hpController->isHighSuctionTempActive();
-        doc["defrostTransition"] = _hpController->isDefrostTransitionActive();
-        doc["defrostTransitionRemainSec"] = _hpController->getDefrostTransitionRemainingMs() / 1000;
-        doc["defrostCntPending"] = _hpController->isDefrostCntPendingActive();
-        doc["defrostCntPendingRemainSec"] = _hpController->getDefrostCntPendingRemainingMs() / 1000;
-        doc["defrostExiting"] = _hpController->isDefrostExitingActive();
-        doc["manualOverride"] = _hpController->isManualOverrideActive();
-        doc["manualOverrideRemainSec"] = _hpController->getManualOverrideRemainingMs() / 1000;
+        JsonObject outputStats = doc["outputStats"].to<JsonObject>();
+        for (uint8_t i = 0; i < (uint8_t)GoodmanHP::OutputId::COUNT; i++) {
+            if (!(snap.outputPresent & (1 << i))) continue;
+            OutPinStats st;
+            snap.getOutputStats((GoodmanHP::OutputId)i, st);
+            JsonObject o = outputStats[GoodmanHP::getOutputName((GoodmanHP::OutputId)i)].to<JsonObject>();
+            o["onMs"] = st.onMs;
+            o["trackedMs"] = st.trackedMs;
+            o["dutyPct"] = st.trackedMs > 0 ? (float)((double)st.onMs * 100.0 / (double)st.trackedMs) : 0.0f;
+            o["cycles"] = st.cycles;
+            o["cyclesLastHour"] = snap.cyclesLastHour[i];
+            o["shortestOffMs"] = st.shortestOffMs;
+            JsonArray onHist = o["onHist"].to<JsonArray>();
+            JsonArray offHist = o["offHist"].to<JsonArray>();
+            for (uint8_t b = 0; b < OutPinStats::BUCKETS; b++) {
+                onHist.add(st.onHist[b]);
+                offHist.add(st.offHist[b]);
+            }
+        }
+
+        doc["heatRuntimeMin"] = snap.heatRuntimeMs / 60000UL;
+        doc["defrost"] = snap.softwareDefrost;
+        doc["lpsFault"] = snap.isProtectionActive(GoodmanHP::ProtectionId::LPS_FAULT);
+        doc["lowTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::LOW_AMBIENT);
+        doc["compressorOverTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::COMPRESSOR_OVERTEMP);
+        doc["suctionLowTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::SUCTION_LOW_TEMP);
+        doc["startupLockout"] = snap.startupLockout;
+        doc["startupLockoutRemainSec"] = snap.remainingMs(snap.startupLockoutRemainMs) / 1000;
+        doc["shortCycleProtection"] = snap.shortCycleProtection;
+        doc["rvFail"] = snap.rvFail;
+        doc["highSuctionTemp"] = snap.isProtectionActive(GoodmanHP::ProtectionId::HIGH_SUCTION_TEMP);
+        doc["defrostTransition"] = snap.defrostTransition;
+        doc["defrostTransitionRemainSec"] = snap.remainingMs(snap.defrostTransitionRemainMs) / 1000;
+        doc["defrostCntPending"] = snap.defrostCntPending;
+        doc["defrostCntPendingRemainSec"] = snap.remainingMs(snap.defrostCntPendingRemainMs) / 1000;
+        doc["defrostExiting"] = snap.defrostExiting;
+        doc["defrostPhase"] = GoodmanHP::getDefrostPhaseName(snap.defrostPhase);
+        doc["manualOverride"] = snap.manualOverride;
+        doc["manualOverrideRemainSec"] = snap.remainingMs(snap.manualOverrideRemainMs) / 1000;
         doc["cpuLoad0"] = getCpuLoadCore0();
         doc["cpuLoad1"] = getCpuLoadCore1();
         doc["freeHeap"] = ESP.getFreeHeap();
@@ -454,9 +578,8 @@ void WebHandler::setupRoutes() {
         }
 
         JsonObject temps = doc["temps"].to<JsonObject>();
-        for (const auto& m : _hpController->getTempSensorMap()) {
-            if (m.second != nullptr && m.second->isValid())
-                temps[m.first] = m.second->getValue();
+        for (uint8_t i = 0; i < snap.tempCount; i++) {
+            temps[snap.temps[i].name] = fromDeciF(snap.temps[i].deciF);
         }
 
         String json;
@@ -555,10 +678,16 @@ void WebHandler::setupRoutes() {
         request->send(200, "application/json", "{\"status\":\"ok\"}");
     });
 
+    // Locks the bus per probe, so a sensor read waits at most one address
     _server.on("/i2c/scan", HTTP_GET, [](AsyncWebServerRequest *request) {
         String json = "[";
         bool first = true;
         for (uint8_t addr = 1; addr < 127; addr++) {
+            I2CBus::Lock lock(I2cBus, I2CBus::SCAN_WAIT_MS);
+            if (!lock.locked()) {
+                request->send(503, "application/json", "{\"error\":\"I2C bus busy\"}");
+                return;
+            }
             Wire.beginTransmission(addr);
             if (Wire.endTransmission() == 0) {
                 if (!first) json += ",";
@@ -576,40 +705,47 @@ void WebHandler::setupRoutes() {
     _server.on("/pins", HTTP_GET, [this](AsyncWebServerRequest *request) {
         if (!checkAuth(request)) return;
         if (request->hasParam("format") && request->getParam("format")->value() == "json") {
+            GoodmanHP::Snapshot snap;
+            _hpController->readSnapshot(snap);
             JsonDocument doc;
-            doc["manualOverride"] = _hpController->isManualOverrideActive();
-            doc["manualOverrideRemainSec"] = _hpController->getManualOverrideRemainingMs() / 1000;
-            doc["shortCycleActive"] = _hpController->isShortCycleProtectionActive();
-            doc["state"] = _hpController->getStateString();
-            doc["defrost"] = _hpController->isSoftwareDefrostActive();
-            doc["defrostTransition"] = _hpController->isDefrostTransitionActive();
-            doc["defrostCntPending"] = _hpController->isDefrostCntPendingActive();
-            doc["defrostExiting"] = _hpController->isDefrostExitingActive();
+            doc["manualOverride"] = snap.manualOverride;
+            doc["manualOverrideRemainSec"] = snap.remainingMs(snap.manualOverrideRemainMs) / 1000;
+            doc["shortCycleActive"] = snap.shortCycleProtection;
+            doc["state"] = GoodmanHP::getStateName(snap.state);
+            doc["defrost"] = snap.softwareDefrost;
+            doc["defrostTransition"] = snap.defrostTransition;
+            doc["defrostCntPending"] = snap.defrostCntPending;
+            doc["defrostExiting"] = snap.defrostExiting;
+            doc["defrostPhase"] = GoodmanHP::getDefrostPhaseName(snap.defrostPhase);
 
             JsonArray inputs = doc["inputs"].to<JsonArray>();
-            for (auto& pair : _hpController->getInputMap()) {
-                if (pair.second != nullptr) {
+            for (uint8_t i = 0; i < (uint8_t)GoodmanHP::InputId::COUNT; i++) {
+                if (snap.inputPresent & (1 << i)) {
                     JsonObject inp = inputs.add<JsonObject>();
-                    inp["pin"] = pair.second->getPin();
-                    inp["name"] = pair.first;
-                    inp["active"] = pair.second->isActive();
+                    inp["pin"] = snap.inputPin[i];
+                    inp["name"] = GoodmanHP::getInputName((GoodmanHP::InputId)i);
+                    inp["active"] = (bool)(snap.inputActive & (1 << i));
+                    InputPinStats st;
+                    snap.getInputStats((GoodmanHP::InputId)i, st);
+                    inp["edges"] = st.edges;
+                    inp["rawEdges"] = st.rawEdges;
+                    inp["minPulseUs"] = st.minPulseUs;
                 }
             }
 
             JsonArray outputs = doc["outputs"].to<JsonArray>();
-            for (auto& pair : _hpController->getOutputMap()) {
-                if (pair.second != nullptr) {
+            for (uint8_t i = 0; i < (uint8_t)GoodmanHP::OutputId::COUNT; i++) {
+                if (snap.outputPresent & (1 << i)) {
                     JsonObject out = outputs.add<JsonObject>();
-                    out["pin"] = pair.second->getPin();
-                    out["name"] = pair.first;
-                    out["on"] = pair.second->isPinOn();
+                    out["pin"] = snap.outputPin[i];
+                    out["name"] = GoodmanHP::getOutputName((GoodmanHP::OutputId)i);
+                    out["on"] = (bool)(snap.outputOn & (1 << i));
                 }
             }
 
             JsonObject temps = doc["temps"].to<JsonObject>();
-            for (const auto& m : _hpController->getTempSensorMap()) {
-                if (m.second != nullptr && m.second->isValid())
-                    temps[m.first] = m.second->getValue();
+            for (uint8_t i = 0; i < snap.tempCount; i++) {
+                temps[snap.temps[i].name] = fromDeciF(snap.temps[i].deciF);
             }
 
             String json;
@@ -628,10 +764,14 @@ void WebHandler::setupRoutes() {
         // Toggle manual override
         if (data["manualOverride"].is<bool>()) {
             bool on = data["manualOverride"] | false;
-            _hpController->setManualOverride(on);
-            resp["status"] = "ok";
-            resp["manualOverride"] = _hpController->isManualOverrideActive();
-            resp["message"] = on ? "Manual override enabled (30 min timeout)" : "Manual override disabled, all outputs OFF";
+            String err = _hpController->setManualOverride(on);
+            if (err.length() > 0) {
+                resp["error"] = err;
+            } else {
+                resp["status"] = "ok";
+                resp["manualOverride"] = on;  // Applied on the next loop pass
+                resp["message"] = on ? "Manual override enabled (30 min timeout)" : "Manual override disabled, all outputs OFF";
+            }
             String json;
             serializeJson(resp, json);
             request->send(200, "application/json", json);
@@ -711,7 +851,7 @@ void WebHandler::setupRoutes() {
             }
             _config->setAdminPassword(pw);
             if (_ftpDisableCb) _ftpDisableCb();
-            TempSensorMap& tempSensors = _hpController->getTempSensorMap();
+            const TempSensorMap& tempSensors = _hpController->getTempSensorMap();
             ProjectInfo* proj = _config->getProjectInfo();
             _config->updateConfig("/config.txt", tempSensors, *proj);
             Log.info("AUTH", "Admin password set via setup page");
@@ -899,8 +1039,7 @@ void WebHandler::setupRoutes() {
 
             // Clear RV Fail
             bool clearRvFail = data["clearRvFail"] | false;
-            if (clearRvFail) {
-                _hpController->clearRvFail();
+            if (clearRvFail && _hpController->clearRvFail().length() == 0) {
                 proj->rvFail = false;
             }
 
@@ -925,7 +1064,7 @@ void WebHandler::setupRoutes() {
                 proj->theme = theme;
             }
 
-            TempSensorMap& tempSensors = _hpController->getTempSensorMap();
+            const TempSensorMap& tempSensors = _hpController->getTempSensorMap();
             bool saved = _config->updateConfig("/config.txt", tempSensors, *proj);
 
             String response;
@@ -1155,7 +1294,7 @@ void WebHandler::setupRoutes() {
                         String newIP = WiFi.localIP().toString();
                         _config->setWifiSSID(_wifiTestNewSSID);
                         _config->setWifiPassword(_wifiTestNewPassword);
-                        TempSensorMap& tempSensors = _hpController->getTempSensorMap();
+                        const TempSensorMap& tempSensors = _hpController->getTempSensorMap();
                         ProjectInfo* proj = _config->getProjectInfo();
                         _config->updateConfig("/config.txt", tempSensors, *proj);
                         _wifiTestState = "success";
@@ -1320,7 +1459,7 @@ void WebHandler::setupRoutes() {
                         String newIP = WiFi.localIP().toString();
                         _config->setWifiSSID(_wifiTestNewSSID);
                         _config->setWifiPassword(_wifiTestNewPassword);
-                        TempSensorMap& tempSensors = _hpController->getTempSensorMap();
+                        const TempSensorMap& tempSensors = _hpController->getTempSensorMap();
                         ProjectInfo* proj = _config->getProjectInfo();
                         _config->updateConfig("/config.txt", tempSensors, *proj);
                         _wifiTestState = "success";
@@ -1,5 +1,8 @@
 #include <Arduino.h>
 #include <esp_freertos_hooks.h>
+#include <esp_timer.h>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
 #include <ArxContainer.h>
 #include <OneWire.h>
 #include <WiFiServer.h>
@@ -12,9 +15,14 @@
 #include <TaskSchedulerDeclarations.h>
 #include "CircularBuffer.hpp"
 #include "Logger.h"
+#include "TraceRecorder.h"
 #include "OutPin.h"
 #include "InputPin.h"
+#include "InputEventRing.h"
+#include "AnalogSampler.h"
 #include "GoodmanHP.h"
+#include "BoardConfig.h"
+#include "I2CBus.h"
 #include "Config.h"
 #include "WebHandler.h"
 #include "MQTTHandler.h"
@@ -71,7 +79,16 @@ bool ftpActive = false;
 unsigned long ftpStopTime = 0;
 
 
-std::map<String, InputPin*> _isrEvent;
+// Input edges captured by inputISRChange, drained by onCheckInputQueue.
+// Fixed table + SPSC event ring so the ISR never touches the heap or a lock.
+static const uint8_t MAX_ISR_INPUTS = 8;
+InputPin* _isrInputs[MAX_ISR_INPUTS];
+uint8_t _isrInputGpio[MAX_ISR_INPUTS];   // The ISR reads these, not the InputPin (flash code)
+uint8_t _isrInputCount = 0;
+static InputEventRing _inputEvents;
+static InputDebouncer* _isrDebouncer = nullptr;  // boardPins.debouncer() is flash code
+
+uint32_t getInputEventOverflows() { return _inputEvents.getOverflowCount(); }
 
 // Scheduler
 Scheduler ts, hts;
@@ -79,7 +96,7 @@ u_int32_t _nextIdlePrintTime = 0;
 
 u_int32_t _idleLoopCount = 0;
 u_int32_t _workLoopCount = 0;
-volatile bool InISR, InitialPinStateSet, FinalPinSetState;
+volatile bool InitialPinStateSet, FinalPinSetState;
 
 // CPU load monitoring via FreeRTOS idle hooks
 static volatile uint32_t _idleCountCore0 = 0;
@@ -99,35 +116,23 @@ u_int32_t _wifiStartMillis = 0;
 
 // WiFi AP fallback mode
 static uint32_t _wifiDisconnectCount = 0;
+// Set by the state change callback (inside update()); published from loop()
+// once update() has published the snapshot the MQTT message is built from
+static bool _mqttStatePending = false;
 bool _apModeActive = false;
 
 u_long runTimeStart;
 u_long currentRuntime;  
 
 // put function declarations here:
-#if defined (BOARD_ESP32_S3_WROOM)
-const u_int8_t _lpsPin = GPIO_NUM_15;
-const u_int8_t _dftPin = GPIO_NUM_16;
-const u_int8_t _yPin = GPIO_NUM_17;
-const u_int8_t _oPin = GPIO_NUM_18;
-const u_int8_t _fanPin = GPIO_NUM_4;
-const u_int8_t _CNTPin = GPIO_NUM_5;
-const u_int8_t _WPin = GPIO_NUM_6;
-const u_int8_t _RVPin = GPIO_NUM_7;
-const u_int8_t _sdaPin = GPIO_NUM_8;
-const u_int8_t _sclPin = GPIO_NUM_9;
-#elif  defined (BOARD_ESP32_ROVER)
-const u_int8_t _dftPin = GPIO_NUM_16;
-const u_int8_t _yPin = GPIO_NUM_17;
-const u_int8_t _oPin = GPIO_NUM_18;
-#else
-#error "BUILD_ENV_NAME NOT RECOGNIZED"
-#endif
-const u_int8_t ONE_WIRE_BUS = GPIO_NUM_21;
+// GPIO layout: see BoardConfig.h
+static SelectedBoardPins boardPins;
+static constexpr const BoardDef& board = SelectedBoardPins::def();
+// Background continuous-ADC sampling for IT_ANALOG inputs (none on the current boards)
+static AnalogSampler analogSampler(&ts);
 
 // ProjectInfo is defined in Config.h
 
-void tempSensorUpdateCallback(TempSensor *sensor);
 void tempSensorChangeCallback(TempSensor *sensor);
 
 
@@ -143,7 +148,7 @@ WebHandler webHandler(80, &ts, &hpController);
 MQTTHandler mqttHandler(&ts);
 TempHistory tempHistory;
 
-OneWire oneWire(ONE_WIRE_BUS);
+OneWire oneWire(board.oneWire);
 
 // Pass our oneWire reference to Dallas Temperature.
 DallasTemperature sensors(&oneWire);
@@ -192,16 +197,15 @@ void getTempSensors();
 void getTempSensors(TempSensorMap& tempMap);
 bool onWifiWaitEnable();
 void onWifiWaitDisable();
-bool CheckTickTime(InputPin *pin);
 void onCheckInputQueue();
 
 void onInput(InputPin *pin){
-  Log.info("InputPin", "Name: %s Value: %d", pin->getName(), pin->getValue());
+  Log.info("InputPin", "Name: %s Value: %d", pin->getName().c_str(), pin->getValue());
 }
 
 bool onOutpin(OutPin *pin, bool on, bool inCallback, float &newPercent, float origPercent){
   //cout << "Output pin:" << pin->getName() << " On:" << pin->isPinOn() << endl; 
-  Log.info("OutPin", "Name: %s State: %d Requested State: %d New Percent On: %lf Orig Percent On: %lf", pin->getName(), pin->isPinOn(), on, newPercent, origPercent);
+  Log.debug("OutPin", "Name: %s State: %d Requested State: %d New Percent On: %lf Orig Percent On: %lf", pin->getName().c_str(), pin->isPinOn(), on, newPercent, origPercent);
   return true;
 }
 
@@ -212,8 +216,6 @@ Task tWaitOnWiFi(TASK_SECOND, 60, [](){
 
 Task tRuntime(TASK_MINUTE, TASK_FOREVER, &OnRunTimeUpdate, &ts, false);
 
-Task _tGetInputs(500 * TASK_MILLISECOND, TASK_FOREVER, &onCheckInputQueue, &ts, false);
-
 // Save heat runtime to SD card every 5 minutes
 void onSaveRuntime();
 Task tSaveRuntime(5 * TASK_MINUTE, TASK_FOREVER, &onSaveRuntime, &ts, false);
@@ -240,28 +242,18 @@ Task tBackfillTempHistory(5 * TASK_SECOND, 12, &onBackfillTempHistory, &ts, fals
  * ISR function with my input pin structure to help track pin state. 
  */
 void IRAM_ATTR inputISRChange(void *arg) {
-  InputPin* pinInfo = static_cast<InputPin*>(arg);
-  if(pinInfo == nullptr) {
-    InISR = false;
-    return;
-  }
-  pinInfo->setPrevValue();
-  pinInfo->changedNow();
-  if( _isrEvent.find(pinInfo->getName()) == _isrEvent.end())
-  {
-    _isrEvent[pinInfo->getName()] = pinInfo;
-  }
-}
-bool CheckTickTime(InputPin *pin){
-  uint32_t curTime = millis();
-  if(pin == nullptr) return false;
-  if(curTime >= pin->changedAtTick() + 50 || pin->getPreValue() != pin->getValue()){
-    return true;
-  }
-  else
-  { 
-    return false;
-  }
+  // Only IRAM code and DRAM data: an edge can arrive while the flash cache is
+  // off (OTA writes, NVS). The trace ring is in PSRAM, so the edge is traced
+  // when onCheckInputQueue() drains it.
+  // The level comes straight from the GPIO input registers, as InputDebouncer
+  // reads them; digitalRead() is only in IRAM with CONFIG_ARDUINO_ISR_IRAM.
+  uint8_t index = (uint8_t)(uintptr_t)arg;
+  uint8_t gpio = _isrInputGpio[index];
+  uint32_t in = gpio < 32 ? REG_READ(GPIO_IN_REG) : REG_READ(GPIO_IN1_REG);
+  uint8_t level = (in >> (gpio & 31)) & 1;
+  _inputEvents.push(index, level);
+  // Start fast sampling; the controller wakes once the debouncer accepts the edge
+  _isrDebouncer->requestSampleFromISR();
 }
 
 bool onWifiWaitEnable(){
@@ -345,35 +337,34 @@ void connectToWifi() {
 
 
 void onCheckInputQueue(){
-  for(auto& m : _isrEvent){
-    while(InISR){
-      vTaskDelay(pdMS_TO_TICKS(1));
-      yield();
-    }
-    InputPin * pin = m.second;
-    pin->verifiedAt();
-   
-    //auto isInActiveMap = activePins.find(pin->getName());
-    if(pin->isActive()){
-      Serial.printf("Activating pin: %s\n", pin->getName());
-      //remove from activePins as it is not active any longer.
-      pin->activeNow();
-      pin->getTask()->restartDelayed( pin->getTask()->getInterval() );
-    }else{
-      Serial.printf("Deactivated pin: %s\n", pin->getName());
-      pin->getTask()->disable();
-      pin->inactiveNow();
-      pin->fireCallback();
-    }
-    _isrEvent.erase(m.first);
-  }  
+  // Raw edge trail and contact stats; levels are debounced by boardPins.debouncer().
+  // Runs every loop pass so an edge reaches its pin before the debouncer accepts it.
+  InputEdgeEvent ev;
+  while(_inputEvents.pop(ev)){
+    if(ev.index >= _isrInputCount) continue;
+    uint32_t ageUs = InputEventRing::ageUs(ev);
+    Trace.recordAt(esp_timer_get_time() - ageUs, TraceEvent::INPUT_EDGE, _isrInputGpio[ev.index], ev.level);
+    _isrInputs[ev.index]->recordEdge(ev.level, millis() - ageUs / 1000, micros() - ageUs);
+  }
+  static uint32_t reportedOverflows = 0;
+  uint32_t overflows = _inputEvents.getOverflowCount();
+  if(overflows != reportedOverflows){
+    Log.warn("MAIN", "Input event ring overflowed: %lu edges dropped (high water %u)",
+             overflows - reportedOverflows, _inputEvents.getHighWater());
+    reportedOverflows = overflows;
+  }
 }
 
 unsigned char * acc_data_all;
 void setup() {
   Serial.begin(115200);
 
-  Wire.begin(_sdaPin, _sclPin);
+  // Before the config restore below so its controller settings are traced
+  Trace.begin();
+
+  Wire.begin(board.sda, board.scl);
+  Wire.setTimeOut(I2CBus::TRANSACTION_TIMEOUT_MS);
+  I2cBus.begin();
 
   // Scan I2C bus for devices
   uint8_t i2cCount = 0;
@@ -424,7 +415,7 @@ void setup() {
   });
 
   if(config.initSDCard()){
-    TempSensorMap& tempSensors = hpController.getTempSensorMap();
+    TempSensorMap& tempSensors = hpController.editTempSensorMap();
     if(config.openConfigFile(_filename, tempSensors, proj)){
       config.loadTempConfig(_filename, tempSensors, proj);
       // Update global variables from config
@@ -523,17 +514,31 @@ void setup() {
   Log.setLogFile("/log.txt", proj.maxLogSize, proj.maxOldLogCount);
   Log.info("MAIN", "Logger initialized");
 
-  // Add input pins to GoodmanHP controller
-  hpController.addInput("LPS", new InputPin(&ts, 3000, InputResistorType::IT_PULLDOWN, InputPinType::IT_DIGITAL, _lpsPin, "LPS", "LPS", onInput));
-  hpController.addInput("DFT", new InputPin(&ts, 3000, InputResistorType::IT_PULLDOWN, InputPinType::IT_DIGITAL, _dftPin, "DFT", "DFT", onInput));
-  hpController.addInput("Y", new InputPin(&ts, 3000, InputResistorType::IT_PULLDOWN, InputPinType::IT_DIGITAL, _yPin, "Y", "OT-NO", onInput));
-  hpController.addInput("O", new InputPin(&ts, 3000, InputResistorType::IT_PULLDOWN, InputPinType::IT_DIGITAL, _oPin, "O", "OT-NC", onInput));
+  // Board pin objects live in static storage; registered with the controller by slot
+  boardPins.begin(&ts, hpController, onInput, onOutpin);
+  Log.info("MAIN", "Board: %s", board.name);
+
+  // Input edges wake the debouncer immediately (see inputISRChange); analog
+  // inputs are sampled in the background instead
+  for (auto& pair : hpController.getInputMap()) {
+    if (pair.second->getType() == InputPinType::IT_ANALOG) {
+      analogSampler.addInput(pair.second);
+      continue;
+    }
+    if (_isrInputCount >= MAX_ISR_INPUTS) break;
+    _isrDebouncer = &boardPins.debouncer();
+    _isrInputs[_isrInputCount] = pair.second;
+    _isrInputGpio[_isrInputCount] = pair.second->getPin();
+    attachInterruptArg(pair.second->getPin(), inputISRChange, (void*)(uintptr_t)_isrInputCount, CHANGE);
+    _isrInputCount++;
+  }
+  analogSampler.begin();
 
-  // Add output pins to GoodmanHP controller
-  hpController.addOutput("FAN", new OutPin(&ts, 0, _fanPin, "FAN", "FAN", onOutpin));
-  hpController.addOutput("CNT", new OutPin(&ts, 3000, _CNTPin, "CNT", "CNT", onOutpin));
-  hpController.addOutput("W", new OutPin(&ts, 0, _WPin, "W", "W", onOutpin));
-  hpController.addOutput("RV", new OutPin(&ts, 0, _RVPin, "RV", "RV", onOutpin));
+  // Restore per-output runtime/cycle accounting from config
+  for (auto& pair : hpController.getOutputMap()) {
+    auto it = proj.outputStats.find(pair.first);
+    if (it != proj.outputStats.end()) pair.second->restoreStats(it->second);
+  }
 
 
   // Start GoodmanHP controller
@@ -543,14 +548,28 @@ void setup() {
   if (mcp9600Ready) {
     TempSensor* liquidSensor = new TempSensor("LIQUID_TEMP");
     liquidSensor->setMCP9600(&mcp9600);
-    liquidSensor->setUpdateCallback(tempSensorUpdateCallback);
     liquidSensor->setChangeCallback(tempSensorChangeCallback);
     hpController.addTempSensor("LIQUID_TEMP", liquidSensor);
+    hpController.setTempSensorAlertPin(liquidSensor, board.mcpAlert);
     Log.info("MAIN", "LIQUID_TEMP sensor added (MCP9600 thermocouple)");
   }
 
+  // Per-sensor reading filters from config; the rest keep the 0.33°F deadband
+  for (auto& pair : hpController.getTempSensorMap()) {
+    auto it = proj.sensorFilters.find(pair.first);
+    if (it == proj.sensorFilters.end()) continue;
+    const TempFilter::Config& fc = it->second;
+    pair.second->setFilter(fc);
+    Log.info("MAIN", "%s filter: median %u, EMA %.1fs, slew %.2fF/s, deadband %.2fF", pair.first.c_str(),
+             fc.median, fc.emaTauSec, fc.slewFPerSec, fc.deadbandF);
+  }
+
   hpController.setStateChangeCallback([](GoodmanHP::State, GoodmanHP::State) {
-    mqttHandler.publishState();
+    _mqttStatePending = true;
+  });
+  // One state message per output transition (the state message carries the outputs)
+  hpController.setOutputChangeCallback([](uint8_t, uint8_t) {
+    _mqttStatePending = true;
   });
   hpController.setLPSFaultCallback([](bool active) {
     mqttHandler.publishFault("LPS",
@@ -560,7 +579,6 @@ void setup() {
   hpController.begin();
 
   tRuntime.enable();
-  _tGetInputs.enable();
   tSaveRuntime.enable();
   tLogTempsCSV.enable();
   tBackfillTempHistory.enableDelayed();
@@ -572,17 +590,13 @@ void setup() {
   Log.info("MAIN", "Starting Main Loop");
 }
 
-void tempSensorUpdateCallback(TempSensor *sensor){
-  sensor->update(&sensors);
-}
-
 void tempSensorChangeCallback(TempSensor *sensor){
   Serial.print(sensor->getDescription());
   sensor->isValid() ? Serial.print(" Temp Updated: ") : Serial.print(" Temp Invalid: ");
   Serial.print("Temp: ");
-  Serial.print(sensor->getValue());
+  Serial.print(sensor->getTempF());
   Serial.print("F Previous Temp: ");
-  Serial.print(sensor->getPrevious());
+  Serial.print(fromDeciF(sensor->getPreviousDeciF()));
   Serial.println("F");
   mqttHandler.publishTemps();
 }
@@ -591,12 +605,12 @@ void getTempSensors(TempSensorMap& tempMap)
 {
   // Clear existing sensors if running twice
   hpController.clearTempSensors();
-  TempSensor::discoverSensors(&sensors, tempMap, tempSensorUpdateCallback, tempSensorChangeCallback);
+  TempSensor::discoverSensors(&sensors, tempMap, tempSensorChangeCallback);
 }
 
 void getTempSensors()
 {
-  getTempSensors(hpController.getTempSensorMap());
+  getTempSensors(hpController.editTempSensorMap());
 }
 
 
@@ -613,18 +627,32 @@ void onSaveRuntime(){
   bool rvFailChanged = (rvFail != proj.rvFail);
   bool defrostChanged = (swDefrost != proj.softwareDefrost);
 
+  // Output accounting: save when any output ran or cycled since the last save
+  bool statsChanged = false;
+  for (auto& pair : hpController.getOutputMap()) {
+    OutPinStats stats;
+    pair.second->getStats(stats);
+    OutPinStats& saved = proj.outputStats[pair.first];
+    if (stats.onMs != saved.onMs || stats.cycles != saved.cycles) statsChanged = true;
+    saved = stats;
+  }
+
   if (runtimeChanged) proj.heatRuntimeAccumulatedMs = runtimeMs;
   if (rvFailChanged) proj.rvFail = rvFail;
   if (defrostChanged) proj.softwareDefrost = swDefrost;
 
+  mqttHandler.publishRuntime();
+  mqttHandler.publishInputStats();
+  mqttHandler.publishSensorHealth();
+
   if (rvFailChanged || defrostChanged) {
     // rvFail and softwareDefrost are in heatpump section — need full config update
-    TempSensorMap& tempSensors = hpController.getTempSensorMap();
+    const TempSensorMap& tempSensors = hpController.getTempSensorMap();
     if (config.updateConfig(_filename, tempSensors, proj)) {
       Log.info("MAIN", "Config saved (rvFail=%d, defrost=%d, runtime=%lu ms)", rvFail, swDefrost, runtimeMs);
     }
-  } else if (runtimeChanged) {
-    if (config.updateRuntime(_filename, runtimeMs, swDefrost)) {
+  } else if (runtimeChanged || statsChanged) {
+    if (config.updateRuntime(_filename, runtimeMs, swDefrost, proj.outputStats)) {
       Log.debug("MAIN", "Heat runtime saved: %lu ms", runtimeMs);
     }
   }
@@ -701,7 +729,7 @@ void onLogTempsCSV() {
     }
 
     time_t epoch = mktime(&timeinfo);
-    TempSensorMap& temps = hpController.getTempSensorMap();
+    const TempSensorMap& temps = hpController.getTempSensorMap();
 
     for (int i = 0; i < 5; i++) {
         auto it = temps.find(tempCsvEntries[i].sensorKey);
@@ -711,12 +739,13 @@ void onLogTempsCSV() {
         snprintf(filepath, sizeof(filepath), "/temps/%s/%s.csv",
                  tempCsvEntries[i].dirName, today);
 
-        float tempVal = it->second->getValue();
+        DeciF tempVal = it->second->getDeciF();
 
         File f = SD.open(filepath, FILE_APPEND);
         if (f) {
             char row[32];
-            snprintf(row, sizeof(row), "%ld,%.1f", (long)epoch, tempVal);
+            int len = snprintf(row, sizeof(row), "%ld,", (long)epoch);
+            formatDeciF(row + len, sizeof(row) - len, tempVal);
             f.println(row);
             f.close();
         }
@@ -851,7 +880,14 @@ void loop() {
   }
   if (ftpActive) ftpSrv.handleFTP();
 
+  onCheckInputQueue();
+  boardPins.debouncer().serviceSampleRequests();
+  hpController.serviceUpdateRequests();
   bool bIdle = ts.execute();
+  if (_mqttStatePending) {
+    _mqttStatePending = false;
+    mqttHandler.publishState();
+  }
   if (bIdle) {
     _idleLoopCount++;
     printIdleStatus();